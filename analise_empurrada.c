@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "analise_empurrada.h"
+#include "saida.h"
+
+/* O lexer reentrante olha no maximo dois caracteres alem do comeco do que
+   vem depois de um token (o '.' e o digito de "1.5"). Um token so e
+   entregue ao parser se esses dois caracteres ja chegaram; o resto vai
+   para 'resto' e e lexado de novo com o proximo pedaco. */
+#define ESPIADA_LEXER 2
+
+void empurrado_iniciar(AnalisadorEmpurrado *a, const ReceptorEventos *receptor, int relatar_erros) {
+    static const int inicial[] = { SIM_NAOTERMINAL(NT_PROGRAM) };
+    pilha_init(&a->pilha);
+    a->resto = NULL;
+    a->tamanho_resto = 0;
+    a->capacidade_resto = 0;
+    analise_iniciar(&a->estado, &a->pilha, inicial, 1, receptor, relatar_erros, 0);
+}
+
+void empurrado_liberar(AnalisadorEmpurrado *a) {
+    // A pilha em uso (possivelmente realocada) e a do estado.
+    pilha_liberar(&a->estado.pilha);
+    pilha_init(&a->pilha);
+    free(a->resto);
+    a->resto = NULL;
+    a->tamanho_resto = a->capacidade_resto = 0;
+}
+
+static void reservar_resto(AnalisadorEmpurrado *a, size_t tamanho) {
+    if (tamanho <= a->capacidade_resto)
+        return;
+    size_t nova = a->capacidade_resto ? a->capacidade_resto : 256;
+    while (nova < tamanho)
+        nova *= 2;
+    char *dados = realloc(a->resto, nova);
+    if (!dados) {
+        fprintf(stderr, "Erro: memoria insuficiente para a analise empurrada.\n");
+        exit(1);
+    }
+    a->resto = dados;
+    a->capacidade_resto = nova;
+}
+
+// Lexa 'texto' e entrega os tokens completos ao driver. Se 'final', todo
+// token e completo; senao o que sobra depois do ultimo token seguro e
+// guardado em 'resto'.
+static void consumir_texto(AnalisadorEmpurrado *a, const char *texto, size_t tamanho, int final) {
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, texto, tamanho);
+    lx.relatar_erros = 0; // Um token perto do fim do pedaco e relexado depois.
+    const char *seguro = texto; // Tudo antes daqui ja virou token.
+    const char *fim = texto + tamanho;
+
+    while (!a->estado.terminou) {
+        int token = lexer_r_proximo(&lx);
+        if (token == T_EOF)
+            break; // So espacos/comentario ate o fim: guarda a partir de 'seguro'.
+        if (!final && lx.lexema + lx.tamanho + ESPIADA_LEXER > fim) {
+            seguro = lx.lexema;
+            break;
+        }
+        if (token == T_ERROR)
+            saida_erro_lexico(lx.lexema, lx.tamanho);
+        analise_token(&a->estado, token, lx.lexema, lx.tamanho);
+        seguro = lx.lexema + lx.tamanho;
+    }
+
+    if (final || a->estado.terminou) {
+        a->tamanho_resto = 0;
+        return;
+    }
+    // Quando 'texto' ja e o 'resto', a sobra so desliza para o comeco.
+    size_t sobra = (size_t)(fim - seguro);
+    if (texto != a->resto)
+        reservar_resto(a, sobra);
+    memmove(a->resto, seguro, sobra);
+    a->tamanho_resto = sobra;
+}
+
+int empurrado_alimentar(AnalisadorEmpurrado *a, const char *pedaco, size_t tamanho) {
+    if (a->estado.terminou)
+        return EMPURRADO_TERMINOU;
+
+    if (a->tamanho_resto == 0) {
+        // Caso comum: lexa direto do pedaco, sem copiar.
+        consumir_texto(a, pedaco, tamanho, 0);
+    } else {
+        // Junta o pedaco novo ao token incompleto, no mesmo buffer.
+        reservar_resto(a, a->tamanho_resto + tamanho);
+        memcpy(a->resto + a->tamanho_resto, pedaco, tamanho);
+        consumir_texto(a, a->resto, a->tamanho_resto + tamanho, 0);
+    }
+    return a->estado.terminou ? EMPURRADO_TERMINOU : EMPURRADO_PRECISA_MAIS;
+}
+
+int empurrado_finalizar(AnalisadorEmpurrado *a) {
+    if (a->tamanho_resto > 0)
+        consumir_texto(a, a->resto, a->tamanho_resto, 1);
+    while (!analise_token(&a->estado, T_EOF, "", 0))
+        ;
+    return analise_concluir(&a->estado, &a->pilha);
+}
@@ -0,0 +1,38 @@
+#ifndef ANALISE_EMPURRADA_H
+#define ANALISE_EMPURRADA_H
+
+#include <stddef.h>
+#include "parser.h"
+
+/* Analisador empurrado (push), para servicos com laco de eventos.
+   Em vez de bloquear esperando a entrada, recebe o texto em pedacos do
+   tamanho que chegarem: o lexer e o driver LL(1) avancam ate onde o pedaco
+   permite, guardam o estado (o resto de token incompleto e a pilha de
+   analise) e devolvem "precisa de mais". Nenhuma thread fica presa a uma
+   analise em andamento; cada analise e so esta estrutura. */
+
+#define EMPURRADO_PRECISA_MAIS 0
+#define EMPURRADO_TERMINOU     1  // A analise acabou antes do fim da entrada.
+
+typedef struct {
+    EstadoAnalise estado;
+    Pilha pilha;
+    char *resto;           // Fim do texto ainda nao transformado em tokens.
+    size_t tamanho_resto;
+    size_t capacidade_resto;
+} AnalisadorEmpurrado;
+
+// Comeca a analise de um programa. Os lexemas entregues a 'receptor' e as
+// mensagens de erro so valem durante a chamada que os produziu.
+void empurrado_iniciar(AnalisadorEmpurrado *a, const ReceptorEventos *receptor, int relatar_erros);
+
+// Entrega o proximo pedaco da entrada (pode cortar um token no meio).
+// Retorna EMPURRADO_PRECISA_MAIS ou EMPURRADO_TERMINOU.
+int empurrado_alimentar(AnalisadorEmpurrado *a, const char *pedaco, size_t tamanho);
+
+// Fim da entrada: termina a analise e retorna o numero de erros sintaticos.
+int empurrado_finalizar(AnalisadorEmpurrado *a);
+
+void empurrado_liberar(AnalisadorEmpurrado *a);
+
+#endif
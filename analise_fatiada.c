@@ -0,0 +1,300 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "parser.h"
+#include "analise_fatiada.h"
+#include "perfil.h"
+
+/* ============================
+   Execucao em paralelo
+   ============================ */
+
+// Roda 'funcao' sobre 'n' argumentos (de 'tamanho_arg' bytes cada), um por
+// thread; a thread atual executa o primeiro. Se uma thread nao puder ser
+// criada, o argumento dela e executado aqui mesmo, depois dos outros.
+static void executar_em_paralelo(void *(*funcao)(void *), void *args, size_t tamanho_arg, int n) {
+    if (n <= 0)
+        return;
+    char *base = args;
+    pthread_t *threads = malloc((size_t)n * sizeof(pthread_t));
+    unsigned char *criada = calloc((size_t)n, 1);
+    for (int i = 1; i < n && threads && criada; i++)
+        criada[i] = pthread_create(&threads[i], NULL, funcao, base + (size_t)i * tamanho_arg) == 0;
+    funcao(base);
+    for (int i = 1; i < n; i++) {
+        if (criada && criada[i])
+            pthread_join(threads[i], NULL);
+        else
+            funcao(base + (size_t)i * tamanho_arg);
+    }
+    free(criada);
+    free(threads);
+}
+
+static void *alocar_ou_sair(size_t bytes) {
+    void *p = malloc(bytes ? bytes : 1);
+    if (!p) {
+        fprintf(stderr, "Erro: memoria insuficiente para a analise em fatias.\n");
+        exit(1);
+    }
+    return p;
+}
+
+/* ============================
+   Fase 1: lexico em paralelo
+   ============================ */
+
+// Um pedaco do texto, sempre comecando logo apos um '\n' (nenhum token nem
+// comentario atravessa uma quebra de linha, entao o corte e seguro).
+typedef struct {
+    const char *texto;
+    size_t tamanho;
+    unsigned char *tipos;  // Tipos dos tokens do pedaco (um byte cada).
+    long quantidade;
+    int delta_chaves;      // Saldo de '{' menos '}' no pedaco.
+    int delta_parenteses;  // Saldo de '(' menos ')' no pedaco.
+} PedacoLexico;
+
+static void *lexar_pedaco(void *arg) {
+    PedacoLexico *pd = arg;
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, pd->texto, pd->tamanho);
+    // Um T_ERROR sempre derruba a tentativa em paralelo: quem relata os
+    // erros lexicos, em ordem, e a analise sequencial.
+    lx.relatar_erros = 0;
+
+    // Todo token tem ao menos um caractere.
+    pd->tipos = alocar_ou_sair(pd->tamanho);
+    pd->quantidade = 0;
+    pd->delta_chaves = 0;
+    pd->delta_parenteses = 0;
+
+    int tk;
+    while ((tk = lexer_r_proximo(&lx)) != T_EOF) {
+        pd->tipos[pd->quantidade++] = (unsigned char)tk;
+        switch (tk) {
+            case T_CA: pd->delta_chaves++; break;
+            case T_CF: pd->delta_chaves--; break;
+            case T_PA: pd->delta_parenteses++; break;
+            case T_PF: pd->delta_parenteses--; break;
+        }
+    }
+    return NULL;
+}
+
+/* ============================
+   Fase 2: fronteiras de comando
+   ============================ */
+
+// Busca, a partir de 'inicio', a primeira posicao logo depois de um comando
+// completo dentro do main (chaves = 1, parenteses = 0). Um '}' seguido de
+// else nao encerra o comando. Retorna -1 se nao houver fronteira.
+static long procurar_fronteira(const unsigned char *tipos, long inicio, long fim,
+                               int chaves, int parenteses) {
+    for (long i = inicio; i < fim; i++) {
+        switch (tipos[i]) {
+            case T_CA: chaves++; break;
+            case T_PA: parenteses++; break;
+            case T_PF: parenteses--; break;
+            case T_PV:
+                if (chaves == 1 && parenteses == 0)
+                    return i + 1;
+                break;
+            case T_CF:
+                chaves--;
+                if (chaves == 1 && parenteses == 0 && i + 1 < fim && tipos[i + 1] != T_ELSE)
+                    return i + 1;
+                break;
+        }
+    }
+    return -1;
+}
+
+typedef struct {
+    const unsigned char *tipos;
+    long inicio, fim;      // Regiao onde procurar.
+    int chaves, parenteses; // Profundidade no inicio da regiao.
+    long corte;            // Resultado (-1 se nao achou).
+} BuscaFronteira;
+
+static void *buscar_fronteira(void *arg) {
+    BuscaFronteira *b = arg;
+    b->corte = procurar_fronteira(b->tipos, b->inicio, b->fim, b->chaves, b->parenteses);
+    return NULL;
+}
+
+/* ============================
+   Fase 3: analise das fatias
+   ============================ */
+
+// Fonte de tokens de uma fatia: seus tokens, um '}' sintetico que fecha a
+// LISTA_COMANDOS e depois T_EOF.
+typedef struct {
+    const unsigned char *tipos;
+    long pos, fim;
+    int fechou;
+} FonteFatia;
+
+static int fonte_fatia_proximo(void *dados, const char **lexema, int *tamanho) {
+    FonteFatia *f = dados;
+    *lexema = "";
+    *tamanho = 0;
+    if (f->pos < f->fim)
+        return f->tipos[f->pos++];
+    if (!f->fechou) {
+        f->fechou = 1;
+        return T_CF;
+    }
+    return T_EOF;
+}
+
+typedef struct {
+    const unsigned char *tipos;
+    long inicio, fim;
+    int erros;
+} Fatia;
+
+static void *analisar_fatia(void *arg) {
+    Fatia *ft = arg;
+    static const int iniciais[] = { SIM_TERMINAL(T_CF), SIM_NAOTERMINAL(NT_LISTA_COMANDOS) };
+    FonteFatia dados = { ft->tipos, ft->inicio, ft->fim, 0 };
+    FonteTokens fonte = { fonte_fatia_proximo, &dados };
+    Pilha pilha;
+    pilha_init(&pilha);
+    ft->erros = analisar_entrada_desde(&pilha, iniciais, 2, &fonte, NULL, 0);
+    pilha_liberar(&pilha);
+    PERFIL_JUNTAR_THREAD();
+    return NULL;
+}
+
+/* ============================
+   Orquestracao
+   ============================ */
+
+// Cabecalho fixo de FUNCAO_MAIN: T_TIPO T_MAIN ( ) {
+#define TAM_CABECALHO_MAIN 5
+
+static int cabecalho_e_rodape_validos(const unsigned char *tipos, long n) {
+    static const unsigned char cabecalho[TAM_CABECALHO_MAIN] = { T_TIPO, T_MAIN, T_PA, T_PF, T_CA };
+    return n > TAM_CABECALHO_MAIN &&
+           memcmp(tipos, cabecalho, TAM_CABECALHO_MAIN) == 0 &&
+           tipos[n - 1] == T_CF;
+}
+
+// Tenta o caminho paralelo. Retorna 1 se todas as fatias foram aceitas.
+static int tentar_em_paralelo(const char *texto, size_t tamanho, int n) {
+    // Fase 1: corta o texto em pedacos de tamanho parecido, apos um '\n'.
+    PedacoLexico *pedacos = alocar_ou_sair((size_t)n * sizeof(PedacoLexico));
+    size_t pos = 0;
+    for (int k = 0; k < n; k++) {
+        size_t fim = (k == n - 1) ? tamanho : tamanho / (size_t)n * (size_t)(k + 1);
+        if (fim < pos)
+            fim = pos;
+        while (fim > 0 && fim < tamanho && texto[fim - 1] != '\n')
+            fim++;
+        pedacos[k].texto = texto + pos;
+        pedacos[k].tamanho = fim - pos;
+        pos = fim;
+    }
+    executar_em_paralelo(lexar_pedaco, pedacos, sizeof(PedacoLexico), n);
+
+    // Junta os tokens num vetor so e guarda onde cada pedaco comeca.
+    long total = 0;
+    for (int k = 0; k < n; k++)
+        total += pedacos[k].quantidade;
+    unsigned char *tipos = alocar_ou_sair((size_t)total);
+    long *inicio_pedaco = alocar_ou_sair((size_t)n * sizeof(long));
+    int *chaves_antes = alocar_ou_sair((size_t)n * sizeof(int));
+    int *parenteses_antes = alocar_ou_sair((size_t)n * sizeof(int));
+    long desloc = 0;
+    int chaves = 0, parenteses = 0;
+    for (int k = 0; k < n; k++) {
+        memcpy(tipos + desloc, pedacos[k].tipos, (size_t)pedacos[k].quantidade);
+        inicio_pedaco[k] = desloc;
+        chaves_antes[k] = chaves;
+        parenteses_antes[k] = parenteses;
+        desloc += pedacos[k].quantidade;
+        chaves += pedacos[k].delta_chaves;
+        parenteses += pedacos[k].delta_parenteses;
+        free(pedacos[k].tipos);
+    }
+    free(pedacos);
+
+    int aceito = 0;
+    if (cabecalho_e_rodape_validos(tipos, total)) {
+        long corpo_inicio = TAM_CABECALHO_MAIN, corpo_fim = total - 1;
+
+        // Fase 2: cada pedaco procura a primeira fronteira a partir do seu inicio.
+        BuscaFronteira *buscas = alocar_ou_sair((size_t)n * sizeof(BuscaFronteira));
+        for (int k = 0; k < n; k++) {
+            long ini = inicio_pedaco[k];
+            int c = chaves_antes[k], p = parenteses_antes[k];
+            if (ini < corpo_inicio) {
+                ini = corpo_inicio;
+                c = 1;
+                p = 0;
+            }
+            buscas[k] = (BuscaFronteira){ tipos, ini, corpo_fim, c, p, -1 };
+        }
+        executar_em_paralelo(buscar_fronteira, buscas + 1, sizeof(BuscaFronteira), n - 1);
+
+        // Fase 3: fatias entre cortes crescentes.
+        Fatia *fatias = alocar_ou_sair((size_t)n * sizeof(Fatia));
+        int num_fatias = 0;
+        long anterior = corpo_inicio;
+        for (int k = 1; k < n; k++) {
+            long corte = buscas[k].corte;
+            if (corte <= anterior)
+                continue;
+            fatias[num_fatias++] = (Fatia){ tipos, anterior, corte, 0 };
+            anterior = corte;
+        }
+        fatias[num_fatias++] = (Fatia){ tipos, anterior, corpo_fim, 0 };
+        executar_em_paralelo(analisar_fatia, fatias, sizeof(Fatia), num_fatias);
+
+        aceito = 1;
+        for (int i = 0; i < num_fatias; i++)
+            if (fatias[i].erros)
+                aceito = 0;
+        free(fatias);
+        free(buscas);
+    }
+
+    free(parenteses_antes);
+    free(chaves_antes);
+    free(inicio_pedaco);
+    free(tipos);
+    return aceito;
+}
+
+int analisar_em_fatias(const char *texto, size_t tamanho, int num_fatias, int relatar_erros) {
+    // No maximo uma thread por nucleo, e nao mais pedacos que linhas (cada
+    // pedaco comeca depois de um '\n').
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nucleos < 1)
+        nucleos = 1;
+    if (num_fatias <= 0 || num_fatias > nucleos)
+        num_fatias = (int)nucleos;
+    long linhas = 1;
+    for (size_t i = 0; i < tamanho && linhas < num_fatias; i++)
+        linhas += texto[i] == '\n';
+    if (num_fatias > linhas)
+        num_fatias = (int)linhas;
+
+    if (tentar_em_paralelo(texto, tamanho, num_fatias))
+        return 0;
+
+    // Alguma fatia falhou: a analise sequencial decide e relata os erros.
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, texto, tamanho);
+    lx.relatar_erros = relatar_erros;
+    FonteTokens fonte = fonte_lexer_reentrante(&lx);
+    Pilha pilha;
+    pilha_init(&pilha);
+    int erros = analisar_entrada(&pilha, &fonte, NULL, relatar_erros);
+    pilha_liberar(&pilha);
+    return erros;
+}
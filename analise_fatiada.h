@@ -0,0 +1,20 @@
+#ifndef ANALISE_FATIADA_H
+#define ANALISE_FATIADA_H
+
+#include <stddef.h>
+
+/* Analise paralela de um unico arquivo grande.
+   O texto e dividido em pedacos lexados em paralelo; depois a lista de
+   comandos do main e cortada em fronteiras de comando de nivel superior
+   (chaves balanceadas) e cada fatia e analisada numa thread, a partir de
+   NT_LISTA_COMANDOS, com a sua propria pilha.
+   Se alguma fatia falhar, o arquivo e reanalisado sequencialmente, entao
+   o veredito e os erros sao sempre os mesmos da analise sequencial. */
+
+// Analisa 'texto' com ate 'num_fatias' threads (0 = numero de nucleos; o
+// numero de nucleos e o de linhas do texto sao o limite).
+// Se 'relatar_erros', os erros da reanalise sequencial sao impressos.
+// Retorna o numero de erros sintaticos.
+int analisar_em_fatias(const char *texto, size_t tamanho, int num_fatias, int relatar_erros);
+
+#endif
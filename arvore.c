@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "arvore.h"
+#include "memoria.h"
+
+/* Na pilha de nos abertos, um NT de lista aninhado no seu proprio pai
+   (LISTA_COMANDOS -> COMANDO LISTA_COMANDOS) nao cria no: empilha-se um
+   marcador que aponta para o no da lista, e a saida dele nao fecha nada. */
+#define MARCADOR_ACHATADO(no)  (-((no) + 2))
+#define NO_DO_MARCADOR(m)      (-(m) - 2)
+
+void arvore_iniciar(Arvore *a) {
+    a->nos = NULL;
+    a->quantidade = 0;
+    a->capacidade = 0;
+    a->abertos = NULL;
+    a->num_abertos = 0;
+    a->capacidade_abertos = 0;
+    a->base_token = 0;
+    a->recuperacoes = NULL;
+    a->num_recuperacoes = 0;
+    a->capacidade_recuperacoes = 0;
+}
+
+void arvore_limpar(Arvore *a) {
+    a->quantidade = 0;
+    a->num_abertos = 0;
+    a->base_token = 0;
+    a->num_recuperacoes = 0;
+}
+
+void arvore_liberar(Arvore *a) {
+    free(a->nos);
+    free(a->abertos);
+    free(a->recuperacoes);
+    arvore_iniciar(a);
+}
+
+void arvore_reservar(Arvore *a, int n) {
+    a->nos = crescer(a->nos, &a->capacidade, n, sizeof(NoArvore));
+}
+
+static int novo_no(Arvore *a, int simbolo, int producao, int token_ini) {
+    arvore_reservar(a, a->quantidade + 1);
+    int pai = -1;
+    if (a->num_abertos > 0) {
+        int topo = a->abertos[a->num_abertos - 1];
+        pai = topo >= 0 ? topo : NO_DO_MARCADOR(topo);
+    }
+    NoArvore *no = &a->nos[a->quantidade];
+    no->simbolo = simbolo;
+    no->producao = producao;
+    no->token_ini = token_ini;
+    no->token_fim = token_ini;
+    no->tamanho = 1;
+    no->pai = pai;
+    return a->quantidade++;
+}
+
+static void empilhar_aberto(Arvore *a, int valor) {
+    a->abertos = crescer(a->abertos, &a->capacidade_abertos, a->num_abertos + 1, sizeof(int));
+    a->abertos[a->num_abertos++] = valor;
+}
+
+static void arvore_entrar(void *contexto, int nt, int producao, int indice_token) {
+    Arvore *a = contexto;
+
+    // Lista aninhada em si mesma: os itens continuam no no de fora.
+    if (lista_recursiva[nt] && a->num_abertos > 0) {
+        int topo = a->abertos[a->num_abertos - 1];
+        int pai = topo >= 0 ? topo : NO_DO_MARCADOR(topo);
+        if (a->nos[pai].simbolo == SIM_NAOTERMINAL(nt)) {
+            empilhar_aberto(a, MARCADOR_ACHATADO(pai));
+            return;
+        }
+    }
+
+    int no = novo_no(a, SIM_NAOTERMINAL(nt), producao, indice_token + a->base_token);
+    empilhar_aberto(a, no);
+}
+
+static void arvore_sair(void *contexto, int nt, int producao, int indice_token) {
+    Arvore *a = contexto;
+    (void)nt; (void)producao;
+    int topo = a->abertos[--a->num_abertos];
+    if (topo < 0)
+        return;
+    NoArvore *no = &a->nos[topo];
+    no->token_fim = indice_token + a->base_token;
+    no->tamanho = a->quantidade - topo;
+}
+
+static void arvore_casar(void *contexto, int token, int indice_token,
+                         const char *lexema, int tamanho) {
+    Arvore *a = contexto;
+    (void)lexema; (void)tamanho;
+    int no = novo_no(a, SIM_TERMINAL(token), -1, indice_token + a->base_token);
+    a->nos[no].token_fim = a->nos[no].token_ini + 1;
+}
+
+static void arvore_recuperar(void *contexto, int indice_token, int contado) {
+    Arvore *a = contexto;
+    int no = -1;
+    if (a->num_abertos > 0) {
+        int topo = a->abertos[a->num_abertos - 1];
+        no = topo >= 0 ? topo : NO_DO_MARCADOR(topo);
+    }
+    a->recuperacoes = crescer(a->recuperacoes, &a->capacidade_recuperacoes,
+                              a->num_recuperacoes + 1, sizeof(Recuperacao));
+    Recuperacao *r = &a->recuperacoes[a->num_recuperacoes++];
+    r->token = indice_token + a->base_token;
+    r->no = no;
+    r->contado = contado;
+}
+
+ReceptorEventos arvore_receptor(Arvore *a) {
+    ReceptorEventos r = { arvore_entrar, arvore_sair, arvore_casar, arvore_recuperar, a };
+    return r;
+}
@@ -0,0 +1,56 @@
+#ifndef ARVORE_H
+#define ARVORE_H
+
+#include "parser.h"
+
+/* Arvore sintatica compacta, montada pelos eventos do driver LL(1).
+   Os nos ficam num unico vetor em pre-ordem: a subarvore de um no ocupa
+   os 'tamanho' nos a partir dele, entao pode ser pulada, copiada ou
+   substituida como um bloco. Listas recursivas a direita (LISTA_COMANDOS,
+   *_RESTO) sao achatadas: os itens viram filhos diretos de um unico no. */
+
+typedef struct {
+    int simbolo;    // SIM_TERMINAL(t) ou SIM_NAOTERMINAL(nt).
+    int producao;   // Producao que expandiu o NT (-1 para terminal).
+    int token_ini;  // Primeiro token coberto.
+    int token_fim;  // Um depois do ultimo token coberto.
+    int tamanho;    // Nos da subarvore, incluindo o proprio.
+    int pai;        // Indice do pai (-1 na raiz).
+} NoArvore;
+
+// Passo de recuperacao de erro do parser durante a construcao.
+typedef struct {
+    int token;      // Lookahead do passo.
+    int no;         // No mais interno aberto no momento (-1 fora de todos).
+    int contado;    // 1 se o erro entrou na contagem.
+} Recuperacao;
+
+typedef struct {
+    NoArvore *nos;
+    int quantidade;
+    int capacidade;
+    // Nos ainda abertos durante a construcao (ver arvore.c).
+    int *abertos;
+    int num_abertos;
+    int capacidade_abertos;
+    // Somado aos indices de token dos eventos (analise de um trecho).
+    int base_token;
+    // Recuperacoes de erro, na ordem da analise.
+    Recuperacao *recuperacoes;
+    int num_recuperacoes;
+    int capacidade_recuperacoes;
+} Arvore;
+
+void arvore_iniciar(Arvore *a);
+// Esvazia a arvore mantendo a memoria para reuso.
+void arvore_limpar(Arvore *a);
+void arvore_liberar(Arvore *a);
+
+// Receptor que acrescenta a derivacao a arvore 'a'. Cada simbolo inicial
+// analisado vira uma nova raiz (pai = -1) no fim do vetor.
+ReceptorEventos arvore_receptor(Arvore *a);
+
+// Garante espaco para 'n' nos; usado por quem edita o vetor diretamente.
+void arvore_reservar(Arvore *a, int n);
+
+#endif
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "cfg.h"
+
+static void *alocar(size_t quantidade, size_t tamanho_item) {
+    void *dados = calloc(quantidade ? quantidade : 1, tamanho_item);
+    if (!dados) {
+        fprintf(stderr, "Erro: memoria insuficiente para o grafo de fluxo.\n");
+        exit(1);
+    }
+    return dados;
+}
+
+/* ============================ Instrucoes ============================ */
+
+int cfg_alvo(const Instrucao *ins) {
+    const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+    for (int k = 0; k < 3; k++)
+        if (papeis_opcode[ins->op][k] == PAPEL_ALVO)
+            return operandos[k];
+    return -1;
+}
+
+int cfg_sem_continuacao(const Instrucao *ins) {
+    switch (ins->op) {
+        case OP_PARAR:
+        case OP_RETORNAR_I:
+        case OP_RETORNAR_F:
+        case OP_SALTAR:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* ============================ Construcao ============================ */
+
+void cfg_construir(Cfg *g, const Programa *p) {
+    int n = p->num_instrucoes;
+    const Instrucao *codigo = p->codigo;
+    g->prog = p;
+
+    // Lideres: marcados em bloco_de (1 = comeca bloco), depois numerados.
+    int *bloco_de = alocar((size_t)n + 1, sizeof(int));
+    if (n > 0)
+        bloco_de[0] = 1;
+    for (int i = 0; i < n; i++) {
+        int alvo = cfg_alvo(&codigo[i]);
+        if (alvo >= 0 && alvo < n)
+            bloco_de[alvo] = 1;
+        if (alvo >= 0 || cfg_sem_continuacao(&codigo[i]))
+            bloco_de[i + 1] = 1;
+    }
+    int num_blocos = 0;
+    for (int i = 0; i < n; i++)
+        num_blocos += bloco_de[i];
+    int *inicio = alocar((size_t)num_blocos + 1, sizeof(int));
+    for (int i = 0, k = -1; i < n; i++) {
+        if (bloco_de[i])
+            inicio[++k] = i;
+        bloco_de[i] = k;
+    }
+    inicio[num_blocos] = n;
+
+    // Sucessores: no maximo dois por bloco (o que cai no fim e o alvo).
+    int *inicio_suc = alocar((size_t)num_blocos + 1, sizeof(int));
+    int *sucessores = alocar((size_t)num_blocos * 2, sizeof(int));
+    int num_arestas = 0;
+    for (int k = 0; k < num_blocos; k++) {
+        inicio_suc[k] = num_arestas;
+        int ultima = inicio[k + 1] - 1;
+        const Instrucao *ins = &codigo[ultima];
+        int seguinte = cfg_sem_continuacao(ins) || ultima + 1 >= n ? -1 : k + 1;
+        int alvo = cfg_alvo(ins);
+        alvo = alvo >= 0 && alvo < n ? bloco_de[alvo] : -1;
+        if (seguinte >= 0)
+            sucessores[num_arestas++] = seguinte;
+        if (alvo >= 0 && alvo != seguinte)
+            sucessores[num_arestas++] = alvo;
+    }
+    inicio_suc[num_blocos] = num_arestas;
+
+    // Predecessores por contagem: quantos chegam em cada bloco, soma
+    // prefixada e preenchimento na ordem dos blocos de origem.
+    int *inicio_pred = alocar((size_t)num_blocos + 1, sizeof(int));
+    int *predecessores = alocar((size_t)num_arestas, sizeof(int));
+    for (int e = 0; e < num_arestas; e++)
+        inicio_pred[sucessores[e] + 1]++;
+    for (int k = 0; k < num_blocos; k++)
+        inicio_pred[k + 1] += inicio_pred[k];
+    int *livre = alocar((size_t)num_blocos + 1, sizeof(int));
+    for (int k = 0; k < num_blocos; k++)
+        livre[k] = inicio_pred[k];
+    for (int k = 0; k < num_blocos; k++)
+        for (int e = inicio_suc[k]; e < inicio_suc[k + 1]; e++)
+            predecessores[livre[sucessores[e]]++] = k;
+    free(livre);
+
+    g->num_blocos = num_blocos;
+    g->num_arestas = num_arestas;
+    g->inicio = inicio;
+    g->bloco_de = bloco_de;
+    g->inicio_suc = inicio_suc;
+    g->sucessores = sucessores;
+    g->inicio_pred = inicio_pred;
+    g->predecessores = predecessores;
+}
+
+void cfg_liberar(Cfg *g) {
+    free(g->inicio);
+    free(g->bloco_de);
+    free(g->inicio_suc);
+    free(g->sucessores);
+    free(g->inicio_pred);
+    free(g->predecessores);
+    g->inicio = g->bloco_de = g->inicio_suc = g->sucessores = NULL;
+    g->inicio_pred = g->predecessores = NULL;
+    g->num_blocos = g->num_arestas = 0;
+}
+
+/* ============================ Listagem ============================ */
+
+static void listar_blocos(FILE *saida, const char *rotulo, const int *blocos, int de, int ate) {
+    fprintf(saida, "  %s:", rotulo);
+    if (de == ate)
+        fputs(" -", saida);
+    for (int e = de; e < ate; e++)
+        fprintf(saida, " B%d", blocos[e]);
+    fputc('\n', saida);
+}
+
+void cfg_imprimir(const Cfg *g, FILE *saida) {
+    for (int k = 0; k < g->num_blocos; k++) {
+        fprintf(saida, "B%d [%d, %d)\n", k, g->inicio[k], g->inicio[k + 1]);
+        listar_blocos(saida, "pred", g->predecessores, g->inicio_pred[k], g->inicio_pred[k + 1]);
+        for (int i = g->inicio[k]; i < g->inicio[k + 1]; i++)
+            vm_listar_instrucao(g->prog, i, saida);
+        listar_blocos(saida, "suc", g->sucessores, g->inicio_suc[k], g->inicio_suc[k + 1]);
+    }
+}
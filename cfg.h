@@ -0,0 +1,45 @@
+#ifndef CFG_H
+#define CFG_H
+
+#include <stdio.h>
+#include "vm.h"
+
+/* Grafo de fluxo de controle sobre o bytecode pronto. O if, o while, o for
+   e os blocos ja chegam aqui rebaixados para saltos pelos dois tradutores
+   (compilador.c e traducao.c), entao o grafo vale para os dois e para
+   qualquer passo depois da fusao. Um bloco basico e um trecho contiguo de
+   instrucoes: comeca na instrucao 0, num alvo de salto ou logo depois de
+   um salto ou de um fim (PARAR, RETORNAR_*), e as instrucoes do bloco k
+   sao prog->codigo[inicio[k] .. inicio[k + 1]). Sucessores e predecessores
+   ficam em vetores planos no formato CSR: os do bloco k sao
+   sucessores[inicio_suc[k] .. inicio_suc[k + 1]), o que cai no fim
+   primeiro e o alvo do salto depois (sem repetir quando coincidem). Sair
+   do programa nao e aresta. A construcao e linear no numero de
+   instrucoes: uma passada marca os lideres, outra liga os blocos e os
+   predecessores saem por contagem. */
+
+typedef struct {
+    const Programa *prog;
+    int num_blocos;
+    int num_arestas;
+    int *inicio;        // num_blocos + 1 entradas.
+    int *bloco_de;      // Bloco de cada instrucao.
+    int *inicio_suc;    // num_blocos + 1 entradas.
+    int *sucessores;    // num_arestas entradas.
+    int *inicio_pred;   // num_blocos + 1 entradas.
+    int *predecessores; // num_arestas entradas.
+} Cfg;
+
+// Monta o grafo de 'p', que deve continuar vivo enquanto o grafo for usado.
+void cfg_construir(Cfg *g, const Programa *p);
+void cfg_liberar(Cfg *g);
+
+// Alvo de salto da instrucao (-1 se nao salta).
+int cfg_alvo(const Instrucao *ins);
+// 1 se a execucao nunca segue para a instrucao seguinte.
+int cfg_sem_continuacao(const Instrucao *ins);
+
+// Lista os blocos com as instrucoes, os sucessores e os predecessores.
+void cfg_imprimir(const Cfg *g, FILE *saida);
+
+#endif
@@ -0,0 +1,190 @@
+#define _XOPEN_SOURCE 700
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "protocolo_servidor.h"
+
+/* Cliente leve do servidor de verificacao: nao monta tabelas, so envia
+   pedidos pelo socket e imprime uma linha de veredito por arquivo. */
+
+static int ler_tudo(int fd, void *destino, size_t n) {
+    char *p = destino;
+    while (n > 0) {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return 0;
+        p += r;
+        n -= (size_t)r;
+    }
+    return 1;
+}
+
+static int escrever_tudo(int fd, const void *origem, size_t n) {
+    const char *p = origem;
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            return 0;
+        p += w;
+        n -= (size_t)w;
+    }
+    return 1;
+}
+
+static double segundos_agora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Le todo o conteudo de 'arquivo' para um buffer alocado.
+static char *ler_conteudo(FILE *arquivo, size_t *tamanho) {
+    size_t capacidade = 65536, lidos = 0;
+    char *buffer = malloc(capacidade);
+    while (buffer) {
+        if (lidos == capacidade) {
+            char *maior = realloc(buffer, capacidade * 2);
+            if (!maior) {
+                free(buffer);
+                return NULL;
+            }
+            buffer = maior;
+            capacidade *= 2;
+        }
+        size_t n = fread(buffer + lidos, 1, capacidade - lidos, arquivo);
+        if (n == 0)
+            break;
+        lidos += n;
+    }
+    *tamanho = lidos;
+    return buffer;
+}
+
+// Envia um pedido e espera a resposta. Retorna 0 se a conexao falhou.
+static int pedir(int fd, uint32_t tipo, const void *carga, size_t tamanho, RespostaServidor *resp) {
+    CabecalhoPedido cab = { PROTOCOLO_MAGICO, tipo, (uint32_t)tamanho };
+    return escrever_tudo(fd, &cab, sizeof(cab)) &&
+           escrever_tudo(fd, carga, tamanho) &&
+           ler_tudo(fd, resp, sizeof(*resp));
+}
+
+static int imprimir_resposta(const char *nome, const RespostaServidor *resp,
+                             double ida_e_volta, int mostrar_tempo) {
+    if (resp->erros == RESPOSTA_ARQUIVO_ILEGIVEL)
+        printf("%s: ERRO (nao foi possivel abrir)", nome);
+    else if (resp->erros < 0)
+        printf("%s: ERRO (pedido invalido)", nome);
+    else if (resp->erros == 0)
+        printf("%s: OK", nome);
+    else
+        printf("%s: ERRO (%d erro(s) sintatico(s))", nome, (int)resp->erros);
+    if (mostrar_tempo)
+        printf(" [servidor %u us, ida e volta %.0f us]",
+               (unsigned)resp->microssegundos, ida_e_volta * 1e6);
+    printf("\n");
+    return resp->erros == 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr,
+                "Uso: %s socket [--buffer] [--tempo] [--encerrar] [arquivo...]\n"
+                "     sem arquivos, envia a entrada padrao.\n", argv[0]);
+        return 2;
+    }
+
+    int enviar_conteudo = 0, mostrar_tempo = 0, encerrar = 0, primeiro_arquivo = argc;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--buffer") == 0) {
+            enviar_conteudo = 1;
+        } else if (strcmp(argv[i], "--tempo") == 0) {
+            mostrar_tempo = 1;
+        } else if (strcmp(argv[i], "--encerrar") == 0) {
+            encerrar = 1;
+        } else {
+            primeiro_arquivo = i;
+            break;
+        }
+    }
+
+    struct sockaddr_un endereco;
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    if (strlen(argv[1]) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Erro: caminho do socket muito longo.\n");
+        return 2;
+    }
+    strcpy(endereco.sun_path, argv[1]);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&endereco, sizeof(endereco)) < 0) {
+        perror("connect");
+        return 2;
+    }
+
+    int falhas = 0;
+    RespostaServidor resp;
+
+    if (encerrar) {
+        CabecalhoPedido cab = { PROTOCOLO_MAGICO, PEDIDO_ENCERRAR, 0 };
+        escrever_tudo(fd, &cab, sizeof(cab));
+        ler_tudo(fd, &resp, sizeof(resp));
+        close(fd);
+        return 0;
+    }
+
+    if (primeiro_arquivo == argc) {
+        size_t tamanho;
+        char *texto = ler_conteudo(stdin, &tamanho);
+        double inicio = segundos_agora();
+        if (!texto || !pedir(fd, PEDIDO_BUFFER, texto, tamanho, &resp)) {
+            fprintf(stderr, "Erro: falha na comunicacao com o servidor.\n");
+            return 2;
+        }
+        falhas += !imprimir_resposta("stdin", &resp, segundos_agora() - inicio, mostrar_tempo);
+        free(texto);
+    }
+
+    for (int i = primeiro_arquivo; i < argc; i++) {
+        double inicio;
+        int ok;
+        if (enviar_conteudo) {
+            FILE *arquivo = fopen(argv[i], "rb");
+            if (!arquivo) {
+                printf("%s: ERRO (nao foi possivel abrir)\n", argv[i]);
+                falhas++;
+                continue;
+            }
+            size_t tamanho;
+            char *texto = ler_conteudo(arquivo, &tamanho);
+            fclose(arquivo);
+            inicio = segundos_agora();
+            ok = texto && pedir(fd, PEDIDO_BUFFER, texto, tamanho, &resp);
+            free(texto);
+        } else {
+            // O servidor pode ter outro diretorio de trabalho.
+            char absoluto[PATH_MAX];
+            const char *caminho = realpath(argv[i], absoluto) ? absoluto : argv[i];
+            inicio = segundos_agora();
+            ok = pedir(fd, PEDIDO_CAMINHO, caminho, strlen(caminho), &resp);
+        }
+        if (!ok) {
+            fprintf(stderr, "Erro: falha na comunicacao com o servidor.\n");
+            return 2;
+        }
+        falhas += !imprimir_resposta(argv[i], &resp, segundos_agora() - inicio, mostrar_tempo);
+    }
+
+    close(fd);
+    return falhas ? 1 : 0;
+}
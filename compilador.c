@@ -0,0 +1,766 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compilador.h"
+#include "parser.h"
+#include "arvore.h"
+#include "semantica.h"
+#include "saida.h"
+#include "traducao.h"
+#include "superinstrucoes.h"
+#include "sccp.h"
+#include "jit.h"
+#include "nativo.h"
+#include "transpilador.h"
+#include "cfg.h"
+#include "ssa.h"
+#include "estatisticas.h"
+#include "memoria.h"
+
+/* ============================ Analise ============================ */
+
+// Receptor que repassa os eventos para a arvore e para a analise semantica
+// e guarda onde cada token comeca no texto (para ler os literais).
+typedef struct {
+    ReceptorEventos arvore;
+    ReceptorEventos semantica;
+    const char *texto;
+    int *inicio_token;
+    int capacidade_inicios;
+} Traducao;
+
+static void traducao_entrar(void *contexto, int nt, int producao, int indice_token) {
+    Traducao *t = contexto;
+    t->arvore.entrar_nt(t->arvore.contexto, nt, producao, indice_token);
+    t->semantica.entrar_nt(t->semantica.contexto, nt, producao, indice_token);
+}
+
+static void traducao_sair(void *contexto, int nt, int producao, int indice_token) {
+    Traducao *t = contexto;
+    t->arvore.sair_nt(t->arvore.contexto, nt, producao, indice_token);
+    t->semantica.sair_nt(t->semantica.contexto, nt, producao, indice_token);
+}
+
+static void traducao_casar(void *contexto, int token, int indice_token,
+                           const char *lexema, int tamanho) {
+    Traducao *t = contexto;
+    t->inicio_token = crescer(t->inicio_token, &t->capacidade_inicios, indice_token + 1, sizeof(int));
+    t->inicio_token[indice_token] = (int)(lexema - t->texto);
+    t->arvore.casar_terminal(t->arvore.contexto, token, indice_token, lexema, tamanho);
+    t->semantica.casar_terminal(t->semantica.contexto, token, indice_token, lexema, tamanho);
+}
+
+/* ============================ Montagem ============================ */
+
+void montador_iniciar(Montador *m, Programa *prog) {
+    memset(m, 0, sizeof(*m));
+    m->prog = prog;
+}
+
+int montador_temporario(Montador *m) {
+    int t = m->proximo_temporario++;
+    if (m->proximo_temporario > m->maximo_temporarios)
+        m->maximo_temporarios = m->proximo_temporario;
+    return BASE_TEMPORARIO + t;
+}
+
+static unsigned posicao_constante(uint64_t bits, unsigned tipo, int capacidade) {
+    return (unsigned)((bits ^ tipo) * 0x9E3779B97F4A7C15ULL >> 40) & (unsigned)(capacidade - 1);
+}
+
+static void redistribuir_constantes(Montador *m) {
+    int nova = m->capacidade_tabela ? m->capacidade_tabela * 2 : 256;
+    free(m->tabela_constantes);
+    m->tabela_constantes = malloc((size_t)nova * sizeof(int));
+    if (!m->tabela_constantes) {
+        fprintf(stderr, "Erro: memoria insuficiente para o compilador.\n");
+        exit(1);
+    }
+    m->capacidade_tabela = nova;
+    for (int i = 0; i < nova; i++)
+        m->tabela_constantes[i] = -1;
+    for (int k = 0; k < m->num_constantes; k++) {
+        uint64_t bits;
+        memcpy(&bits, &m->constantes[k], sizeof(bits));
+        unsigned i = posicao_constante(bits, m->tipos_constantes[k], nova);
+        while (m->tabela_constantes[i] >= 0)
+            i = (i + 1) & (unsigned)(nova - 1);
+        m->tabela_constantes[i] = k;
+    }
+}
+
+int montador_constante(Montador *m, Valor v, TipoDado tipo) {
+    if (2 * (m->num_constantes + 1) > m->capacidade_tabela)
+        redistribuir_constantes(m);
+    uint64_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    unsigned mascara = (unsigned)m->capacidade_tabela - 1;
+    unsigned i = posicao_constante(bits, (unsigned)tipo, m->capacidade_tabela);
+    for (;;) {
+        int k = m->tabela_constantes[i];
+        if (k < 0)
+            break;
+        uint64_t outros;
+        memcpy(&outros, &m->constantes[k], sizeof(outros));
+        if (outros == bits && m->tipos_constantes[k] == tipo)
+            return BASE_CONSTANTE + k;
+        i = (i + 1) & mascara;
+    }
+    int k = m->num_constantes;
+    int capacidade = m->capacidade_constantes;
+    m->constantes = crescer(m->constantes, &capacidade, k + 1, sizeof(Valor));
+    m->tipos_constantes = crescer(m->tipos_constantes, &m->capacidade_constantes, k + 1, 1);
+    m->constantes[k] = v;
+    m->tipos_constantes[k] = (unsigned char)tipo;
+    m->num_constantes++;
+    m->tabela_constantes[i] = k;
+    return BASE_CONSTANTE + k;
+}
+
+TipoDado montador_literal(const char *lexema, Valor *v) {
+    int n = 0;
+    while (lexema[n] >= '0' && lexema[n] <= '9')
+        n++;
+    if (lexema[n] != '.') {
+        uint64_t x = 0;
+        for (int i = 0; i < n; i++)
+            x = x * 10 + (uint64_t)(lexema[i] - '0');
+        v->i = (int64_t)x;
+        return TIPO_INT;
+    }
+    char copia[64];
+    n = 0;
+    while (n < (int)sizeof(copia) - 1 && (lexema[n] == '.' || (lexema[n] >= '0' && lexema[n] <= '9'))) {
+        copia[n] = lexema[n];
+        n++;
+    }
+    copia[n] = '\0';
+    v->f = strtod(copia, NULL);
+    return TIPO_FLOAT;
+}
+
+void montador_concluir(Montador *m, int num_variaveis) {
+    Programa *p = m->prog;
+    int base_constantes = num_variaveis + m->maximo_temporarios;
+    for (int i = 0; i < p->num_instrucoes; i++) {
+        Instrucao *ins = &p->codigo[i];
+        int32_t *operandos[3] = { &ins->a, &ins->b, &ins->c };
+        for (int k = 0; k < 3; k++) {
+            int papel = papeis_opcode[ins->op][k];
+            if (papel != PAPEL_LIDO && papel != PAPEL_ESCRITO)
+                continue;
+            int32_t v = *operandos[k];
+            if (v >= BASE_CONSTANTE)
+                *operandos[k] = base_constantes + (v - BASE_CONSTANTE);
+            else if (v >= BASE_TEMPORARIO)
+                *operandos[k] = num_variaveis + (v - BASE_TEMPORARIO);
+        }
+    }
+    p->num_registradores = base_constantes + m->num_constantes;
+    p->num_variaveis = num_variaveis;
+    p->num_temporarios = m->maximo_temporarios;
+    p->registradores_constantes = malloc((size_t)(m->num_constantes + 1) * sizeof(int));
+    p->valores_constantes = malloc((size_t)(m->num_constantes + 1) * sizeof(Valor));
+    if (!p->registradores_constantes || !p->valores_constantes) {
+        fprintf(stderr, "Erro: memoria insuficiente para o compilador.\n");
+        exit(1);
+    }
+    for (int k = 0; k < m->num_constantes; k++) {
+        p->registradores_constantes[k] = base_constantes + k;
+        p->valores_constantes[k] = m->constantes[k];
+    }
+    p->num_constantes = m->num_constantes;
+    p->capacidade_constantes = m->num_constantes;
+    free(m->constantes);
+    free(m->tipos_constantes);
+    free(m->tabela_constantes);
+    m->constantes = NULL;
+    m->tipos_constantes = NULL;
+    m->tabela_constantes = NULL;
+}
+
+/* ============================ Geracao ============================ */
+
+typedef struct {
+    int reg;
+    TipoDado tipo;
+} Operando;
+
+typedef struct {
+    Montador m;
+    const NoArvore *nos;
+    const AnalisadorSemantico *sem;
+    const char *texto;
+    const int *inicio_token;
+} Compilador;
+
+static int primeiro_filho(const Compilador *c, int no) {
+    return c->nos[no].tamanho > 1 ? no + 1 : -1;
+}
+
+static int proximo_irmao(const Compilador *c, int pai, int filho) {
+    int n = filho + c->nos[filho].tamanho;
+    return n < pai + c->nos[pai].tamanho ? n : -1;
+}
+
+static int filho(const Compilador *c, int no, int k) {
+    int f = primeiro_filho(c, no);
+    while (f >= 0 && k-- > 0)
+        f = proximo_irmao(c, no, f);
+    return f;
+}
+
+static int token_do_no(const Compilador *c, int no) {
+    return c->nos[no].token_ini;
+}
+
+static const char *texto_do_no(const Compilador *c, int no) {
+    return c->texto + c->inicio_token[token_do_no(c, no)];
+}
+
+static int emitir(Compilador *c, int op, int a, int b, int cc) {
+    return programa_emitir(c->m.prog, op, a, b, cc);
+}
+
+static int novo_temporario(Compilador *c) {
+    return montador_temporario(&c->m);
+}
+
+static int constante(Compilador *c, Valor v, TipoDado tipo) {
+    return montador_constante(&c->m, v, tipo);
+}
+
+static Operando zero(Compilador *c, TipoDado tipo) {
+    Valor v;
+    if (tipo == TIPO_FLOAT)
+        v.f = 0.0;
+    else
+        v.i = 0;
+    Operando o = { constante(c, v, tipo), tipo };
+    return o;
+}
+
+// Converte para float se 'tipo' pede e o operando e int ou char.
+static Operando converter(Compilador *c, Operando o, TipoDado tipo) {
+    if (tipo != TIPO_FLOAT || o.tipo == TIPO_FLOAT)
+        return o;
+    Operando r = { novo_temporario(c), TIPO_FLOAT };
+    emitir(c, OP_I2F, r.reg, o.reg, 0);
+    return r;
+}
+
+static TipoDado juntar(TipoDado a, TipoDado b) {
+    return a > b ? a : b;
+}
+
+static Operando compilar_booleana(Compilador *c, int no);
+
+static Operando compilar_fator(Compilador *c, int no) {
+    int f = primeiro_filho(c, no);
+    int simbolo = c->nos[f].simbolo;
+    if (simbolo == SIM_TERMINAL(T_PA))
+        return compilar_booleana(c, proximo_irmao(c, no, f));
+
+    int token = token_do_no(c, f);
+    if (simbolo == SIM_TERMINAL(T_ID)) {
+        int d = semantica_declaracao_token(c->sem, token);
+        Operando o = { d, c->sem->declaracoes[d].tipo };
+        return o;
+    }
+
+    Valor v;
+    TipoDado tipo = montador_literal(texto_do_no(c, f), &v);
+    Operando o = { constante(c, v, tipo), tipo };
+    return o;
+}
+
+// Operacao de int ou de float do operador do no 'op'.
+static int opcode_aritmetico(const Compilador *c, int op, TipoDado tipo) {
+    int f = tipo == TIPO_FLOAT;
+    switch (c->nos[op].simbolo) {
+        case SIM_TERMINAL(T_SOMA): return f ? OP_SOMAR_F : OP_SOMAR_I;
+        case SIM_TERMINAL(T_SUB):  return f ? OP_SUBTRAIR_F : OP_SUBTRAIR_I;
+        case SIM_TERMINAL(T_MUL):  return f ? OP_MULTIPLICAR_F : OP_MULTIPLICAR_I;
+        default:                   return f ? OP_DIVIDIR_F : OP_DIVIDIR_I;
+    }
+}
+
+// Lista achatada "x op y op z ..." (EXPR_ARITMETICA ou TERMO), da
+// esquerda para a direita. O resultado de cada operador tem o tipo
+// anotado no token dele.
+static Operando compilar_lista(Compilador *c, int no, Operando (*operando)(Compilador *, int)) {
+    int marca = c->m.proximo_temporario;
+    int primeiro = primeiro_filho(c, no);
+    int resto = proximo_irmao(c, no, primeiro);
+    Operando acumulado = operando(c, primeiro);
+
+    for (int op = primeiro_filho(c, resto); op >= 0; ) {
+        int direita_no = proximo_irmao(c, resto, op);
+        Operando direita = operando(c, direita_no);
+        TipoDado tipo = semantica_tipo_token(c->sem, token_do_no(c, op));
+        Operando esquerda = converter(c, acumulado, tipo);
+        direita = converter(c, direita, tipo);
+        // Os temporarios dos operandos ja foram lidos: o resultado reusa o primeiro.
+        c->m.proximo_temporario = marca;
+        acumulado.reg = novo_temporario(c);
+        acumulado.tipo = tipo;
+        emitir(c, opcode_aritmetico(c, op, tipo), acumulado.reg, esquerda.reg, direita.reg);
+        op = proximo_irmao(c, resto, direita_no);
+    }
+    return acumulado;
+}
+
+static Operando compilar_termo(Compilador *c, int no) {
+    return compilar_lista(c, no, compilar_fator);
+}
+
+static Operando compilar_aritmetica(Compilador *c, int no) {
+    return compilar_lista(c, no, compilar_termo);
+}
+
+static Operando compilar_relacional(Compilador *c, int no) {
+    int marca = c->m.proximo_temporario;
+    int aritmetica = primeiro_filho(c, no);
+    int resto = proximo_irmao(c, no, aritmetica);
+    Operando esquerda = compilar_aritmetica(c, aritmetica);
+    int op = primeiro_filho(c, resto);
+    if (op < 0)
+        return esquerda;
+
+    Operando direita = compilar_aritmetica(c, proximo_irmao(c, resto, op));
+    TipoDado tipo = juntar(esquerda.tipo, direita.tipo);
+    esquerda = converter(c, esquerda, tipo);
+    direita = converter(c, direita, tipo);
+
+    const char *s = texto_do_no(c, op);
+    int codigo;
+    if (s[0] == '=')
+        codigo = OP_IGUAL_I;
+    else if (s[0] == '!')
+        codigo = OP_DIFERENTE_I;
+    else if (s[0] == '<')
+        codigo = s[1] == '=' ? OP_MENOR_IGUAL_I : OP_MENOR_I;
+    else
+        codigo = s[1] == '=' ? OP_MAIOR_IGUAL_I : OP_MAIOR_I;
+    if (tipo == TIPO_FLOAT)
+        codigo += OP_IGUAL_F - OP_IGUAL_I;
+
+    c->m.proximo_temporario = marca;
+    Operando r = { novo_temporario(c), TIPO_INT };
+    emitir(c, codigo, r.reg, esquerda.reg, direita.reg);
+    return r;
+}
+
+static Operando compilar_termo_booleano(Compilador *c, int no) {
+    int f = primeiro_filho(c, no);
+    if (c->nos[f].simbolo != SIM_TERMINAL(T_NOT))
+        return compilar_relacional(c, f);
+    int marca = c->m.proximo_temporario;
+    Operando v = compilar_termo_booleano(c, proximo_irmao(c, no, f));
+    c->m.proximo_temporario = marca;
+    Operando r = { novo_temporario(c), TIPO_INT };
+    emitir(c, v.tipo == TIPO_FLOAT ? OP_NAO_F : OP_NAO_I, r.reg, v.reg, 0);
+    return r;
+}
+
+// EXPR_BOOLEANA: "a && b || c" da esquerda para a direita, em curto-circuito.
+static Operando compilar_booleana(Compilador *c, int no) {
+    int termo = primeiro_filho(c, no);
+    int resto = proximo_irmao(c, no, termo);
+    if (primeiro_filho(c, resto) < 0)
+        return compilar_termo_booleano(c, termo);
+
+    int marca = c->m.proximo_temporario;
+    Operando r = { novo_temporario(c), TIPO_INT };
+    Operando v = compilar_termo_booleano(c, termo);
+    emitir(c, v.tipo == TIPO_FLOAT ? OP_VERDADE_F : OP_VERDADE_I, r.reg, v.reg, 0);
+    for (int op = primeiro_filho(c, resto); op >= 0; ) {
+        int direita = proximo_irmao(c, resto, op);
+        int e = texto_do_no(c, op)[0] == '&';
+        int salto = emitir(c, e ? OP_SALTAR_SE_FALSO : OP_SALTAR_SE_VERDADE, r.reg, -1, 0);
+        c->m.proximo_temporario = marca + 1;
+        v = compilar_termo_booleano(c, direita);
+        emitir(c, v.tipo == TIPO_FLOAT ? OP_VERDADE_F : OP_VERDADE_I, r.reg, v.reg, 0);
+        c->m.prog->codigo[salto].b = c->m.prog->num_instrucoes;
+        op = proximo_irmao(c, resto, direita);
+    }
+    c->m.proximo_temporario = marca + 1;
+    return r;
+}
+
+// Registrador de int com o valor de verdade da condicao.
+static int compilar_condicao(Compilador *c, int no) {
+    Operando v = compilar_booleana(c, no);
+    if (v.tipo != TIPO_FLOAT)
+        return v.reg;
+    int r = novo_temporario(c);
+    emitir(c, OP_VERDADE_F, r, v.reg, 0);
+    return r;
+}
+
+// 'variavel' = valor do no de expressao 'expressao'.
+static void compilar_atribuicao(Compilador *c, int token_variavel, int expressao) {
+    int d = semantica_declaracao_token(c->sem, token_variavel);
+    Operando v = compilar_aritmetica(c, expressao);
+    emitir(c, OP_MOVER, d, v.reg, 0);
+}
+
+static int compilar_comando(Compilador *c, int lista, int comando);
+
+static void compilar_lista_comandos(Compilador *c, int lista) {
+    for (int comando = primeiro_filho(c, lista); comando >= 0; )
+        comando = compilar_comando(c, lista, comando);
+}
+
+static void compilar_bloco(Compilador *c, int bloco) {
+    compilar_lista_comandos(c, filho(c, bloco, 1));
+}
+
+// Compila o COMANDO 'comando' de 'lista' e retorna o proximo a compilar
+// (o for consome o comando seguinte, que e o seu corpo).
+static int compilar_comando(Compilador *c, int lista, int comando) {
+    int proximo = proximo_irmao(c, lista, comando);
+    int no = primeiro_filho(c, comando);
+    int nt = c->nos[no].simbolo - NUM_TOKENS;
+    c->m.proximo_temporario = 0;
+
+    switch (nt) {
+        case NT_DECLARACAO_VAR: {
+            int nome = filho(c, no, 1);
+            int cauda = filho(c, no, 2);
+            int token = token_do_no(c, nome);
+            if (c->nos[primeiro_filho(c, cauda)].simbolo == SIM_TERMINAL(T_IGUAL)) {
+                compilar_atribuicao(c, token, filho(c, cauda, 1));
+            } else {
+                // Sem valor inicial: zera a cada execucao da declaracao.
+                int d = semantica_declaracao_token(c->sem, token);
+                emitir(c, OP_MOVER, d, zero(c, c->sem->declaracoes[d].tipo).reg, 0);
+            }
+            break;
+        }
+        case NT_ATRIBUICAO:
+            compilar_atribuicao(c, token_do_no(c, filho(c, no, 0)), filho(c, no, 2));
+            break;
+        case NT_COMANDO_LEITURA: {
+            int d = semantica_declaracao_token(c->sem, token_do_no(c, filho(c, no, 1)));
+            TipoDado tipo = c->sem->declaracoes[d].tipo;
+            emitir(c, tipo == TIPO_FLOAT ? OP_LER_F : tipo == TIPO_CHAR ? OP_LER_C : OP_LER_I,
+                   d, 0, 0);
+            break;
+        }
+        case NT_COMANDO_ESCRITA: {
+            Operando v = compilar_aritmetica(c, filho(c, no, 1));
+            emitir(c, v.tipo == TIPO_FLOAT ? OP_ESCREVER_F
+                      : v.tipo == TIPO_CHAR ? OP_ESCREVER_C : OP_ESCREVER_I, v.reg, 0, 0);
+            break;
+        }
+        case NT_COMANDO_RETORNO: {
+            Operando v = compilar_aritmetica(c, filho(c, no, 1));
+            emitir(c, v.tipo == TIPO_FLOAT ? OP_RETORNAR_F : OP_RETORNAR_I, v.reg, 0, 0);
+            break;
+        }
+        case NT_COMANDO_SE: {
+            int cond = compilar_condicao(c, filho(c, no, 2));
+            int salto_senao = emitir(c, OP_SALTAR_SE_FALSO, cond, -1, 0);
+            compilar_bloco(c, filho(c, no, 4));
+            int senao = filho(c, no, 5);
+            if (primeiro_filho(c, senao) >= 0) {
+                int salto_fim = emitir(c, OP_SALTAR, -1, 0, 0);
+                c->m.prog->codigo[salto_senao].b = c->m.prog->num_instrucoes;
+                compilar_bloco(c, filho(c, senao, 1));
+                c->m.prog->codigo[salto_fim].a = c->m.prog->num_instrucoes;
+            } else {
+                c->m.prog->codigo[salto_senao].b = c->m.prog->num_instrucoes;
+            }
+            break;
+        }
+        case NT_COMANDO_ENQUANTO: {
+            // Condicao no fim: um salto por volta em vez de dois.
+            int salto_teste = emitir(c, OP_SALTAR, -1, 0, 0);
+            int corpo = c->m.prog->num_instrucoes;
+            compilar_bloco(c, filho(c, no, 4));
+            c->m.prog->codigo[salto_teste].a = c->m.prog->num_instrucoes;
+            c->m.proximo_temporario = 0;
+            emitir(c, OP_SALTAR_SE_VERDADE, compilar_condicao(c, filho(c, no, 2)), corpo, 0);
+            break;
+        }
+        case NT_COMANDO_PARA: {
+            int inicio = filho(c, no, 2);
+            compilar_atribuicao(c, token_do_no(c, filho(c, inicio, 0)), filho(c, inicio, 2));
+            int salto_teste = emitir(c, OP_SALTAR, -1, 0, 0);
+            int corpo = c->m.prog->num_instrucoes;
+            if (proximo >= 0) {
+                proximo = compilar_comando(c, lista, proximo);
+                c->m.proximo_temporario = 0;
+            }
+            int passo = filho(c, no, 6);
+            compilar_atribuicao(c, token_do_no(c, filho(c, passo, 0)), filho(c, passo, 2));
+            c->m.prog->codigo[salto_teste].a = c->m.prog->num_instrucoes;
+            c->m.proximo_temporario = 0;
+            emitir(c, OP_SALTAR_SE_VERDADE, compilar_condicao(c, filho(c, no, 4)), corpo, 0);
+            break;
+        }
+        case NT_BLOCO:
+            compilar_bloco(c, no);
+            break;
+        default:
+            break;
+    }
+    return proximo;
+}
+
+int compilar_texto(const char *texto, size_t tamanho, Programa *prog, int relatar_erros) {
+    Arvore arvore;
+    AnalisadorSemantico semantica;
+    arvore_iniciar(&arvore);
+    semantica_iniciar(&semantica);
+    semantica.guardar_resolucoes = 1;
+
+    Traducao traducao = { arvore_receptor(&arvore), semantica_receptor(&semantica),
+                          texto, NULL, 0 };
+    ReceptorEventos receptor = { traducao_entrar, traducao_sair, traducao_casar, NULL, &traducao };
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, texto, tamanho);
+    FonteTokens fonte = fonte_lexer_reentrante(&lx);
+    Pilha pilha;
+    pilha_init(&pilha);
+    int erros = analisar_entrada(&pilha, &fonte, &receptor, relatar_erros);
+    pilha_liberar(&pilha);
+
+    if (erros) {
+        imprimir_veredito(erros);
+    } else if (semantica.num_erros) {
+        erros = semantica_relatar(&semantica, relatar_erros);
+    } else {
+        Compilador c;
+        montador_iniciar(&c.m, prog);
+        c.nos = arvore.nos;
+        c.sem = &semantica;
+        c.texto = texto;
+        c.inicio_token = traducao.inicio_token;
+        // PROGRAMA -> FUNCAO_MAIN -> tipo main ( ) { LISTA_COMANDOS }
+        compilar_lista_comandos(&c, filho(&c, 1, 5));
+        emitir(&c, OP_PARAR, 0, 0, 0);
+        montador_concluir(&c.m, semantica.num_declaracoes);
+    }
+
+    free(traducao.inicio_token);
+    semantica_liberar(&semantica);
+    arvore_liberar(&arvore);
+    return erros;
+}
+
+/* ============================ Linha de comando ============================ */
+
+// Le, compila, otimiza (com 'otimizar') e funde (com 'fundir') o programa
+// de 'caminho' em 'prog'. Retorna 0 se 'prog' esta pronto.
+static int carregar(const char *caminho, const OpcoesExecucao *opcoes, Programa *prog,
+                    double *segundos, ResultadoSccp *sccp, ResultadoFusao *fusao) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo) {
+        fprintf(stderr, "Erro: nao foi possivel abrir '%s'.\n", caminho);
+        return 1;
+    }
+    size_t tamanho;
+    char *texto = ler_fluxo_inteiro(arquivo, &tamanho);
+    fclose(arquivo);
+    if (!texto) {
+        fprintf(stderr, "Erro: memoria insuficiente para ler '%s'.\n", caminho);
+        return 1;
+    }
+
+    double inicio = relogio_monotonico();
+    int relatar = nivel_saida >= NIVEL_DIAGNOSTICO;
+    int erros = opcoes->uma_passada ? traduzir_texto(texto, tamanho, prog, relatar)
+                                    : compilar_texto(texto, tamanho, prog, relatar);
+    ResultadoSccp nada = { 0, 0, 0, 0 };
+    *sccp = nada;
+    if (!erros && opcoes->otimizar)
+        *sccp = propagar_constantes(prog);
+    ResultadoFusao nenhuma = { 0, 0, 0 };
+    *fusao = nenhuma;
+    if (!erros && opcoes->fundir)
+        *fusao = fundir_superinstrucoes(prog);
+    *segundos = relogio_monotonico() - inicio;
+    free(texto);
+    if (erros)
+        saida_descarregar();
+    return erros;
+}
+
+int executar_arquivo(const char *caminho, const OpcoesExecucao *opcoes) {
+    Programa prog;
+    programa_iniciar(&prog);
+    double compilacao;
+    ResultadoSccp sccp;
+    ResultadoFusao fusao;
+    if (carregar(caminho, opcoes, &prog, &compilacao, &sccp, &fusao)) {
+        programa_liberar(&prog);
+        return 1;
+    }
+
+    int codigo = 0;
+    if (opcoes->modo == EXECUCAO_LISTAR) {
+        vm_listar(&prog, stdout);
+    } else if (opcoes->modo == EXECUCAO_ASSEMBLY) {
+        nativo_emitir_assembly(&prog, stdout);
+    } else if (opcoes->modo == EXECUCAO_NATIVO) {
+        codigo = nativo_construir(&prog, opcoes->binario);
+    } else if (opcoes->modo == EXECUCAO_C) {
+        transpilar_c(&prog, stdout);
+    } else if (opcoes->modo == EXECUCAO_COMPILAR_C) {
+        codigo = transpilar_construir(&prog, opcoes->binario);
+    } else if (opcoes->modo == EXECUCAO_CONFERIR_C) {
+        codigo = transpilar_conferir(&prog);
+    } else if (opcoes->modo == EXECUCAO_CFG) {
+        double inicio = relogio_monotonico();
+        Cfg cfg;
+        cfg_construir(&cfg, &prog);
+        double construcao = relogio_monotonico() - inicio;
+        cfg_imprimir(&cfg, stdout);
+        fprintf(stderr, "CFG: %d blocos, %d arestas, %d instrucoes (%.3f ms)\n",
+                cfg.num_blocos, cfg.num_arestas, prog.num_instrucoes, construcao * 1e3);
+        cfg_liberar(&cfg);
+    } else if (opcoes->modo == EXECUCAO_SSA) {
+        double inicio = relogio_monotonico();
+        Cfg cfg;
+        cfg_construir(&cfg, &prog);
+        double construcao = relogio_monotonico() - inicio;
+        Ssa ssa;
+        ssa_construir(&ssa, &cfg);
+        ssa_imprimir(&ssa, stdout);
+        fprintf(stderr, "SSA: %d instrucoes, %d blocos (%d alcancaveis), %d phis, %d valores\n",
+                prog.num_instrucoes, cfg.num_blocos, ssa.num_alcancaveis, ssa.num_phis,
+                ssa.num_valores);
+        fprintf(stderr, "Tempos: cfg %.1f ms, rpo %.1f ms, dominadores %.1f ms (%d voltas), "
+                "fronteiras %.1f ms, phis %.1f ms, renomeacao %.1f ms\n", construcao * 1e3,
+                ssa.tempo_ordem * 1e3, ssa.tempo_dominadores * 1e3, ssa.voltas_dominadores,
+                ssa.tempo_fronteiras * 1e3, ssa.tempo_phis * 1e3, ssa.tempo_renomeacao * 1e3);
+        ssa_liberar(&ssa);
+        cfg_liberar(&cfg);
+    } else {
+        Jit jit;
+        jit_iniciar(&jit, &prog);
+        double inicio = relogio_monotonico();
+        ResultadoExecucao r = opcoes->jit ? vm_executar_com_jit(&prog, stdin, stdout, &jit)
+                                          : vm_executar(&prog, stdin, stdout, 0);
+        double execucao = relogio_monotonico() - inicio;
+        fflush(stdout);
+        codigo = r.erro ? 1 : (int)(r.retorno & 0xff);
+
+        if (opcoes->modo == EXECUCAO_MEDIR) {
+            // Segunda execucao so para contar despachos (sem entrada nem saida).
+            FILE *nulo_entrada = fopen("/dev/null", "r");
+            FILE *nulo_saida = fopen("/dev/null", "w");
+            double inicio_contagem = relogio_monotonico();
+            ResultadoExecucao contagem = vm_executar(&prog, nulo_entrada ? nulo_entrada : stdin,
+                                                     nulo_saida ? nulo_saida : stdout, 1);
+            double tempo_contagem = relogio_monotonico() - inicio_contagem;
+            if (nulo_entrada)
+                fclose(nulo_entrada);
+            if (nulo_saida)
+                fclose(nulo_saida);
+            fprintf(stderr, "Compilacao: %.3f ms (%d instrucoes, %d registradores)\n",
+                    compilacao * 1e3, prog.num_instrucoes, prog.num_registradores);
+            if (opcoes->otimizar)
+                fprintf(stderr, "SCCP: %d instrucoes removidas (%d blocos inalcancaveis, "
+                        "%d saltos resolvidos, %d resultados constantes)\n",
+                        sccp.instrucoes_removidas, sccp.blocos_removidos,
+                        sccp.saltos_resolvidos, sccp.resultados_constantes);
+            if (opcoes->fundir)
+                fprintf(stderr, "Fusao: %d SOMAR_K_I, %d operacoes em variavel, "
+                        "%d comparacoes com salto\n", fusao.somas_constantes,
+                        fusao.operacoes_em_variavel, fusao.comparacoes_e_saltos);
+            fprintf(stderr, "Execucao: %.3f s\n", execucao);
+            if (opcoes->jit && jit_disponivel())
+                fprintf(stderr, "JIT: %d lacos compilados (%zu bytes), %d recusados, "
+                        "%lld entradas no codigo nativo\n", jit.num_lacos, jit.bytes,
+                        jit.lacos_recusados, jit.entradas);
+            else if (opcoes->jit)
+                fprintf(stderr, "JIT: indisponivel nesta plataforma\n");
+            fprintf(stderr, "Despachos: %lld (%.2f ns por despacho; com contador: %.3f s)\n",
+                    contagem.despachos,
+                    contagem.despachos ? execucao * 1e9 / (double)contagem.despachos : 0.0,
+                    tempo_contagem);
+        }
+        jit_liberar(&jit);
+    }
+    programa_liberar(&prog);
+    return codigo;
+}
+
+typedef struct {
+    int anterior;
+    int op;
+    long long vezes;
+} Par;
+
+static int comparar_pares(const void *a, const void *b) {
+    long long x = ((const Par *)a)->vezes, y = ((const Par *)b)->vezes;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+int perfilar_pares(char **caminhos, int quantidade, const OpcoesExecucao *opcoes) {
+    long long *pares = calloc((size_t)NUM_OPCODES * NUM_OPCODES, sizeof(long long));
+    long long por_opcode[NUM_OPCODES] = { 0 };
+    if (!pares) {
+        fprintf(stderr, "Erro: memoria insuficiente para o perfil de pares.\n");
+        return 1;
+    }
+    long long despachos = 0;
+    int falhas = 0;
+    for (int i = 0; i < quantidade; i++) {
+        Programa prog;
+        programa_iniciar(&prog);
+        double segundos;
+        ResultadoSccp sccp;
+        ResultadoFusao fusao;
+        if (carregar(caminhos[i], opcoes, &prog, &segundos, &sccp, &fusao)) {
+            falhas++;
+            programa_liberar(&prog);
+            continue;
+        }
+        FILE *nulo_entrada = fopen("/dev/null", "r");
+        FILE *nulo_saida = fopen("/dev/null", "w");
+        ResultadoExecucao r = vm_perfilar_pares(&prog, nulo_entrada ? nulo_entrada : stdin,
+                                                nulo_saida ? nulo_saida : stdout, pares);
+        if (nulo_entrada)
+            fclose(nulo_entrada);
+        if (nulo_saida)
+            fclose(nulo_saida);
+        despachos += r.despachos;
+        programa_liberar(&prog);
+    }
+
+    // O primeiro despacho de cada programa conta como par (PARAR, op).
+    Par *lista = malloc((size_t)NUM_OPCODES * NUM_OPCODES * sizeof(Par));
+    int num = 0;
+    for (int a = 0; a < NUM_OPCODES; a++)
+        for (int b = 0; b < NUM_OPCODES; b++) {
+            long long v = pares[a * NUM_OPCODES + b];
+            por_opcode[b] += v;
+            if (v && lista) {
+                Par par = { a, b, v };
+                lista[num++] = par;
+            }
+        }
+    if (lista)
+        qsort(lista, (size_t)num, sizeof(Par), comparar_pares);
+
+    printf("Perfil de pares: %d programa(s), %d com erro, %lld despachos\n",
+           quantidade, falhas, despachos);
+    printf("\n%-24s %-24s %14s %7s\n", "ANTERIOR", "SEGUINTE", "VEZES", "%");
+    for (int i = 0; i < num && i < 20; i++)
+        printf("%-24s %-24s %14lld %6.2f%%\n", nome_opcode(lista[i].anterior),
+               nome_opcode(lista[i].op), lista[i].vezes,
+               despachos ? 100.0 * (double)lista[i].vezes / (double)despachos : 0.0);
+    printf("\n%-24s %14s %7s\n", "INSTRUCAO", "VEZES", "%");
+    for (int op = 0; op < NUM_OPCODES; op++)
+        if (por_opcode[op])
+            printf("%-24s %14lld %6.2f%%\n", nome_opcode(op), por_opcode[op],
+                   despachos ? 100.0 * (double)por_opcode[op] / (double)despachos : 0.0);
+    free(lista);
+    free(pares);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+#ifndef COMPILADOR_H
+#define COMPILADOR_H
+
+#include <stddef.h>
+#include "vm.h"
+#include "semantica.h"
+
+/* Compilador de cmini para o bytecode de vm.h.
+   Uma unica analise do texto monta a arvore sintatica (arvore.c) e, pelos
+   mesmos eventos, faz a analise semantica com a resolucao de nomes
+   guardada. Se nao houver erros, a arvore e percorrida uma vez: cada
+   declaracao vira um registrador, as constantes viram registradores
+   pre-carregados e os temporarios de cada comando sao reaproveitados no
+   comando seguinte. && e || avaliam em curto-circuito. O corpo de um
+   "for (...)" e o comando seguinte da mesma lista, como em C (a gramatica
+   termina o for no ')'). */
+
+/* ============================ Montagem ============================ */
+
+// Estado de montagem comum aos tradutores (arvore e uma passada). Durante a
+// traducao os operandos sao: numero da declaracao para variaveis,
+// BASE_TEMPORARIO + t para temporarios e BASE_CONSTANTE + k para
+// constantes; montador_concluir troca as bases pelos numeros finais.
+#define BASE_TEMPORARIO  (1 << 29)
+#define BASE_CONSTANTE   (1 << 30)
+
+typedef struct {
+    Programa *prog;
+    int proximo_temporario;
+    int maximo_temporarios;
+    // Constantes distintas: tabela hash de (tipo, bits) -> indice.
+    Valor *constantes;
+    unsigned char *tipos_constantes;
+    int num_constantes;
+    int capacidade_constantes;
+    int *tabela_constantes;
+    int capacidade_tabela;
+} Montador;
+
+void montador_iniciar(Montador *m, Programa *prog);
+// Novo temporario acima dos que estao em uso.
+int montador_temporario(Montador *m);
+// Registrador da constante 'v' do tipo 'tipo' (a mesma para valores iguais).
+int montador_constante(Montador *m, Valor v, TipoDado tipo);
+// Valor e tipo do T_NUM que comeca em 'lexema' (digitos com parte decimal
+// opcional, como no lexer).
+TipoDado montador_literal(const char *lexema, Valor *v);
+// Reloca os operandos para [variaveis][temporarios][constantes], carrega as
+// constantes em 'prog' e libera o montador.
+void montador_concluir(Montador *m, int num_variaveis);
+
+/* ============================ Compilacao ============================ */
+
+typedef enum {
+    EXECUCAO_RODAR,     // Executa, com read/print na entrada e saida padrao.
+    EXECUCAO_LISTAR,    // Lista o bytecode.
+    EXECUCAO_MEDIR,     // Executa e mede compilacao, execucao e despachos.
+    EXECUCAO_ASSEMBLY,  // Lista o assembly x86-64 (nativo.h).
+    EXECUCAO_NATIVO,    // Gera o executavel 'binario' (nativo.h).
+    EXECUCAO_C,         // Lista o programa em C (transpilador.h).
+    EXECUCAO_COMPILAR_C,    // Gera o executavel 'binario' a partir do C.
+    EXECUCAO_CONFERIR_C,    // Compara a VM com o binario do C na mesma entrada.
+    EXECUCAO_CFG,       // Lista o grafo de fluxo de controle (cfg.h).
+    EXECUCAO_SSA        // Lista a forma SSA e mede cada etapa (ssa.h).
+} ModoExecucao;
+
+// Compila 'texto' para 'prog' (que deve estar iniciado). Os erros sao
+// relatados pela saida.h se 'relatar_erros'. Retorna o numero de erros
+// sintaticos ou semanticos (0 = 'prog' pronto).
+int compilar_texto(const char *texto, size_t tamanho, Programa *prog, int relatar_erros);
+
+typedef struct {
+    ModoExecucao modo;
+    int uma_passada;    // Traduz com traducao.c em vez de montar a arvore.
+    int otimizar;       // Propaga as constantes (sccp.h), antes da fusao.
+    int fundir;         // Aplica as superinstrucoes (superinstrucoes.h).
+    int jit;            // Compila os lacos quentes para a maquina (jit.h).
+    const char *binario;    // Destino de EXECUCAO_NATIVO e EXECUCAO_COMPILAR_C.
+} OpcoesExecucao;
+
+// Modos --executar, --bytecode, --medir-execucao, --assembly, --nativo,
+// --codigo-c, --compilar-c, --conferir-c, --cfg e --ssa sobre o arquivo 'caminho'.
+// Retorna o codigo de saida do processo: o valor do return do programa
+// (0 se o main acaba), ou 1 se houve erro de compilacao ou de execucao.
+int executar_arquivo(const char *caminho, const OpcoesExecucao *opcoes);
+
+// --perfil-pares: executa cada programa (entrada e saida em /dev/null) e
+// imprime os pares de instrucoes despachados em sequencia mais frequentes
+// no corpus todo, e a frequencia de cada instrucao.
+int perfilar_pares(char **caminhos, int quantidade, const OpcoesExecucao *opcoes);
+
+#endif
@@ -0,0 +1,91 @@
+#!/bin/sh
+# Confere os backends entre si em cada programa deste diretorio. A
+# referencia e a VM (--executar) com o compilador padrao; para cada
+# variacao de compilacao, a VM, o C transpilado (--conferir-c) e o
+# assembly nativo (--nativo) devem dar a mesma saida padrao e o mesmo
+# codigo de saida. A entrada de X.cmini e X.entrada, se existir. Os
+# programas e os arquivos X.lexico (texto que so exercita o lexico) tambem
+# passam por --conferir-lexer: lexer.l e lexer_reentrante.c devem dar os
+# mesmos tokens. Por fim, programas de --gerar com algumas sementes
+# devem passar em --semantico.
+# Termina com 1 se alguma comparacao falhar.
+#
+# Uso: conformidade/conferir.sh [caminho/do/analisador]
+
+analisador=${1:-./analisador}
+diretorio=$(cd "$(dirname "$0")" && pwd)
+temporario=$(mktemp -d "${TMPDIR:-/tmp}/conformidade.XXXXXX") || exit 1
+trap 'rm -rf "$temporario"' EXIT
+
+nativo=1
+case $(uname -m) in
+    x86_64|amd64) ;;
+    *) nativo=0; echo "(sem --nativo: o assembly gerado e x86-64)" ;;
+esac
+
+falhas=0
+total=0
+
+falhar() {
+    echo "FALHA $1: $2"
+    falhas=$((falhas + 1))
+}
+
+# Compara saida e codigo de 'rodada' com os da referencia.
+comparar() {
+    total=$((total + 1))
+    if ! cmp -s "$temporario/referencia" "$temporario/rodada"; then
+        falhar "$1" "saida diferente da VM"
+    elif [ "$2" != "$codigo_referencia" ]; then
+        falhar "$1" "codigo de saida $2, VM $codigo_referencia"
+    fi
+}
+
+for arquivo in "$diretorio"/*.cmini "$diretorio"/*.lexico; do
+    total=$((total + 1))
+    if ! "$analisador" --conferir-lexer "$arquivo" > "$temporario/lexico" 2> /dev/null; then
+        falhar "$(basename "$arquivo") --conferir-lexer" "$(head -n 1 "$temporario/lexico")"
+    fi
+done
+
+for programa in "$diretorio"/*.cmini; do
+    nome=$(basename "$programa" .cmini)
+    entrada="$diretorio/$nome.entrada"
+    [ -f "$entrada" ] || entrada=/dev/null
+
+    "$analisador" --executar "$programa" < "$entrada" > "$temporario/referencia" 2> /dev/null
+    codigo_referencia=$?
+
+    for variacao in "" --uma-passada --sem-sccp --sem-fusao; do
+        rotulo="$nome${variacao:+ $variacao}"
+
+        "$analisador" $variacao --executar "$programa" < "$entrada" > "$temporario/rodada" 2> /dev/null
+        comparar "$rotulo --executar" $?
+
+        total=$((total + 1))
+        if ! "$analisador" $variacao --conferir-c "$programa" < "$entrada" > "$temporario/conferencia" 2>&1; then
+            falhar "$rotulo --conferir-c" "$(head -n 1 "$temporario/conferencia")"
+        fi
+
+        if [ $nativo = 1 ]; then
+            if "$analisador" $variacao --nativo "$programa" "$temporario/binario" > /dev/null 2>&1; then
+                "$temporario/binario" < "$entrada" > "$temporario/rodada" 2> /dev/null
+                comparar "$rotulo --nativo" $?
+            else
+                total=$((total + 1))
+                falhar "$rotulo --nativo" "nao compilou"
+            fi
+        fi
+    done
+done
+
+for semente in 1 2 3 4 5 6 7 8; do
+    total=$((total + 1))
+    if ! "$analisador" --gerar 16K --semente $semente > "$temporario/gerado.cmini" ||
+       ! "$analisador" --nivel silencioso --semantico < "$temporario/gerado.cmini" > /dev/null 2>&1; then
+        falhar "--gerar 16K --semente $semente" "nao passou em --semantico"
+    fi
+done
+
+echo "$total comparacoes, $falhas falha(s)"
+[ $falhas = 0 ]
@@ -0,0 +1,49 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "construcao.h"
+
+int construcao_criar_diretorio(char *diretorio, size_t tamanho) {
+    const char *base = getenv("TMPDIR");
+    snprintf(diretorio, tamanho, "%s/cminiXXXXXX", base && *base ? base : "/tmp");
+    if (!mkdtemp(diretorio)) {
+        fprintf(stderr, "Erro: nao foi possivel criar o diretorio temporario.\n");
+        return 0;
+    }
+    return 1;
+}
+
+void construcao_citar(char *comando, size_t tamanho, const char *caminho) {
+    size_t n = strlen(comando);
+    if (n + 1 < tamanho)
+        comando[n++] = '\'';
+    for (const char *c = caminho; *c && n + 5 < tamanho; c++) {
+        if (*c == '\'') {
+            memcpy(comando + n, "'\\''", 4);
+            n += 4;
+        } else {
+            comando[n++] = *c;
+        }
+    }
+    if (n + 1 < tamanho)
+        comando[n++] = '\'';
+    comando[n] = '\0';
+}
+
+int construcao_compilar(const char *opcoes, const char *binario,
+                        const char *const *fontes, int num_fontes) {
+    const char *cc = getenv("CC");
+    char comando[4096];
+    snprintf(comando, sizeof(comando), "%s %s -o ", cc && *cc ? cc : "cc", opcoes);
+    construcao_citar(comando, sizeof(comando), binario);
+    for (int i = 0; i < num_fontes; i++) {
+        strncat(comando, " ", sizeof(comando) - strlen(comando) - 1);
+        construcao_citar(comando, sizeof(comando), fontes[i]);
+    }
+    if (system(comando) == 0)
+        return 0;
+    fprintf(stderr, "Erro: falha ao compilar '%s' (%s).\n", binario, comando);
+    return 1;
+}
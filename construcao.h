@@ -0,0 +1,23 @@
+#ifndef CONSTRUCAO_H
+#define CONSTRUCAO_H
+
+#include <stddef.h>
+
+/* Construcao de executaveis pelo compilador C do sistema, comum a
+   nativo.c (assembly + runtime) e transpilador.c (C). Os arquivos
+   intermediarios ficam num diretorio temporario proprio, criado com
+   mkdtemp em $TMPDIR (ou /tmp), e os caminhos vao para o shell entre
+   aspas simples. */
+
+// Cria o diretorio temporario em 'diretorio'. Retorna 0 (com mensagem) se falhar.
+int construcao_criar_diretorio(char *diretorio, size_t tamanho);
+
+// Acrescenta 'caminho' entre aspas simples do shell a 'comando'.
+void construcao_citar(char *comando, size_t tamanho, const char *caminho);
+
+// Roda "$CC opcoes -o binario fontes..." (cc se $CC estiver vazio), com os
+// caminhos citados. Retorna 0 se deu certo; senao imprime o comando e retorna 1.
+int construcao_compilar(const char *opcoes, const char *binario,
+                        const char *const *fontes, int num_fontes);
+
+#endif
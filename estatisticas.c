@@ -0,0 +1,37 @@
+#define _POSIX_C_SOURCE 200809L
+#include <time.h>
+#include "estatisticas.h"
+
+Estatisticas estatisticas = { .bytes = -1 };
+
+double relogio_monotonico(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void estatisticas_somar_analise(long tokens, long expansoes, long casamentos, int profundidade) {
+    atomic_fetch_add(&estatisticas.tokens, tokens);
+    atomic_fetch_add(&estatisticas.expansoes, expansoes);
+    atomic_fetch_add(&estatisticas.casamentos, casamentos);
+    int atual = atomic_load(&estatisticas.profundidade_maxima);
+    while (profundidade > atual &&
+           !atomic_compare_exchange_weak(&estatisticas.profundidade_maxima, &atual, profundidade))
+        ;
+}
+
+void estatisticas_imprimir_json(FILE *destino, double total, int codigo_saida) {
+    static const char *const nomes[NUM_FASES] = {
+        "producoes", "first", "follow", "tabela", "sincronizacao",
+        "leitura", "lexico", "analise", "saida"
+    };
+    fprintf(destino, "{\"fases_us\":{");
+    for (int f = 0; f < NUM_FASES; f++)
+        fprintf(destino, "\"%s\":%.1f,", nomes[f], estatisticas.segundos[f] * 1e6);
+    fprintf(destino, "\"total\":%.1f},", total * 1e6);
+    fprintf(destino, "\"tokens\":%ld,\"expansoes\":%ld,\"casamentos\":%ld,"
+                     "\"profundidade_maxima_pilha\":%d,\"bytes\":%ld,\"codigo_saida\":%d}\n",
+            atomic_load(&estatisticas.tokens), atomic_load(&estatisticas.expansoes),
+            atomic_load(&estatisticas.casamentos), atomic_load(&estatisticas.profundidade_maxima),
+            estatisticas.bytes, codigo_saida);
+}
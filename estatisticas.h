@@ -0,0 +1,57 @@
+#ifndef ESTATISTICAS_H
+#define ESTATISTICAS_H
+
+#include <stdio.h>
+#include <stdatomic.h>
+
+/* Estatisticas de uma execucao (--stats): duracao de cada fase, medida com
+   o relogio monotonico, e contadores da analise. Desligadas, custam um
+   teste de 'ativas' por fase e, por analise, nada alem dos contadores que o
+   driver ja mantem em EstadoAnalise. */
+
+typedef enum {
+    FASE_PRODUCOES,      // inicializar_producoes
+    FASE_FIRST,          // anulaveis e FIRST
+    FASE_FOLLOW,
+    FASE_TABELA,         // tabela LL(1)
+    FASE_SINCRONIZACAO,  // conjuntos de sincronizacao e listas recursivas
+    FASE_LEITURA,        // entrada lida para a memoria (modos com buffer)
+    FASE_LEXICO,         // dentro do lexer (so no caminho do Flex)
+    FASE_ANALISE,        // driver LL(1) (inclui o lexico quando ele nao e separado)
+    FASE_SAIDA,          // montagem e escrita da saida
+    NUM_FASES
+} FaseEstatistica;
+
+typedef struct {
+    int ativas;
+    double segundos[NUM_FASES];
+    // Atomicos porque as analises em fatias somam de varias threads.
+    atomic_long tokens;
+    atomic_long expansoes;
+    atomic_long casamentos;
+    atomic_int profundidade_maxima;  // Maior altura da pilha de analise.
+    long bytes;                      // -1 se desconhecido.
+} Estatisticas;
+
+extern Estatisticas estatisticas;
+
+double relogio_monotonico(void);
+
+// Marca o inicio de uma fase (0 se desligadas).
+static inline double estatisticas_marcar(void) {
+    return estatisticas.ativas ? relogio_monotonico() : 0.0;
+}
+
+// Soma a 'fase' o tempo desde 'inicio'.
+static inline void estatisticas_fase(FaseEstatistica fase, double inicio) {
+    if (estatisticas.ativas)
+        estatisticas.segundos[fase] += relogio_monotonico() - inicio;
+}
+
+// Acumula os contadores de uma analise.
+void estatisticas_somar_analise(long tokens, long expansoes, long casamentos, int profundidade);
+
+// Imprime tudo como um objeto JSON numa linha.
+void estatisticas_imprimir_json(FILE *destino, double total, int codigo_saida);
+
+#endif
@@ -0,0 +1,500 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gerador.h"
+#include "semantica.h"
+
+#define ALTURA_INFINITA 1000000
+#define TAMANHO_BLOCO_SAIDA (1 << 16)
+#define VARIAVEIS_POR_TIPO 8
+
+// Pesos padrao, na ordem de inicializar_producoes(). Fazem os comandos
+// parecerem codigo comum: mais atribuicoes que lacos, expressoes curtas.
+static const int pesos_padrao[NUM_PRODUCTIONS] = {
+    1, 1,                       //  0-1:  PROGRAMA, FUNCAO_MAIN
+    4, 1,                       //  2-3:  LISTA_COMANDOS (mais um / fim)
+    3, 4, 2, 1, 1, 1, 2, 1, 1,  //  4-12: COMANDO
+    1,                          // 13:    BLOCO
+    1, 3, 1,                    // 14-16: declaracao (com / sem valor)
+    1, 1, 1, 1,                 // 17-20: atribuicao, read, print, return
+    1, 1, 1,                    // 21-23: if, else, sem else
+    1, 1, 1,                    // 24-26: while, for, atribuicao simples
+    1, 1, 3,                    // 27-29: EXPR_BOOLEANA e && / ||
+    1, 6,                       // 30-31: ! ou relacional
+    1, 3, 1,                    // 32-34: comparacao
+    1, 2, 1, 3,                 // 35-38: + e -
+    1, 1, 1, 3,                 // 39-42: * e /
+    1, 4, 3                     // 43-45: ( ), ID, NUM
+};
+
+static const char *const tipos[] = { "int", "float", "char" };
+// Inicial das variaveis do inicio do main, por TipoDado: i0.., f0..
+static const char prefixo_variavel[] = { 0, 0, 'i', 'f' };
+static const char *const comparacoes[] = { "==", "!=", ">", "<", ">=", "<=" };
+static const char *const logicos[] = { "&&", "||" };
+
+void gerador_config_padrao(ConfigGerador *c) {
+    c->semente = 1;
+    c->tamanho_alvo = 1024;
+    c->profundidade_maxima = 24;
+    c->largura_maxima = 4;
+    memcpy(c->pesos, pesos_padrao, sizeof(c->pesos));
+}
+
+int gerador_ajustar_peso(ConfigGerador *c, const char *texto) {
+    char *fim;
+    long p = strtol(texto, &fim, 10);
+    if (fim == texto || *fim != '=' || p < 0 || p >= NUM_PRODUCTIONS)
+        return 0;
+    const char *valor = fim + 1;
+    long w = strtol(valor, &fim, 10);
+    if (fim == valor || *fim != '\0' || w < 0)
+        return 0;
+    c->pesos[p] = (int)w;
+    return 1;
+}
+
+long long gerador_ler_tamanho(const char *texto) {
+    char *fim;
+    long long n = strtoll(texto, &fim, 10);
+    if (fim == texto || n < 0)
+        return -1;
+    switch (*fim) {
+        case '\0':            return n;
+        case 'k': case 'K':   n <<= 10; break;
+        case 'm': case 'M':   n <<= 20; break;
+        case 'g': case 'G':   n <<= 30; break;
+        default:              return -1;
+    }
+    return fim[1] == '\0' ? n : -1;
+}
+
+/* ============================ Estado do gerador ============================ */
+
+// Simbolo pendente na pilha de derivacao.
+typedef struct {
+    int simbolo;
+    int profundidade;   // Niveis de expansao acima do simbolo.
+    int itens;          // Itens ja gerados, se for a cauda de uma lista.
+    int raiz;           // 1 para a lista de comandos do main.
+    // Tipo da expressao (TIPO_INDEFINIDO = qualquer um). Com 'exato', todo
+    // operando tem esse tipo, para que uma atribuicao passe na semantica.
+    TipoDado tipo;
+    int exato;
+    int declara;        // T_ID que e o nome de uma declaracao.
+} ItemGerador;
+
+typedef struct {
+    const ConfigGerador *config;
+    unsigned long long estado_aleatorio;
+
+    // Menor altura de derivacao de cada NT e de cada producao (a cauda
+    // de uma lista recursiva nao conta: ela fica no mesmo nivel).
+    int altura_nt[NUM_NONTERMINALS];
+    int altura_producao[NUM_PRODUCTIONS];
+    int producao_recursiva[NUM_PRODUCTIONS];
+    // Producoes de cada NT, para nao varrer a gramatica a cada expansao.
+    int alternativas[NUM_NONTERMINALS][NUM_PRODUCTIONS];
+    int num_alternativas[NUM_NONTERMINALS];
+
+    ItemGerador *pilha;
+    int topo;
+    int capacidade;
+
+    FILE *destino;
+    char bloco[TAMANHO_BLOCO_SAIDA];
+    int usados;
+    long long escritos;
+    int falhou;
+
+    // Formatacao: indentacao por chaves e quebra de linha fora de parenteses.
+    int nivel_chaves;
+    int nivel_parenteses;
+    int inicio_linha;
+    int token_anterior;
+
+    unsigned declaracoes;   // Nomes novos (d0, d1...) ja declarados.
+} Gerador;
+
+// xorshift64*: rapido, e o mesmo em toda plataforma para a mesma semente.
+static unsigned long long aleatorio(Gerador *g) {
+    unsigned long long x = g->estado_aleatorio;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    g->estado_aleatorio = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static unsigned aleatorio_ate(Gerador *g, unsigned n) {
+    return (unsigned)((aleatorio(g) >> 32) % n);
+}
+
+static void calcular_alturas(Gerador *g) {
+    for (int nt = 0; nt < NUM_NONTERMINALS; nt++)
+        g->altura_nt[nt] = ALTURA_INFINITA;
+    for (int p = 0; p < NUM_PRODUCTIONS; p++) {
+        const Producao *prod = &producoes[p];
+        g->producao_recursiva[p] = prod->tam_corpo > 0 &&
+                                   prod->corpo[prod->tam_corpo - 1] == prod->cabeca &&
+                                   lista_recursiva[prod->cabeca - NUM_TOKENS];
+        g->altura_producao[p] = ALTURA_INFINITA;
+        int cabeca = prod->cabeca - NUM_TOKENS;
+        g->alternativas[cabeca][g->num_alternativas[cabeca]++] = p;
+    }
+
+    // Ponto fixo: altura(p) = 1 + maior altura entre os NTs do corpo.
+    int mudou = 1;
+    while (mudou) {
+        mudou = 0;
+        for (int p = 0; p < NUM_PRODUCTIONS; p++) {
+            const Producao *prod = &producoes[p];
+            int n = prod->tam_corpo - (g->producao_recursiva[p] ? 1 : 0);
+            int altura = 1;
+            for (int i = 0; i < n && altura < ALTURA_INFINITA; i++) {
+                int sim = prod->corpo[i];
+                if (E_NAOTERMINAL(sim)) {
+                    int h = g->altura_nt[sim - NUM_TOKENS];
+                    altura = h >= ALTURA_INFINITA ? ALTURA_INFINITA
+                                                  : (h + 1 > altura ? h + 1 : altura);
+                }
+            }
+            if (altura < g->altura_producao[p]) {
+                g->altura_producao[p] = altura;
+                mudou = 1;
+            }
+            int cabeca = prod->cabeca - NUM_TOKENS;
+            if (altura < g->altura_nt[cabeca]) {
+                g->altura_nt[cabeca] = altura;
+                mudou = 1;
+            }
+        }
+    }
+}
+
+static void empilhar(Gerador *g, ItemGerador item) {
+    if (g->topo == g->capacidade) {
+        int nova = g->capacidade ? g->capacidade * 2 : 256;
+        ItemGerador *novos = realloc(g->pilha, (size_t)nova * sizeof(ItemGerador));
+        if (!novos) {
+            fprintf(stderr, "Erro: memoria insuficiente para o gerador.\n");
+            exit(1);
+        }
+        g->pilha = novos;
+        g->capacidade = nova;
+    }
+    g->pilha[g->topo++] = item;
+}
+
+/* ============================ Saida ============================ */
+
+static void descarregar(Gerador *g) {
+    if (g->usados > 0 && fwrite(g->bloco, 1, (size_t)g->usados, g->destino) != (size_t)g->usados)
+        g->falhou = 1;
+    g->escritos += g->usados;
+    g->usados = 0;
+}
+
+static void escrever(Gerador *g, const char *texto, int tamanho) {
+    if (g->usados + tamanho > TAMANHO_BLOCO_SAIDA)
+        descarregar(g);
+    memcpy(g->bloco + g->usados, texto, (size_t)tamanho);
+    g->usados += tamanho;
+}
+
+static long long bytes_gerados(const Gerador *g) {
+    return g->escritos + g->usados;
+}
+
+// Escreve 'n' em decimal (sem '\0'); retorna o numero de digitos.
+static int escrever_natural(char *texto, unsigned n) {
+    char digitos[10];
+    int k = 0;
+    do {
+        digitos[k++] = (char)('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+    for (int i = 0; i < k; i++)
+        texto[i] = digitos[k - 1 - i];
+    return k;
+}
+
+// Sorteia o tipo de uma atribuicao, leitura ou declaracao: mais int. Char
+// fica de fora: sem literal de char, uma variavel char so valeria 0, e
+// dividir por ela encerraria a execucao.
+static TipoDado sortear_tipo(Gerador *g) {
+    return aleatorio_ate(g, 3) < 2 ? TIPO_INT : TIPO_FLOAT;
+}
+
+// Texto de um terminal. Os de varias grafias sao sorteados; nomes e numeros
+// seguem o tipo do item.
+static int lexema_terminal(Gerador *g, const ItemGerador *item, char *texto) {
+    const char *fixo = NULL;
+    TipoDado tipo = item->tipo;
+    switch (item->simbolo) {
+        case T_TIPO:
+            fixo = tipo == TIPO_INDEFINIDO ? tipos[aleatorio_ate(g, 3)] : nome_tipo(tipo);
+            break;
+        case T_OP_COM: fixo = comparacoes[aleatorio_ate(g, 6)]; break;
+        case T_OP_LOG: fixo = logicos[aleatorio_ate(g, 2)]; break;
+        case T_ID:
+            // Um nome novo a cada declaracao: nunca redeclara nem esconde
+            // as variaveis do inicio do main.
+            if (item->declara) {
+                texto[0] = 'd';
+                return 1 + escrever_natural(texto + 1, g->declaracoes++);
+            }
+            if (tipo == TIPO_INDEFINIDO)
+                tipo = sortear_tipo(g);
+            texto[0] = prefixo_variavel[tipo];
+            return 1 + escrever_natural(texto + 1, aleatorio_ate(g, VARIAVEIS_POR_TIPO));
+        case T_NUM: {
+            int n = escrever_natural(texto, aleatorio_ate(g, 1000));
+            if (tipo == TIPO_FLOAT || (tipo == TIPO_INDEFINIDO && aleatorio_ate(g, 4) == 0)) {
+                texto[n++] = '.';
+                n += escrever_natural(texto + n, aleatorio_ate(g, 100));
+            }
+            return n;
+        }
+        case T_MAIN:   fixo = "main"; break;
+        case T_IF:     fixo = "if"; break;
+        case T_ELSE:   fixo = "else"; break;
+        case T_WHILE:  fixo = "while"; break;
+        case T_DO:     fixo = "do"; break;
+        case T_FOR:    fixo = "for"; break;
+        case T_RETURN: fixo = "return"; break;
+        case T_READ:   fixo = "read"; break;
+        case T_PRINT:  fixo = "print"; break;
+        case T_PV:     fixo = ";"; break;
+        case T_VIRG:   fixo = ","; break;
+        case T_IGUAL:  fixo = "="; break;
+        case T_PA:     fixo = "("; break;
+        case T_PF:     fixo = ")"; break;
+        case T_CA:     fixo = "{"; break;
+        case T_CF:     fixo = "}"; break;
+        case T_SOMA:   fixo = "+"; break;
+        case T_SUB:    fixo = "-"; break;
+        case T_MUL:    fixo = "*"; break;
+        case T_DIV:    fixo = "/"; break;
+        case T_NOT:    fixo = "!"; break;
+        default:       fixo = ""; break;
+    }
+    int n = (int)strlen(fixo);
+    memcpy(texto, fixo, (size_t)n);
+    return n;
+}
+
+// Escreve 'texto' como o token 'token', com espacos e quebras de linha.
+static void emitir_texto(Gerador *g, int token, const char *texto, int n) {
+    static const char espacos[] = "                                ";
+
+    if (token == T_CF) {
+        g->nivel_chaves--;
+        // "for (...)" nao tem corpo: a chave seguinte vai para outra linha.
+        if (!g->inicio_linha) {
+            escrever(g, "\n", 1);
+            g->inicio_linha = 1;
+        }
+    }
+    if (g->inicio_linha) {
+        int indentacao = 4 * g->nivel_chaves;
+        while (indentacao > 0) {
+            int k = indentacao < 32 ? indentacao : 32;
+            escrever(g, espacos, k);
+            indentacao -= k;
+        }
+    } else if (token != T_PV && token != T_PF &&
+               g->token_anterior != T_PA && g->token_anterior != T_NOT &&
+               !(token == T_PA && g->token_anterior == T_MAIN)) {
+        escrever(g, " ", 1);
+    }
+    escrever(g, texto, n);
+
+    if (token == T_CA)
+        g->nivel_chaves++;
+    else if (token == T_PA)
+        g->nivel_parenteses++;
+    else if (token == T_PF)
+        g->nivel_parenteses--;
+    g->inicio_linha = token == T_CA || token == T_CF ||
+                      (token == T_PV && g->nivel_parenteses == 0);
+    if (g->inicio_linha)
+        escrever(g, "\n", 1);
+    g->token_anterior = token;
+}
+
+static void emitir_terminal(Gerador *g, const ItemGerador *item) {
+    char texto[32];
+    int n = lexema_terminal(g, item, texto);
+    emitir_texto(g, item->simbolo, texto, n);
+}
+
+// Declara as variaveis que as expressoes usam (i0.., f0..) logo depois
+// do '{' do main, com valores diferentes de zero.
+static void declarar_variaveis(Gerador *g) {
+    static const TipoDado ordem[] = { TIPO_INT, TIPO_FLOAT };
+    for (int t = 0; t < 2; t++) {
+        TipoDado tipo = ordem[t];
+        for (unsigned v = 0; v < VARIAVEIS_POR_TIPO; v++) {
+            char texto[32];
+            emitir_texto(g, T_TIPO, nome_tipo(tipo), (int)strlen(nome_tipo(tipo)));
+            texto[0] = prefixo_variavel[tipo];
+            emitir_texto(g, T_ID, texto, 1 + escrever_natural(texto + 1, v));
+            emitir_texto(g, T_IGUAL, "=", 1);
+            int n = escrever_natural(texto, v + 1);
+            if (tipo == TIPO_FLOAT) {
+                memcpy(texto + n, ".5", 2);
+                n += 2;
+            }
+            emitir_texto(g, T_NUM, texto, n);
+            emitir_texto(g, T_PV, ";", 1);
+        }
+    }
+}
+
+/* ============================ Derivacao ============================ */
+
+// Uma expressao de float exato nao pode ter comparacao, operador logico
+// ou '!' (todos dao int) fora de parenteses proprios.
+static int producao_do_tipo(const ItemGerador *item, int p) {
+    if (!item->exato || item->tipo != TIPO_FLOAT || producoes[p].tam_corpo == 0)
+        return 1;
+    int primeiro = producoes[p].corpo[0];
+    return primeiro != T_OP_COM && primeiro != T_OP_LOG && primeiro != T_NOT;
+}
+
+// Sorteia uma producao para o NT do item. Fora da lista do main, so entram
+// producoes que cabem na profundidade restante e, em listas, na largura;
+// sempre, so as que respeitam o tipo do item.
+// A lista do main continua enquanto o programa nao chega ao tamanho alvo.
+static int escolher_producao(Gerador *g, const ItemGerador *item) {
+    const ConfigGerador *c = g->config;
+    int restante = c->profundidade_maxima - item->profundidade + 1;
+    int candidatas[NUM_PRODUCTIONS];
+    int num_candidatas = 0;
+    long total = 0;
+    int menor = -1;
+
+    int nt = item->simbolo - NUM_TOKENS;
+    for (int a = 0; a < g->num_alternativas[nt]; a++) {
+        int p = g->alternativas[nt][a];
+        if (!producao_do_tipo(item, p))
+            continue;
+        if (menor < 0 || g->altura_producao[p] < g->altura_producao[menor] ||
+            (g->altura_producao[p] == g->altura_producao[menor] &&
+             g->producao_recursiva[menor] && !g->producao_recursiva[p]))
+            menor = p;
+
+        int permitida;
+        if (item->raiz)
+            permitida = g->producao_recursiva[p] == (bytes_gerados(g) < c->tamanho_alvo);
+        else
+            permitida = g->altura_producao[p] <= restante &&
+                        (!g->producao_recursiva[p] || item->itens < c->largura_maxima);
+        if (permitida && c->pesos[p] > 0) {
+            candidatas[num_candidatas++] = p;
+            total += c->pesos[p];
+        }
+    }
+
+    if (num_candidatas == 0)
+        return menor;
+    long sorteio = (long)(aleatorio(g) >> 33) % total;
+    for (int i = 0; i < num_candidatas; i++) {
+        sorteio -= c->pesos[candidatas[i]];
+        if (sorteio < 0)
+            return candidatas[i];
+    }
+    return candidatas[num_candidatas - 1];
+}
+
+// Tipo dos filhos de 'item' expandido por 'p'. Atribuicao, leitura e
+// declaracao sorteiam um tipo e o impoem a expressao inteira; o lado
+// direito de uma comparacao e os operandos de '&&', '||' e '!' dao int
+// de qualquer jeito, entao ficam livres. O resto herda do pai.
+// 'sorteado' guarda o tipo sorteado para a expansao (um so para todos os
+// filhos); comeca indefinido.
+static void tipar_filho(Gerador *g, const ItemGerador *item, int p, int i, TipoDado *sorteado,
+                        ItemGerador *filho) {
+    filho->tipo = item->tipo;
+    filho->exato = item->exato;
+    switch (producoes[p].cabeca - NUM_TOKENS) {
+        case NT_DECLARACAO_VAR:
+            filho->declara = producoes[p].corpo[i] == T_ID;
+            /* fallthrough */
+        case NT_ATRIBUICAO:
+        case NT_ATRIBUICAO_SIMPLES:
+        case NT_COMANDO_LEITURA:
+            if (*sorteado == TIPO_INDEFINIDO)
+                *sorteado = sortear_tipo(g);
+            filho->tipo = *sorteado;
+            filho->exato = 1;
+            break;
+        case NT_EXPR_BOOL_RESTO:
+        case NT_TERMO_BOOL:
+        case NT_EXPR_REL_RESTO:
+            if (i > 0) {
+                filho->tipo = TIPO_INDEFINIDO;
+                filho->exato = 0;
+            }
+            break;
+    }
+}
+
+long long gerar_programa(const ConfigGerador *c, FILE *destino) {
+    Gerador *g = calloc(1, sizeof(Gerador));
+    if (!g) {
+        fprintf(stderr, "Erro: memoria insuficiente para o gerador.\n");
+        exit(1);
+    }
+    g->config = c;
+    g->destino = destino;
+    g->inicio_linha = 1;
+    g->token_anterior = T_EOF;
+    // Espalha a semente (splitmix64) para que sementes vizinhas divirjam logo.
+    unsigned long long z = c->semente + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    g->estado_aleatorio = (z ^ (z >> 31)) | 1;
+    calcular_alturas(g);
+
+    ItemGerador inicio = { SIM_NAOTERMINAL(NT_PROGRAM), 0, 0, 0, TIPO_INDEFINIDO, 0, 0 };
+    empilhar(g, inicio);
+    while (g->topo > 0 && !g->falhou) {
+        ItemGerador item = g->pilha[--g->topo];
+        if (E_TERMINAL(item.simbolo)) {
+            emitir_terminal(g, &item);
+            if (item.simbolo == T_CA && g->nivel_chaves == 1)
+                declarar_variaveis(g);
+            continue;
+        }
+
+        int p = escolher_producao(g, &item);
+        const Producao *prod = &producoes[p];
+        TipoDado sorteado = TIPO_INDEFINIDO;
+        for (int i = prod->tam_corpo - 1; i >= 0; i--) {
+            ItemGerador filho = { prod->corpo[i], item.profundidade + 1, 0, 0,
+                                  TIPO_INDEFINIDO, 0, 0 };
+            tipar_filho(g, &item, p, i, &sorteado, &filho);
+            if (i == prod->tam_corpo - 1 && g->producao_recursiva[p]) {
+                // Cauda da lista: mesmo nivel, mais um item.
+                filho.profundidade = item.profundidade;
+                filho.itens = item.itens + 1;
+                filho.raiz = item.raiz;
+            } else if (item.simbolo == SIM_NAOTERMINAL(NT_MAIN_FUNC) &&
+                       E_NAOTERMINAL(filho.simbolo) &&
+                       lista_recursiva[filho.simbolo - NUM_TOKENS]) {
+                filho.raiz = 1;
+            }
+            empilhar(g, filho);
+        }
+    }
+    descarregar(g);
+    if (fflush(destino) != 0)
+        g->falhou = 1;
+
+    long long total = g->falhou ? -1 : g->escritos;
+    free(g->pilha);
+    free(g);
+    return total;
+}
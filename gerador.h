@@ -0,0 +1,41 @@
+#ifndef GERADOR_H
+#define GERADOR_H
+
+#include <stdio.h>
+#include "parser.h"
+
+/* Gerador de programas aleatorios dirigido pela gramatica.
+   Percorre as producoes de inicializar_producoes() a partir de PROGRAMA,
+   com uma pilha explicita, e escolhe entre as alternativas de cada NT por
+   peso. Como so aplica producoes da gramatica, todo programa gerado e
+   sintaticamente correto. Tambem passa na analise semantica: o main
+   comeca declarando as variaveis int e float que as expressoes usam, cada
+   declaracao gerada usa um nome novo, e cada atribuicao, leitura ou
+   declaracao sorteia um tipo e o impoe aos operandos do lado direito
+   (assim os backends podem executar o programa). A profundidade limita o aninhamento: perto do
+   limite so entram producoes cuja menor derivacao ainda cabe. A largura
+   limita os itens de cada lista recursiva (comandos de um bloco, termos de
+   uma soma...). So a lista de comandos do main cresce ate o tamanho alvo,
+   entao o mesmo gerador serve para 1 KB, 1 MB ou 1 GB. A saida e escrita
+   em blocos, sem guardar o programa na memoria. Com a mesma semente e as
+   mesmas opcoes, o programa e sempre o mesmo. */
+
+typedef struct {
+    unsigned long long semente;
+    long long tamanho_alvo;     // Bytes aproximados do programa.
+    int profundidade_maxima;    // Expansoes de NT aninhadas, a partir de PROGRAMA.
+    int largura_maxima;         // Itens por lista recursiva (exceto a do main).
+    int pesos[NUM_PRODUCTIONS]; // Peso de cada producao (0 = so como ultimo recurso).
+} ConfigGerador;
+
+void gerador_config_padrao(ConfigGerador *c);
+// Le "P=W" e troca o peso da producao P por W. Retorna 0 se o texto for invalido.
+int gerador_ajustar_peso(ConfigGerador *c, const char *texto);
+// Le um tamanho com sufixo opcional K, M ou G (potencias de 1024).
+// Retorna -1 se o texto for invalido.
+long long gerador_ler_tamanho(const char *texto);
+// Escreve um programa em 'destino'. Exige preparar_gramatica().
+// Retorna o numero de bytes escritos, ou -1 se a escrita falhar.
+long long gerar_programa(const ConfigGerador *c, FILE *destino);
+
+#endif
@@ -0,0 +1,467 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "incremental.h"
+#include "estatisticas.h"
+#include "memoria.h"
+
+void documento_iniciar(Documento *d) {
+    memset(d, 0, sizeof(*d));
+    arvore_iniciar(&d->arvore);
+    arvore_iniciar(&d->trecho);
+    pilha_init(&d->pilha);
+}
+
+void documento_liberar(Documento *d) {
+    free(d->texto);
+    free(d->tokens);
+    free(d->novos);
+    arvore_liberar(&d->arvore);
+    arvore_liberar(&d->trecho);
+    pilha_liberar(&d->pilha);
+    documento_iniciar(d);
+}
+
+/* ============================
+   Fonte de tokens do documento
+   ============================ */
+
+typedef struct {
+    const Documento *d;
+    int pos;
+} FonteDocumento;
+
+static int fonte_documento_proximo(void *dados, const char **lexema, int *tamanho) {
+    FonteDocumento *f = dados;
+    const Documento *d = f->d;
+    if (f->pos >= d->num_tokens) {
+        *lexema = "";
+        *tamanho = 0;
+        return T_EOF;
+    }
+    const TokenDoc *t = &d->tokens[f->pos++];
+    *lexema = d->texto + t->inicio;
+    *tamanho = t->tamanho;
+    return t->tipo;
+}
+
+/* ============================
+   Analise completa
+   ============================ */
+
+static int reanalisar_tudo(Documento *d) {
+    FonteDocumento dados = { d, 0 };
+    FonteTokens fonte = { fonte_documento_proximo, &dados };
+    arvore_limpar(&d->arvore);
+    ReceptorEventos receptor = arvore_receptor(&d->arvore);
+    d->erros = analisar_entrada(&d->pilha, &fonte, &receptor, 0);
+    d->tokens_reanalisados = d->num_tokens;
+    d->reanalise_completa = 1;
+    return d->erros;
+}
+
+int documento_carregar(Documento *d, const char *texto, size_t tamanho) {
+    int capacidade = (int)d->capacidade;
+    d->texto = crescer(d->texto, &capacidade, (int)tamanho + 1, 1);
+    d->capacidade = (size_t)capacidade;
+    memcpy(d->texto, texto, tamanho);
+    d->texto[tamanho] = '\0';
+    d->tamanho = tamanho;
+
+    // Como os erros sintaticos, os lexicos so aparecem na contagem: o mesmo
+    // texto e relexado a cada edicao.
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, d->texto, d->tamanho);
+    lx.relatar_erros = 0;
+    d->num_tokens = 0;
+    int tk;
+    while ((tk = lexer_r_proximo(&lx)) != T_EOF) {
+        d->tokens = crescer(d->tokens, &d->capacidade_tokens, d->num_tokens + 1, sizeof(TokenDoc));
+        TokenDoc *t = &d->tokens[d->num_tokens++];
+        t->tipo = tk;
+        t->inicio = (int)(lx.lexema - d->texto);
+        t->tamanho = lx.tamanho;
+    }
+    d->tokens_relexados = d->num_tokens;
+    return reanalisar_tudo(d);
+}
+
+/* ============================
+   Relexico da janela danificada
+   ============================ */
+
+// Primeiro token cujo fim alcanca 'pos' (pode ser estendido por uma edicao
+// em 'pos'). Busca binaria: os fins sao crescentes.
+static int primeiro_token_ate(const Documento *d, int pos) {
+    int lo = 0, hi = d->num_tokens;
+    while (lo < hi) {
+        int meio = (lo + hi) / 2;
+        if (d->tokens[meio].inicio + d->tokens[meio].tamanho >= pos)
+            hi = meio;
+        else
+            lo = meio + 1;
+    }
+    return lo;
+}
+
+// Relexa a partir do token 'a' ate reencontrar um token antigo intacto.
+// Os tokens antigos [a, *j) sao trocados pelos 'd->novos' (*k tokens).
+// 'fim_edicao' e o fim do texto novo; 'delta' e a variacao de tamanho.
+static void relexar(Documento *d, int a, int fim_edicao_antigo, int fim_edicao, int delta,
+                    int *j, int *k) {
+    int inicio = a > 0 ? d->tokens[a - 1].inicio + d->tokens[a - 1].tamanho : 0;
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, d->texto, d->tamanho);
+    lx.relatar_erros = 0;
+    lx.pos = d->texto + inicio; // O lexer so tem estado entre tokens.
+
+    int antigo = a;
+    *k = 0;
+    int tk;
+    while ((tk = lexer_r_proximo(&lx)) != T_EOF) {
+        int pos = (int)(lx.lexema - d->texto);
+        if (pos >= fim_edicao) {
+            // Texto igual ao antigo daqui em diante: se um token antigo
+            // comecava no mesmo lugar, o resto da sequencia e a mesma.
+            while (antigo < d->num_tokens &&
+                   (d->tokens[antigo].inicio < fim_edicao_antigo ||
+                    d->tokens[antigo].inicio + delta < pos))
+                antigo++;
+            if (antigo < d->num_tokens && d->tokens[antigo].inicio + delta == pos)
+                break;
+        }
+        d->novos = crescer(d->novos, &d->capacidade_novos, *k + 1, sizeof(TokenDoc));
+        d->novos[*k].tipo = tk;
+        d->novos[*k].inicio = pos;
+        d->novos[*k].tamanho = lx.tamanho;
+        (*k)++;
+    }
+    *j = tk == T_EOF ? d->num_tokens : antigo;
+}
+
+/* ============================
+   Reanalise de uma LISTA_COMANDOS
+   ============================ */
+
+// Ultimo no (em pre-ordem) com token_ini <= pos; token_ini nao decresce.
+static int ultimo_no_ate(const Arvore *a, int pos) {
+    int lo = 0, hi = a->quantidade - 1, achado = 0;
+    while (lo <= hi) {
+        int meio = (lo + hi) / 2;
+        if (a->nos[meio].token_ini <= pos) {
+            achado = meio;
+            lo = meio + 1;
+        } else {
+            hi = meio - 1;
+        }
+    }
+    return achado;
+}
+
+static int e_lista_que_contem(const NoArvore *no, int a, int j) {
+    return no->simbolo == SIM_NAOTERMINAL(NT_LISTA_COMANDOS) &&
+           no->token_ini <= a && j <= no->token_fim;
+}
+
+// Com erros, a emenda so vale se os passos de recuperacao da analise
+// antiga se separam em tres grupos: antes do trecho 'r0' (mesmo lookahead,
+// entao se repetem), dentro do trecho [insercao, velho) da arvore (somem
+// com ele) e depois da sincronia (se repetem se o contador de silencio da
+// nova analise tambem estiver saturado quando eles chegam). 'sincronia' e
+// o indice antigo do token da sincronia e 'p' o novo. Retorna 0 se nao da
+// para garantir; senao guarda em 'contados' os erros que somem.
+static int separar_recuperacoes(const Documento *d, int L, int insercao, int velho,
+                                int r0, int a, int sincronia, int p, int *contados) {
+    const Arvore *arv = &d->arvore;
+    int ultima_antes = -1, ultima_trecho = -1, primeira_depois = -1;
+    *contados = 0;
+    for (int i = 0; i < arv->num_recuperacoes; i++) {
+        const Recuperacao *r = &arv->recuperacoes[i];
+        if ((r->no >= insercao && r->no < velho) ||
+            (r->no == L && r->token >= r0 && r->token < sincronia)) {
+            ultima_trecho = i;
+            *contados += r->contado;
+        } else if (r->token >= sincronia && r->token > r0) {
+            if (primeira_depois < 0)
+                primeira_depois = i;
+        } else if (r->token <= r0 && r->token < a && r->token < sincronia) {
+            ultima_antes = i;
+        } else {
+            return 0;
+        }
+    }
+    if (primeira_depois < 0)
+        return 1;
+
+    // Casamentos desde a ultima recuperacao (cota inferior) na sincronia,
+    // na analise nova (o trecho novo nao tem erro) e na antiga.
+    const Recuperacao *rec = arv->recuperacoes;
+    int antes = ultima_antes < 0 ? ERROS_TOKENS_SILENCIO : r0 - 1 - rec[ultima_antes].token;
+    int novo = antes + (p - r0);
+    int ultima = ultima_trecho > ultima_antes ? ultima_trecho : ultima_antes;
+    int antigo = ultima < 0 ? ERROS_TOKENS_SILENCIO : sincronia - 1 - rec[ultima].token;
+    int menor = novo < antigo ? novo : antigo;
+    return menor + (rec[primeira_depois].token - sincronia) >= ERROS_TOKENS_SILENCIO;
+}
+
+// Tira da lista de recuperacoes as do trecho emendado e desloca as de depois.
+static void emendar_recuperacoes(Arvore *arv, int L, int insercao, int velho,
+                                 int r0, int sincronia, int dt, int dn) {
+    int n = 0;
+    for (int i = 0; i < arv->num_recuperacoes; i++) {
+        Recuperacao r = arv->recuperacoes[i];
+        if ((r.no >= insercao && r.no < velho) ||
+            (r.no == L && r.token >= r0 && r.token < sincronia))
+            continue;
+        if (r.token >= sincronia && r.token > r0) {
+            r.token += dt;
+            if (r.no >= velho)
+                r.no += dn;
+        }
+        arv->recuperacoes[n++] = r;
+    }
+    arv->num_recuperacoes = n;
+}
+
+// Tenta reanalisar os comandos da lista 'L' (indice na arvore antiga) que
+// cobrem o dano [a, j) (indices antigos). Os tokens ja foram trocados e
+// 'dt' e a variacao no numero de tokens. Retorna 1 se a arvore foi emendada.
+static int reanalisar_lista(Documento *d, int L, int a, int j, int dt) {
+    NoArvore *nos = d->arvore.nos;
+    int fim_L = L + nos[L].tamanho;
+
+    // Primeiro filho afetado: o que contem o token a-1, porque ele decidiu
+    // a sua ultima producao olhando o token 'a' (p. ex. um if sem else).
+    int f = -1;
+    if (a > nos[L].token_ini) {
+        f = ultimo_no_ate(&d->arvore, a - 1);
+        while (f > L && nos[f].pai != L)
+            f = nos[f].pai;
+        if (f <= L)
+            return 0; // So tokens descartados por erro antes de 'a'.
+    } else if (nos[L].tamanho > 1) {
+        f = L + 1;
+    }
+    int r0 = f >= 0 ? nos[f].token_ini : a;
+    int insercao = f >= 0 ? f : fim_L;
+    int fim_lista_novo = nos[L].token_fim + dt;
+
+    FonteDocumento dados = { d, r0 };
+    FonteTokens fonte = { fonte_documento_proximo, &dados };
+    arvore_limpar(&d->trecho);
+    d->trecho.base_token = r0;
+    ReceptorEventos receptor = arvore_receptor(&d->trecho);
+
+    int p = r0;
+    int velho = insercao; // Proximo filho antigo candidato a sincronia.
+    for (;;) {
+        // Filhos antigos que comecam antes de 'p' (ou dentro do dano) somem.
+        while (velho < fim_L &&
+               (nos[velho].token_ini < j || nos[velho].token_ini + dt < p))
+            velho += nos[velho].tamanho;
+
+        // Sincronia: 'p' caiu no inicio de um filho antigo intacto, ou no
+        // fim intacto da lista. Daqui em diante a derivacao e a mesma.
+        if (velho < fim_L && nos[velho].token_ini + dt == p)
+            break;
+        if (velho >= fim_L && nos[L].token_fim >= j && p == fim_lista_novo)
+            break;
+        if (p >= fim_lista_novo)
+            return 0;
+
+        int consumidos;
+        dados.pos = p;
+        d->trecho.base_token = p;
+        if (analisar_prefixo(&d->pilha, SIM_NAOTERMINAL(NT_COMANDO), &fonte, &receptor, &consumidos) ||
+            consumidos == 0)
+            return 0;
+        p += consumidos;
+    }
+    int sincronia = velho < fim_L ? nos[velho].token_ini : nos[L].token_fim;
+    int erros_trecho = 0;
+    if (d->erros && !separar_recuperacoes(d, L, insercao, velho, r0, a, sincronia, p, &erros_trecho))
+        return 0;
+    d->tokens_reanalisados = p - r0;
+
+    // Emenda: troca os nos [insercao, velho) pelos do trecho.
+    int removidos = velho - insercao;
+    int inseridos = d->trecho.quantidade;
+    int dn = inseridos - removidos;
+    if (d->erros) {
+        emendar_recuperacoes(&d->arvore, L, insercao, velho, r0, sincronia, dt, dn);
+        d->erros -= erros_trecho;
+    }
+    int total = d->arvore.quantidade;
+    arvore_reservar(&d->arvore, total + dn);
+    nos = d->arvore.nos;
+    memmove(&nos[insercao + inseridos], &nos[velho], (size_t)(total - velho) * sizeof(NoArvore));
+    for (int i = 0; i < inseridos; i++) {
+        NoArvore no = d->trecho.nos[i];
+        no.pai = no.pai < 0 ? L : no.pai + insercao;
+        nos[insercao + i] = no;
+    }
+    d->arvore.quantidade = total + dn;
+
+    // Nos depois da emenda: tokens deslocados; pais depois da emenda tambem.
+    for (int i = insercao + inseridos; i < d->arvore.quantidade; i++) {
+        nos[i].token_ini += dt;
+        nos[i].token_fim += dt;
+        if (nos[i].pai >= velho)
+            nos[i].pai += dn;
+    }
+    // A lista e os seus ancestrais crescem junto.
+    for (int anc = L; anc >= 0; anc = nos[anc].pai) {
+        nos[anc].tamanho += dn;
+        nos[anc].token_fim += dt;
+    }
+    // A lista pode ter passado de vazia para nao vazia (ou o contrario).
+    int lookahead = nos[L].token_ini < d->num_tokens ? d->tokens[nos[L].token_ini].tipo : T_EOF;
+    nos[L].producao = tabela_analise[NT_LISTA_COMANDOS][lookahead];
+    return 1;
+}
+
+/* ============================
+   Edicao
+   ============================ */
+
+int documento_editar(Documento *d, size_t ini, size_t fim, const char *novo, size_t tamanho_novo) {
+    if (ini > fim || fim > d->tamanho)
+        return -1;
+
+    // Texto.
+    int delta = (int)tamanho_novo - (int)(fim - ini);
+    int capacidade = (int)d->capacidade;
+    d->texto = crescer(d->texto, &capacidade, (int)(d->tamanho + (size_t)delta) + 1, 1);
+    d->capacidade = (size_t)capacidade;
+    memmove(d->texto + ini + tamanho_novo, d->texto + fim, d->tamanho - fim + 1);
+    memcpy(d->texto + ini, novo, tamanho_novo);
+    d->tamanho += (size_t)delta;
+
+    // Tokens: relexa a janela e emenda. Recua um token porque o lexer
+    // espia um caractere alem do lexema (o '.' de um numero).
+    int a = primeiro_token_ate(d, (int)ini);
+    if (a > 0)
+        a--;
+    int j, k;
+    relexar(d, a, (int)fim, (int)(ini + tamanho_novo), delta, &j, &k);
+
+    // Tokens relexados iguais aos antigos, antes da edicao, nao sao dano.
+    int iguais = 0;
+    while (iguais < k && a + iguais < j &&
+           d->novos[iguais].inicio + d->novos[iguais].tamanho <= (int)ini &&
+           d->novos[iguais].tipo == d->tokens[a + iguais].tipo &&
+           d->novos[iguais].inicio == d->tokens[a + iguais].inicio &&
+           d->novos[iguais].tamanho == d->tokens[a + iguais].tamanho)
+        iguais++;
+    memmove(d->novos, d->novos + iguais, (size_t)(k - iguais) * sizeof(TokenDoc));
+    a += iguais;
+    k -= iguais;
+    int dt = k - (j - a);
+    d->tokens = crescer(d->tokens, &d->capacidade_tokens, d->num_tokens + dt, sizeof(TokenDoc));
+    memmove(&d->tokens[a + k], &d->tokens[j], (size_t)(d->num_tokens - j) * sizeof(TokenDoc));
+    memcpy(&d->tokens[a], d->novos, (size_t)k * sizeof(TokenDoc));
+    d->num_tokens += dt;
+    for (int i = a + k; i < d->num_tokens; i++)
+        d->tokens[i].inicio += delta;
+    d->tokens_relexados = k;
+    d->tokens_reanalisados = 0;
+    d->reanalise_completa = 0;
+
+    // So espaco ou comentario mudou: a derivacao e a mesma.
+    if (k == 0 && j == a)
+        return d->erros;
+    // No limite de erros a analise antiga parou no meio.
+    if (d->erros >= MAX_ERROS_SINTATICOS)
+        return reanalisar_tudo(d);
+
+    // Sobe pelas listas que contem o dano ate uma se recompor.
+    int L = ultimo_no_ate(&d->arvore, a);
+    for (;;) {
+        while (L >= 0 && !e_lista_que_contem(&d->arvore.nos[L], a, j))
+            L = d->arvore.nos[L].pai;
+        if (L < 0)
+            return reanalisar_tudo(d);
+        if (reanalisar_lista(d, L, a, j, dt))
+            return d->erros;
+        L = d->arvore.nos[L].pai;
+    }
+}
+
+/* ============================
+   Roteiro de edicoes (--incremental)
+   ============================ */
+
+// Compara o documento editado com uma analise do zero do mesmo texto.
+static int mesmo_resultado(const Documento *d, Documento *zero) {
+    documento_carregar(zero, d->texto, d->tamanho);
+    if (zero->erros != d->erros || zero->num_tokens != d->num_tokens ||
+        memcmp(zero->tokens, d->tokens, (size_t)d->num_tokens * sizeof(TokenDoc)) != 0)
+        return 0;
+    return zero->arvore.quantidade == d->arvore.quantidade &&
+           memcmp(zero->arvore.nos, d->arvore.nos,
+                  (size_t)d->arvore.quantidade * sizeof(NoArvore)) == 0 &&
+           zero->arvore.num_recuperacoes == d->arvore.num_recuperacoes &&
+           memcmp(zero->arvore.recuperacoes, d->arvore.recuperacoes,
+                  (size_t)d->arvore.num_recuperacoes * sizeof(Recuperacao)) == 0;
+}
+
+int executar_edicoes(const char *caminho, int conferir) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo) {
+        fprintf(stderr, "Erro: nao foi possivel abrir '%s'.\n", caminho);
+        return 2;
+    }
+    size_t tamanho;
+    char *texto = ler_fluxo_inteiro(arquivo, &tamanho);
+    fclose(arquivo);
+
+    Documento doc, zero;
+    documento_iniciar(&doc);
+    documento_iniciar(&zero);
+    double inicio = relogio_monotonico();
+    int erros = documento_carregar(&doc, texto, tamanho);
+    printf("carga: %s, %d tokens, %d nos [%.1f us]\n", erros ? "ERRO" : "OK",
+           doc.num_tokens, doc.arvore.quantidade, (relogio_monotonico() - inicio) * 1e6);
+    free(texto);
+
+    long ini, fim, n;
+    int numero = 0, divergencias = 0;
+    char *novo = NULL;
+    while (scanf("%ld %ld %ld", &ini, &fim, &n) == 3) {
+        getchar(); // Fim da linha do cabecalho.
+        char *maior = n > 0 ? realloc(novo, (size_t)n) : novo;
+        if (n < 0 || (n > 0 && !maior) || fread(maior, 1, (size_t)n, stdin) != (size_t)n) {
+            fprintf(stderr, "Erro: edicao %d incompleta.\n", numero + 1);
+            free(n > 0 && maior ? maior : novo);
+            documento_liberar(&doc);
+            documento_liberar(&zero);
+            return 2;
+        }
+        novo = maior;
+        numero++;
+
+        inicio = relogio_monotonico();
+        erros = ini < 0 || fim < 0 ? -1
+              : documento_editar(&doc, (size_t)ini, (size_t)fim, novo, (size_t)n);
+        double micros = (relogio_monotonico() - inicio) * 1e6;
+        if (erros < 0) {
+            printf("edicao %d: faixa invalida\n", numero);
+            continue;
+        }
+        printf("edicao %d: %s, %d token(s) relexado(s), %d de %d reanalisado(s)%s [%.1f us]",
+               numero, erros ? "ERRO" : "OK", doc.tokens_relexados,
+               doc.tokens_reanalisados, doc.num_tokens,
+               doc.reanalise_completa ? " (completa)" : "", micros);
+        if (conferir && !mesmo_resultado(&doc, &zero)) {
+            printf(" DIVERGENCIA");
+            divergencias++;
+        }
+        printf("\n");
+    }
+
+    free(novo);
+    documento_liberar(&doc);
+    documento_liberar(&zero);
+    return divergencias ? 1 : 0;
+}
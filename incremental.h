@@ -0,0 +1,69 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <stddef.h>
+#include "arvore.h"
+
+/* Documento com reanalise incremental.
+   Guarda o texto, os tokens e a arvore sintatica. Uma edicao (faixa de
+   bytes + texto novo) relexa so a janela de tokens danificada, ate os
+   tokens voltarem a coincidir com os antigos, e reanalisa so os comandos
+   da LISTA_COMANDOS mais interna que contem o dano. Ali o estado do parser
+   LL(1) e sempre o mesmo: [contexto..., LISTA_COMANDOS]. Os comandos de
+   fora do dano mantem as suas subarvores. Se a lista nao se recompoe, sobe
+   para a lista de fora, e em ultimo caso reanalisa o documento inteiro.
+   Com erros, a arvore guarda tambem os passos de recuperacao do parser; a
+   emenda vale enquanto o trecho novo nao tem erro e os passos de fora dele
+   se repetem iguais (ver separar_recuperacoes). Uma edicao que cria um
+   erro sempre leva a analise completa; a que o conserta, ou que mexe em
+   outro ponto do documento, costuma ser incremental.
+   O trabalho de lexico e de analise e proporcional ao trecho reanalisado.
+   Os vetores so sao deslocados com memmove e com um laco de ajuste de
+   indices. */
+
+typedef struct {
+    int tipo;
+    int inicio;   // Deslocamento em bytes no texto.
+    int tamanho;
+} TokenDoc;
+
+typedef struct {
+    char *texto;
+    size_t tamanho;
+    size_t capacidade;
+
+    TokenDoc *tokens;
+    int num_tokens;
+    int capacidade_tokens;
+
+    Arvore arvore;      // Com as recuperacoes de erro, se houve.
+    int erros;          // Erros sintaticos da analise atual.
+
+    // Estatisticas da ultima operacao.
+    int tokens_relexados;
+    int tokens_reanalisados;
+    int reanalise_completa;
+
+    // Memoria reaproveitada entre edicoes.
+    Pilha pilha;
+    Arvore trecho;
+    TokenDoc *novos;
+    int capacidade_novos;
+} Documento;
+
+void documento_iniciar(Documento *d);
+void documento_liberar(Documento *d);
+
+// Substitui o conteudo e faz a analise completa. Retorna o numero de erros.
+int documento_carregar(Documento *d, const char *texto, size_t tamanho);
+
+// Troca os bytes [ini, fim) por 'novo' e reanalisa de forma incremental.
+// Retorna o numero de erros, ou -1 se a faixa for invalida.
+int documento_editar(Documento *d, size_t ini, size_t fim, const char *novo, size_t tamanho_novo);
+
+// Modo --incremental: carrega 'caminho' e aplica as edicoes lidas da entrada
+// padrao ("ini fim n", quebra de linha e n bytes). Com 'conferir', compara
+// cada resultado com uma analise do zero. Retorna 1 se houve divergencia.
+int executar_edicoes(const char *caminho, int conferir);
+
+#endif
@@ -0,0 +1,721 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "jit.h"
+#include "memoria.h"
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__FreeBSD__) || defined(__APPLE__))
+#define JIT_X86_64
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static void *alocar(size_t quantidade, size_t tamanho_item) {
+    void *dados = calloc(quantidade, tamanho_item);
+    if (!dados) {
+        fprintf(stderr, "Erro: memoria insuficiente para o JIT.\n");
+        exit(1);
+    }
+    return dados;
+}
+
+#ifdef JIT_X86_64
+
+/* ============================ Codificacao x86-64 ============================ */
+
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+// Codigos de condicao (jcc/setcc).
+enum { CC_B = 0x2, CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_A = 0x7,
+       CC_P = 0xA, CC_NP = 0xB, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+// O vetor de registradores da VM chega em rdi e fica nele.
+#define BASE RDI
+
+typedef struct {
+    unsigned char *bytes;
+    int tamanho;
+    int capacidade;
+} Codigo;
+
+static void byte(Codigo *c, int b) {
+    c->bytes = crescer(c->bytes, &c->capacidade, c->tamanho + 1, 1);
+    c->bytes[c->tamanho++] = (unsigned char)b;
+}
+
+static void u32(Codigo *c, uint32_t v) {
+    for (int k = 0; k < 4; k++)
+        byte(c, (int)(v >> (8 * k)) & 0xFF);
+}
+
+static void u64(Codigo *c, uint64_t v) {
+    u32(c, (uint32_t)v);
+    u32(c, (uint32_t)(v >> 32));
+}
+
+static void rex(Codigo *c, int w, int reg, int rm) {
+    int b = 0x40 | (w << 3) | ((reg >> 3) & 1) << 2 | ((rm >> 3) & 1);
+    if (b != 0x40)
+        byte(c, b);
+}
+
+// Opcode de um ou dois bytes (0x0FAF = imul).
+static void opcode(Codigo *c, int op) {
+    if (op > 0xFF)
+        byte(c, op >> 8);
+    byte(c, op & 0xFF);
+}
+
+static void modrm_reg(Codigo *c, int reg, int rm) {
+    byte(c, 0xC0 | (reg & 7) << 3 | (rm & 7));
+}
+
+// [rdi + disp32]
+static void modrm_mem(Codigo *c, int reg, int32_t disp) {
+    byte(c, 0x80 | (reg & 7) << 3 | (BASE & 7));
+    u32(c, (uint32_t)disp);
+}
+
+// op reg, rm (forma "reg <- reg op r/m" de 64 bits).
+static void op_rr(Codigo *c, int op, int reg, int rm) {
+    rex(c, 1, reg, rm);
+    opcode(c, op);
+    modrm_reg(c, reg, rm);
+}
+
+static void op_rm(Codigo *c, int op, int reg, int32_t disp) {
+    rex(c, 1, reg, BASE);
+    opcode(c, op);
+    modrm_mem(c, reg, disp);
+}
+
+// Grupo 0x81: add/or/and/sub/xor/cmp r, imm32 ('ext' no campo reg).
+static void op_imm(Codigo *c, int ext, int rm, int32_t imm) {
+    rex(c, 1, 0, rm);
+    byte(c, 0x81);
+    modrm_reg(c, ext, rm);
+    u32(c, (uint32_t)imm);
+}
+
+static void mover_imm(Codigo *c, int r, int64_t v) {
+    if (v >= INT32_MIN && v <= INT32_MAX) {
+        rex(c, 1, 0, r);
+        byte(c, 0xC7);
+        modrm_reg(c, 0, r);
+        u32(c, (uint32_t)v);
+    } else {
+        rex(c, 1, 0, r);
+        byte(c, 0xB8 + (r & 7));
+        u64(c, (uint64_t)v);
+    }
+}
+
+static void guardar_mem(Codigo *c, int32_t disp, int r) {
+    rex(c, 1, r, BASE);
+    byte(c, 0x89);
+    modrm_mem(c, r, disp);
+}
+
+static void testar(Codigo *c, int r) {
+    op_rr(c, 0x85, r, r);
+}
+
+// setcc al; movzx eax, al
+static void setcc_al(Codigo *c, int cc) {
+    byte(c, 0x0F);
+    byte(c, 0x90 + cc);
+    byte(c, 0xC0);
+}
+
+static void setcc_cl(Codigo *c, int cc) {
+    byte(c, 0x0F);
+    byte(c, 0x90 + cc);
+    byte(c, 0xC1);
+}
+
+static void estender_al(Codigo *c) {
+    byte(c, 0x0F);
+    byte(c, 0xB6);
+    byte(c, 0xC0);
+}
+
+// movq xmm, r64 e movq r64, xmm
+static void para_xmm(Codigo *c, int x, int r) {
+    byte(c, 0x66);
+    rex(c, 1, x, r);
+    byte(c, 0x0F);
+    byte(c, 0x6E);
+    modrm_reg(c, x, r);
+}
+
+static void de_xmm(Codigo *c, int r, int x) {
+    byte(c, 0x66);
+    rex(c, 1, x, r);
+    byte(c, 0x0F);
+    byte(c, 0x7E);
+    modrm_reg(c, x, r);
+}
+
+// Operacao escalar de double (0x58 add, 0x5C sub, 0x59 mul, 0x5E div) em xmm0/xmm1.
+static void op_sd(Codigo *c, int op, int x, int y) {
+    byte(c, 0xF2);
+    byte(c, 0x0F);
+    byte(c, op);
+    modrm_reg(c, x, y);
+}
+
+static void ucomisd(Codigo *c, int x, int y) {
+    byte(c, 0x66);
+    byte(c, 0x0F);
+    byte(c, 0x2E);
+    modrm_reg(c, x, y);
+}
+
+// Salto relativo de 32 bits (cc < 0 = incondicional); retorna a posicao do
+// deslocamento, a ser ligado depois.
+static int saltar_rel(Codigo *c, int cc) {
+    if (cc < 0) {
+        byte(c, 0xE9);
+    } else {
+        byte(c, 0x0F);
+        byte(c, 0x80 + cc);
+    }
+    u32(c, 0);
+    return c->tamanho - 4;
+}
+
+static void ligar(Codigo *c, int posicao, int destino) {
+    uint32_t rel = (uint32_t)(destino - (posicao + 4));
+    memcpy(c->bytes + posicao, &rel, 4);
+}
+
+static void empilhar(Codigo *c, int r) {
+    rex(c, 0, 0, r);
+    byte(c, 0x50 + (r & 7));
+}
+
+static void desempilhar(Codigo *c, int r) {
+    rex(c, 0, 0, r);
+    byte(c, 0x58 + (r & 7));
+}
+
+/* ============================ Operandos ============================ */
+
+// Onde um registrador da VM vive dentro do laco nativo.
+typedef enum { LOCAL_REG, LOCAL_MEM, LOCAL_IMM } TipoLocal;
+
+typedef struct {
+    TipoLocal tipo;
+    int reg;
+    int32_t disp;
+    int64_t imm;
+} Local;
+
+// Registradores da maquina que guardam variaveis: primeiro os que a funcao
+// pode sujar, depois os que precisam ser salvos na pilha. rax, rcx e rdx sao
+// de rascunho (idiv usa rdx:rax) e rdi aponta para os registradores da VM.
+static const int alocaveis[] = { RSI, R8, R9, R10, R11, RBX, RBP, R12, R13, R14, R15 };
+#define NUM_ALOCAVEIS ((int)(sizeof(alocaveis) / sizeof(alocaveis[0])))
+
+static int preservado(int r) {
+    return r == RBX || r == RBP || r >= R12;
+}
+
+typedef struct {
+    const Programa *prog;
+    Codigo codigo;
+    int cabeca;
+    int fim;
+    int *rotulos;           // Por instrucao do trecho: posicao no codigo.
+
+    int reg_vm[NUM_ALOCAVEIS];      // Registrador da VM em cada alocavel (-1 = livre).
+    int escrito[NUM_ALOCAVEIS];
+    int num_alocados;
+
+    // Saltos a ligar: para uma instrucao do trecho ou para uma saida.
+    int *pendentes;
+    int *destinos;
+    int num_pendentes;
+    int capacidade_pendentes;
+} Gerador;
+
+static int e_constante(const Programa *p, int reg, int64_t *valor) {
+    int k = reg - (p->num_variaveis + p->num_temporarios);
+    if (k < 0 || k >= p->num_constantes || p->registradores_constantes[k] != reg)
+        return 0;
+    *valor = p->valores_constantes[k].i;
+    return 1;
+}
+
+static Local local_de(const Gerador *g, int reg) {
+    Local l = { LOCAL_MEM, 0, (int32_t)(reg * (int)sizeof(Valor)), 0 };
+    if (e_constante(g->prog, reg, &l.imm)) {
+        l.tipo = LOCAL_IMM;
+        return l;
+    }
+    for (int k = 0; k < g->num_alocados; k++)
+        if (g->reg_vm[k] == reg) {
+            l.tipo = LOCAL_REG;
+            l.reg = alocaveis[k];
+        }
+    return l;
+}
+
+static void carregar(Codigo *c, int r, Local l) {
+    if (l.tipo == LOCAL_REG) {
+        if (l.reg != r)
+            op_rr(c, 0x8B, r, l.reg);
+    } else if (l.tipo == LOCAL_MEM) {
+        op_rm(c, 0x8B, r, l.disp);
+    } else {
+        mover_imm(c, r, l.imm);
+    }
+}
+
+static void guardar(Codigo *c, Local l, int r) {
+    if (l.tipo == LOCAL_REG) {
+        if (l.reg != r)
+            op_rr(c, 0x8B, l.reg, r);
+    } else {
+        guardar_mem(c, l.disp, r);
+    }
+}
+
+// r <- r op l, com 'op' na forma reg, r/m e 'ext' no grupo 0x81 (-1 = imul).
+static void operar(Codigo *c, int op, int ext, int r, Local l) {
+    if (l.tipo == LOCAL_REG) {
+        op_rr(c, op, r, l.reg);
+    } else if (l.tipo == LOCAL_MEM) {
+        op_rm(c, op, r, l.disp);
+    } else if (l.imm >= INT32_MIN && l.imm <= INT32_MAX) {
+        if (ext < 0) {
+            rex(c, 1, r, r);
+            byte(c, 0x69);
+            modrm_reg(c, r, r);
+            u32(c, (uint32_t)l.imm);
+        } else {
+            op_imm(c, ext, r, (int32_t)l.imm);
+        }
+    } else {
+        mover_imm(c, RCX, l.imm);
+        op_rr(c, op, r, RCX);
+    }
+}
+
+/* ============================ Modelos ============================ */
+
+static void pendente(Gerador *g, int posicao, int destino) {
+    int capacidade = g->capacidade_pendentes;
+    g->pendentes = crescer(g->pendentes, &capacidade, g->num_pendentes + 1, sizeof(int));
+    g->destinos = crescer(g->destinos, &g->capacidade_pendentes, g->num_pendentes + 1, sizeof(int));
+    g->pendentes[g->num_pendentes] = posicao;
+    g->destinos[g->num_pendentes] = destino;
+    g->num_pendentes++;
+}
+
+// Salto para a instrucao 'destino': dentro do trecho vai para o seu rotulo;
+// fora dele, para uma saida que devolve 'destino' ao interpretador.
+static void saltar(Gerador *g, int cc, int destino) {
+    pendente(g, saltar_rel(&g->codigo, cc), destino);
+}
+
+// Saida incondicional ao interpretador em 'destino', mesmo dentro do trecho.
+static void sair(Gerador *g, int cc, int destino) {
+    pendente(g, saltar_rel(&g->codigo, cc), -1 - destino);
+}
+
+static void binaria_i(Gerador *g, const Instrucao *ins, int op, int ext) {
+    Codigo *c = &g->codigo;
+    Local a = local_de(g, ins->a);
+    Local b = local_de(g, ins->b);
+    Local d = ins->op == OP_SOMAR_K_I ? (Local){ LOCAL_IMM, 0, 0, ins->c } : local_de(g, ins->c);
+    // Calcula direto no registrador do destino se ele nao for o segundo operando.
+    int r = a.tipo == LOCAL_REG && !(d.tipo == LOCAL_REG && d.reg == a.reg) ? a.reg : RAX;
+    carregar(c, r, b);
+    operar(c, op, ext, r, d);
+    if (r == RAX)
+        guardar(c, a, RAX);
+}
+
+static void dividir_i(Gerador *g, const Instrucao *ins, int indice) {
+    Codigo *c = &g->codigo;
+    carregar(c, RCX, local_de(g, ins->c));
+    testar(c, RCX);
+    // Divisao por zero: o interpretador refaz a instrucao e acusa o erro.
+    sair(g, CC_E, indice);
+    op_imm(c, 7, RCX, -1);
+    int divisao = saltar_rel(c, CC_NE);
+    carregar(c, RAX, local_de(g, ins->b));
+    rex(c, 1, 0, RAX);              // neg rax (INT64_MIN / -1 transborda)
+    byte(c, 0xF7);
+    modrm_reg(c, 3, RAX);
+    int fim = saltar_rel(c, -1);
+    ligar(c, divisao, c->tamanho);
+    carregar(c, RAX, local_de(g, ins->b));
+    byte(c, 0x48);                  // cqo
+    byte(c, 0x99);
+    rex(c, 1, 0, RCX);              // idiv rcx
+    byte(c, 0xF7);
+    modrm_reg(c, 7, RCX);
+    ligar(c, fim, c->tamanho);
+    guardar(c, local_de(g, ins->a), RAX);
+}
+
+static void binaria_f(Gerador *g, const Instrucao *ins, int op) {
+    Codigo *c = &g->codigo;
+    carregar(c, RAX, local_de(g, ins->b));
+    carregar(c, RCX, local_de(g, ins->c));
+    para_xmm(c, 0, RAX);
+    para_xmm(c, 1, RCX);
+    op_sd(c, op, 0, 1);
+    de_xmm(c, RAX, 0);
+    guardar(c, local_de(g, ins->a), RAX);
+}
+
+static void comparar_i(Gerador *g, const Instrucao *ins, int cc) {
+    Codigo *c = &g->codigo;
+    carregar(c, RAX, local_de(g, ins->b));
+    operar(c, 0x3B, 7, RAX, local_de(g, ins->c));
+    setcc_al(c, cc);
+    estender_al(c);
+    guardar(c, local_de(g, ins->a), RAX);
+}
+
+// Resultado em al da comparacao de xmm0 com xmm1 (ou com zero, sem 'ins->c').
+// Com NaN, ucomisd liga ZF, PF e CF: so != e verdadeiro.
+static void comparar_f(Gerador *g, int op) {
+    Codigo *c = &g->codigo;
+    switch (op) {
+        case OP_IGUAL_F:
+        case OP_NAO_F:
+            ucomisd(c, 0, 1);
+            setcc_al(c, CC_E);
+            setcc_cl(c, CC_NP);
+            byte(c, 0x20);          // and al, cl
+            byte(c, 0xC8);
+            break;
+        case OP_DIFERENTE_F:
+        case OP_VERDADE_F:
+            ucomisd(c, 0, 1);
+            setcc_al(c, CC_NE);
+            setcc_cl(c, CC_P);
+            byte(c, 0x08);          // or al, cl
+            byte(c, 0xC8);
+            break;
+        case OP_MENOR_F:        ucomisd(c, 1, 0); setcc_al(c, CC_A); break;
+        case OP_MENOR_IGUAL_F:  ucomisd(c, 1, 0); setcc_al(c, CC_AE); break;
+        case OP_MAIOR_F:        ucomisd(c, 0, 1); setcc_al(c, CC_A); break;
+        default:                ucomisd(c, 0, 1); setcc_al(c, CC_AE); break;
+    }
+    estender_al(c);
+}
+
+static void testar_i(Gerador *g, const Instrucao *ins, int cc) {
+    Codigo *c = &g->codigo;
+    carregar(c, RAX, local_de(g, ins->b));
+    testar(c, RAX);
+    setcc_al(c, cc);
+    estender_al(c);
+    guardar(c, local_de(g, ins->a), RAX);
+}
+
+static void saltar_se(Gerador *g, const Instrucao *ins, int cc) {
+    Codigo *c = &g->codigo;
+    Local a = local_de(g, ins->a);
+    int r = a.tipo == LOCAL_REG ? a.reg : RAX;
+    carregar(c, r, a);
+    testar(c, r);
+    saltar(g, cc, ins->b);
+}
+
+static void saltar_se_comparacao(Gerador *g, const Instrucao *ins, int cc) {
+    Codigo *c = &g->codigo;
+    Local a = local_de(g, ins->a);
+    int r = a.tipo == LOCAL_REG ? a.reg : RAX;
+    carregar(c, r, a);
+    operar(c, 0x3B, 7, r, local_de(g, ins->b));
+    saltar(g, cc, ins->c);
+}
+
+// Traduz a instrucao 'i' (do trecho); read, print, return e parar saem para o interpretador.
+static void traduzir(Gerador *g, int i) {
+    const Instrucao *ins = &g->prog->codigo[i];
+    Codigo *c = &g->codigo;
+    switch (ins->op) {
+        case OP_MOVER: {
+            Local a = local_de(g, ins->a);
+            int r = a.tipo == LOCAL_REG ? a.reg : RAX;
+            carregar(c, r, local_de(g, ins->b));
+            guardar(c, a, r);
+            break;
+        }
+        case OP_I2F:
+            carregar(c, RAX, local_de(g, ins->b));
+            byte(c, 0xF2);          // cvtsi2sd xmm0, rax
+            rex(c, 1, 0, RAX);
+            byte(c, 0x0F);
+            byte(c, 0x2A);
+            modrm_reg(c, 0, RAX);
+            de_xmm(c, RAX, 0);
+            guardar(c, local_de(g, ins->a), RAX);
+            break;
+
+        case OP_SOMAR_I:
+        case OP_SOMAR_K_I:          binaria_i(g, ins, 0x03, 0); break;
+        case OP_SUBTRAIR_I:         binaria_i(g, ins, 0x2B, 5); break;
+        case OP_MULTIPLICAR_I:      binaria_i(g, ins, 0x0FAF, -1); break;
+        case OP_DIVIDIR_I:          dividir_i(g, ins, i); break;
+        case OP_SOMAR_F:            binaria_f(g, ins, 0x58); break;
+        case OP_SUBTRAIR_F:         binaria_f(g, ins, 0x5C); break;
+        case OP_MULTIPLICAR_F:      binaria_f(g, ins, 0x59); break;
+        case OP_DIVIDIR_F:          binaria_f(g, ins, 0x5E); break;
+
+        case OP_IGUAL_I:            comparar_i(g, ins, CC_E); break;
+        case OP_DIFERENTE_I:        comparar_i(g, ins, CC_NE); break;
+        case OP_MENOR_I:            comparar_i(g, ins, CC_L); break;
+        case OP_MENOR_IGUAL_I:      comparar_i(g, ins, CC_LE); break;
+        case OP_MAIOR_I:            comparar_i(g, ins, CC_G); break;
+        case OP_MAIOR_IGUAL_I:      comparar_i(g, ins, CC_GE); break;
+        case OP_IGUAL_F: case OP_DIFERENTE_F: case OP_MENOR_F:
+        case OP_MENOR_IGUAL_F: case OP_MAIOR_F: case OP_MAIOR_IGUAL_F:
+            carregar(c, RAX, local_de(g, ins->b));
+            carregar(c, RCX, local_de(g, ins->c));
+            para_xmm(c, 0, RAX);
+            para_xmm(c, 1, RCX);
+            comparar_f(g, ins->op);
+            guardar(c, local_de(g, ins->a), RAX);
+            break;
+
+        case OP_NAO_I:              testar_i(g, ins, CC_E); break;
+        case OP_VERDADE_I:          testar_i(g, ins, CC_NE); break;
+        case OP_NAO_F:
+        case OP_VERDADE_F:
+            carregar(c, RAX, local_de(g, ins->b));
+            para_xmm(c, 0, RAX);
+            byte(c, 0x66);          // xorpd xmm1, xmm1
+            byte(c, 0x0F);
+            byte(c, 0x57);
+            modrm_reg(c, 1, 1);
+            comparar_f(g, ins->op);
+            guardar(c, local_de(g, ins->a), RAX);
+            break;
+
+        case OP_SALTAR:             saltar(g, -1, ins->a); break;
+        case OP_SALTAR_SE_FALSO:    saltar_se(g, ins, CC_E); break;
+        case OP_SALTAR_SE_VERDADE:  saltar_se(g, ins, CC_NE); break;
+        case OP_SALTAR_SE_IGUAL_I:          saltar_se_comparacao(g, ins, CC_E); break;
+        case OP_SALTAR_SE_DIFERENTE_I:      saltar_se_comparacao(g, ins, CC_NE); break;
+        case OP_SALTAR_SE_MENOR_I:          saltar_se_comparacao(g, ins, CC_L); break;
+        case OP_SALTAR_SE_MENOR_IGUAL_I:    saltar_se_comparacao(g, ins, CC_LE); break;
+        case OP_SALTAR_SE_MAIOR_I:          saltar_se_comparacao(g, ins, CC_G); break;
+        case OP_SALTAR_SE_MAIOR_IGUAL_I:    saltar_se_comparacao(g, ins, CC_GE); break;
+
+        default:
+            sair(g, -1, i);
+            break;
+    }
+}
+
+/* ============================ Alocacao ============================ */
+
+// Os registradores da VM mais usados no trecho (fora as constantes) ficam
+// nos alocaveis durante todo o laco.
+static void alocar_registradores(Gerador *g) {
+    const Programa *p = g->prog;
+    int limite = p->num_variaveis + p->num_temporarios;
+    int *usos = alocar((size_t)limite + 1, sizeof(int));
+    unsigned char *escritos = alocar((size_t)limite + 1, 1);
+    for (int i = g->cabeca; i <= g->fim; i++) {
+        const Instrucao *ins = &p->codigo[i];
+        const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+        for (int k = 0; k < 3; k++) {
+            int papel = papeis_opcode[ins->op][k];
+            if ((papel == PAPEL_LIDO || papel == PAPEL_ESCRITO) && operandos[k] < limite) {
+                usos[operandos[k]]++;
+                if (papel == PAPEL_ESCRITO)
+                    escritos[operandos[k]] = 1;
+            }
+        }
+    }
+    g->num_alocados = 0;
+    while (g->num_alocados < NUM_ALOCAVEIS) {
+        int melhor = -1;
+        for (int i = g->cabeca; i <= g->fim; i++) {
+            const Instrucao *ins = &p->codigo[i];
+            const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+            for (int k = 0; k < 3; k++) {
+                int papel = papeis_opcode[ins->op][k];
+                int reg = operandos[k];
+                if ((papel == PAPEL_LIDO || papel == PAPEL_ESCRITO) && reg < limite &&
+                    usos[reg] > 0 && (melhor < 0 || usos[reg] > usos[melhor]))
+                    melhor = reg;
+            }
+        }
+        if (melhor < 0)
+            break;
+        g->reg_vm[g->num_alocados] = melhor;
+        g->escrito[g->num_alocados] = escritos[melhor];
+        g->num_alocados++;
+        usos[melhor] = 0;
+    }
+    free(escritos);
+    free(usos);
+}
+
+/* ============================ Compilacao ============================ */
+
+// Compila o trecho [cabeca, fim] como o laco j->num_lacos (NULL = falhou).
+static CodigoNativo compilar_laco(Jit *j, int cabeca, int fim) {
+    Gerador g;
+    memset(&g, 0, sizeof(g));
+    g.prog = j->prog;
+    g.cabeca = cabeca;
+    g.fim = fim;
+    g.rotulos = alocar((size_t)(fim - cabeca + 1), sizeof(int));
+    alocar_registradores(&g);
+    Codigo *c = &g.codigo;
+
+    // Entrada: salva os preservados e carrega as variaveis alocadas.
+    for (int k = 0; k < g.num_alocados; k++)
+        if (preservado(alocaveis[k]))
+            empilhar(c, alocaveis[k]);
+    for (int k = 0; k < g.num_alocados; k++)
+        op_rm(c, 0x8B, alocaveis[k], (int32_t)(g.reg_vm[k] * (int)sizeof(Valor)));
+
+    for (int i = cabeca; i <= fim; i++) {
+        g.rotulos[i - cabeca] = c->tamanho;
+        traduzir(&g, i);
+    }
+    // Cair do fim do trecho tambem e sair.
+    saltar(&g, -1, fim + 1);
+
+    // Saidas: uma por instrucao de destino fora do trecho, com eax = destino.
+    int *saidas = alocar((size_t)g.num_pendentes + 1, sizeof(int));
+    int *destinos_saida = alocar((size_t)g.num_pendentes + 1, sizeof(int));
+    int num_saidas = 0;
+    int *ligacoes_comuns = alocar((size_t)g.num_pendentes + 1, sizeof(int));
+    for (int k = 0; k < g.num_pendentes; k++) {
+        int destino = g.destinos[k];
+        if (destino < 0) {
+            destino = -1 - destino;
+        } else if (destino >= cabeca && destino <= fim) {
+            ligar(c, g.pendentes[k], g.rotulos[destino - cabeca]);
+            continue;
+        }
+        int s = 0;
+        while (s < num_saidas && destinos_saida[s] != destino)
+            s++;
+        if (s == num_saidas) {
+            destinos_saida[s] = destino;
+            saidas[s] = c->tamanho;
+            byte(c, 0xB8);          // mov eax, destino
+            u32(c, (uint32_t)destino);
+            ligacoes_comuns[s] = saltar_rel(c, -1);
+            num_saidas++;
+        }
+        ligar(c, g.pendentes[k], saidas[s]);
+    }
+
+    // Saida comum: devolve as variaveis alteradas e restaura os preservados.
+    int saida_comum = c->tamanho;
+    for (int s = 0; s < num_saidas; s++)
+        ligar(c, ligacoes_comuns[s], saida_comum);
+    for (int k = 0; k < g.num_alocados; k++)
+        if (g.escrito[k])
+            guardar_mem(c, (int32_t)(g.reg_vm[k] * (int)sizeof(Valor)), alocaveis[k]);
+    for (int k = g.num_alocados - 1; k >= 0; k--)
+        if (preservado(alocaveis[k]))
+            desempilhar(c, alocaveis[k]);
+    byte(c, 0xC3);                  // ret
+
+    free(ligacoes_comuns);
+    free(destinos_saida);
+    free(saidas);
+    free(g.rotulos);
+    free(g.pendentes);
+    free(g.destinos);
+
+    // O buffer so fica executavel depois de escrito (nunca escrita e execucao juntas).
+    long pagina = sysconf(_SC_PAGESIZE);
+    size_t total = ((size_t)c->tamanho + (size_t)pagina - 1) / (size_t)pagina * (size_t)pagina;
+    void *mapa = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapa == MAP_FAILED) {
+        free(c->bytes);
+        return NULL;
+    }
+    memcpy(mapa, c->bytes, (size_t)c->tamanho);
+    free(c->bytes);
+    if (mprotect(mapa, total, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mapa, total);
+        return NULL;
+    }
+    j->bytes += total;
+
+    int capacidade = j->capacidade_lacos;
+    j->mapas = crescer(j->mapas, &capacidade, j->num_lacos + 1, sizeof(void *));
+    capacidade = j->capacidade_lacos;
+    j->tamanhos_mapas = crescer(j->tamanhos_mapas, &capacidade, j->num_lacos + 1, sizeof(size_t));
+    j->lacos = crescer(j->lacos, &j->capacidade_lacos, j->num_lacos + 1, sizeof(CodigoNativo));
+    CodigoNativo nativo;
+    memcpy(&nativo, &mapa, sizeof(nativo));
+    j->mapas[j->num_lacos] = mapa;
+    j->tamanhos_mapas[j->num_lacos] = total;
+    j->lacos[j->num_lacos] = nativo;
+    return nativo;
+}
+
+int jit_disponivel(void) {
+    return 1;
+}
+
+#else
+
+int jit_disponivel(void) {
+    return 0;
+}
+
+#endif
+
+/* ============================ Camadas ============================ */
+
+void jit_iniciar(Jit *j, const Programa *p) {
+    memset(j, 0, sizeof(*j));
+    j->prog = p;
+    j->voltas = alocar((size_t)p->num_instrucoes + 1, sizeof(int));
+}
+
+void jit_liberar(Jit *j) {
+#ifdef JIT_X86_64
+    for (int k = 0; k < j->num_lacos; k++)
+        munmap(j->mapas[k], j->tamanhos_mapas[k]);
+#endif
+    free(j->voltas);
+    free(j->lacos);
+    free(j->mapas);
+    free(j->tamanhos_mapas);
+    memset(j, 0, sizeof(*j));
+}
+
+int jit_volta(Jit *j, Valor *registradores, int cabeca, int origem) {
+    int v = j->voltas[cabeca];
+    if (v < -1) {
+        j->entradas++;
+        return j->lacos[-2 - v](registradores);
+    }
+    if (v < 0 || ++j->voltas[cabeca] < JIT_LIMIAR)
+        return cabeca;
+#ifdef JIT_X86_64
+    if (compilar_laco(j, cabeca, origem)) {
+        j->voltas[cabeca] = -2 - j->num_lacos;
+        j->num_lacos++;
+        j->entradas++;
+        return j->lacos[j->num_lacos - 1](registradores);
+    }
+#else
+    (void)registradores;
+    (void)origem;
+#endif
+    j->voltas[cabeca] = -1;
+    j->lacos_recusados++;
+    return cabeca;
+}
@@ -0,0 +1,51 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <stddef.h>
+#include "vm.h"
+
+/* Execucao em camadas: compilador de lacos quentes para x86-64.
+   O interpretador conta os saltos para tras. Quando uma cabeca de laco
+   passa de JIT_LIMIAR voltas, o trecho [cabeca, salto de volta] e
+   traduzido instrucao por instrucao (um modelo de maquina por opcode) para
+   um buffer mmap'd, que so vira executavel depois de escrito. Os
+   registradores da VM mais usados no laco ficam em registradores da
+   maquina; constantes viram imediatos. Saltos para fora do trecho, read,
+   print, return e a divisao por zero saem do codigo nativo de volta para o
+   interpretador, na instrucao correspondente. Fora de x86-64 (ou sem mmap)
+   jit_disponivel() e 0 e tudo e interpretado. */
+
+#ifndef JIT_LIMIAR
+#define JIT_LIMIAR 1000
+#endif
+
+// Codigo nativo de um laco: executa a partir da cabeca sobre 'registradores'
+// e retorna a instrucao em que o interpretador continua.
+typedef int32_t (*CodigoNativo)(Valor *registradores);
+
+struct Jit {
+    const Programa *prog;
+    // Por instrucao: voltas contadas (>= 0), -1 se o laco foi recusado ou
+    // -2 - k se e o laco compilado k.
+    int *voltas;
+    CodigoNativo *lacos;
+    void **mapas;
+    size_t *tamanhos_mapas;
+    int num_lacos;
+    int capacidade_lacos;
+
+    int lacos_recusados;
+    long long entradas;     // Chamadas ao codigo nativo.
+    size_t bytes;           // Codigo de maquina gerado.
+};
+
+int jit_disponivel(void);
+void jit_iniciar(Jit *j, const Programa *p);
+void jit_liberar(Jit *j);
+
+// Chamado pelo interpretador a cada salto de 'origem' para 'cabeca' <= origem:
+// conta a volta e, se o laco estiver (ou ficar) compilado, executa-o.
+// Retorna a instrucao em que o interpretador continua.
+int jit_volta(Jit *j, Valor *registradores, int cabeca, int origem);
+
+#endif
@@ -0,0 +1,131 @@
+#include <string.h>
+#include "lexer_reentrante.h"
+#include "saida.h"
+
+/* ============================
+   Classes de caracteres
+   ============================ */
+
+#define E_DIGITO(c)  ((c) >= '0' && (c) <= '9')
+#define E_LETRA(c)   (((c) >= 'a' && (c) <= 'z') || ((c) >= 'A' && (c) <= 'Z') || (c) == '_')
+
+void lexer_r_iniciar(LexerReentrante *lx, const char *texto, size_t tamanho) {
+    lx->inicio = texto;
+    lx->pos = texto;
+    lx->fim = texto + tamanho;
+    lx->lexema = texto;
+    lx->tamanho = 0;
+    lx->linha = 1;
+    lx->erros_lexicos = 0;
+    lx->relatar_erros = 1;
+}
+
+// Palavras reservadas: como no Flex, ganham do ID quando o tamanho empata.
+static int palavra_reservada(const char *s, int n) {
+    switch (n) {
+        case 2:
+            if (memcmp(s, "if", 2) == 0) return T_IF;
+            if (memcmp(s, "do", 2) == 0) return T_DO;
+            break;
+        case 3:
+            if (memcmp(s, "int", 3) == 0) return T_TIPO;
+            if (memcmp(s, "for", 3) == 0) return T_FOR;
+            break;
+        case 4:
+            if (memcmp(s, "main", 4) == 0) return T_MAIN;
+            if (memcmp(s, "char", 4) == 0) return T_TIPO;
+            if (memcmp(s, "void", 4) == 0) return T_TIPO;
+            if (memcmp(s, "else", 4) == 0) return T_ELSE;
+            if (memcmp(s, "read", 4) == 0) return T_READ;
+            break;
+        case 5:
+            if (memcmp(s, "float", 5) == 0) return T_TIPO;
+            if (memcmp(s, "while", 5) == 0) return T_WHILE;
+            if (memcmp(s, "print", 5) == 0) return T_PRINT;
+            break;
+        case 6:
+            if (memcmp(s, "return", 6) == 0) return T_RETURN;
+            break;
+    }
+    return T_ID;
+}
+
+int lexer_r_proximo(LexerReentrante *lx) {
+    const char *p = lx->pos;
+    const char *fim = lx->fim;
+
+    // Ignora espacos e comentarios de linha.
+    for (;;) {
+        while (p < fim && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+            if (*p == '\n')
+                lx->linha++;
+            p++;
+        }
+        if (p + 1 < fim && p[0] == '/' && p[1] == '/') {
+            while (p < fim && *p != '\n')
+                p++;
+            continue;
+        }
+        break;
+    }
+
+    lx->lexema = p;
+    if (p >= fim) {
+        lx->pos = p;
+        lx->tamanho = 0;
+        return T_EOF;
+    }
+
+    const char *q = p + 1;
+    int tk;
+    char c = *p;
+
+    if (E_LETRA(c)) {
+        while (q < fim && (E_LETRA(*q) || E_DIGITO(*q)))
+            q++;
+        tk = palavra_reservada(p, (int)(q - p));
+    } else if (E_DIGITO(c)) {
+        while (q < fim && E_DIGITO(*q))
+            q++;
+        // Parte decimal so se houver ao menos um digito depois do ponto.
+        if (q + 1 < fim && *q == '.' && E_DIGITO(q[1])) {
+            q += 2;
+            while (q < fim && E_DIGITO(*q))
+                q++;
+        }
+        tk = T_NUM;
+    } else {
+        int segundo_igual = (q < fim && *q == '=');
+        switch (c) {
+            case '=': if (segundo_igual) { q++; tk = T_OP_COM; } else tk = T_IGUAL; break;
+            case '!': if (segundo_igual) { q++; tk = T_OP_COM; } else tk = T_NOT; break;
+            case '>':
+            case '<': if (segundo_igual) q++; tk = T_OP_COM; break;
+            case '&':
+            case '|':
+                if (q < fim && *q == c) { q++; tk = T_OP_LOG; }
+                else tk = T_ERROR;
+                break;
+            case ';': tk = T_PV; break;
+            case ',': tk = T_VIRG; break;
+            case '(': tk = T_PA; break;
+            case ')': tk = T_PF; break;
+            case '{': tk = T_CA; break;
+            case '}': tk = T_CF; break;
+            case '+': tk = T_SOMA; break;
+            case '-': tk = T_SUB; break;
+            case '*': tk = T_MUL; break;
+            case '/': tk = T_DIV; break;
+            default:  tk = T_ERROR; break;
+        }
+    }
+
+    lx->pos = q;
+    lx->tamanho = (int)(q - p);
+    if (tk == T_ERROR) {
+        lx->erros_lexicos++;
+        if (lx->relatar_erros)
+            saida_erro_lexico(p, lx->tamanho);
+    }
+    return tk;
+}
@@ -0,0 +1,34 @@
+#ifndef LEXER_REENTRANTE_H
+#define LEXER_REENTRANTE_H
+
+#include <stddef.h>
+#include "tokens.h"
+
+/* Analisador lexico reentrante sobre um buffer em memoria.
+   Reconhece a mesma linguagem de lexer.l, mas guarda todo o estado na
+   estrutura abaixo, entao cada thread pode ter o seu; tambem nao copia o
+   texto e pode recomecar em qualquer fronteira de token (analise
+   incremental, empurrada e em fatias), o que o scanner do Flex nao faz.
+   Uma mudanca em lexer.l precisa ser refeita aqui: --conferir-lexer
+   compara os dois sobre um arquivo, e conformidade/conferir.sh o roda em
+   todo o corpus. Caracteres invalidos sao relatados por
+   saida_erro_lexico(), como em lexer.l. */
+typedef struct {
+    const char *inicio;     // Inicio do buffer de entrada.
+    const char *pos;        // Proximo caractere a ser lido.
+    const char *fim;        // Um depois do ultimo caractere.
+    const char *lexema;     // Texto do ultimo token (nao termina em '\0').
+    int tamanho;            // Tamanho do lexema.
+    int linha;              // Linha do ultimo token (comeca em 1).
+    int erros_lexicos;      // Quantos T_ERROR foram produzidos.
+    int relatar_erros;      // Relata cada T_ERROR (desligue ao relexar um texto).
+} LexerReentrante;
+
+// Prepara o lexer para ler 'tamanho' bytes de 'texto' (o buffer nao e copiado),
+// relatando os erros lexicos.
+void lexer_r_iniciar(LexerReentrante *lx, const char *texto, size_t tamanho);
+
+// Devolve o tipo do proximo token (T_EOF no fim) e atualiza lexema/tamanho.
+int lexer_r_proximo(LexerReentrante *lx);
+
+#endif
@@ -0,0 +1,18 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "memoria.h"
+
+void *crescer(void *dados, int *capacidade, int necessario, size_t tamanho_item) {
+    if (necessario <= *capacidade)
+        return dados;
+    int nova = *capacidade ? *capacidade : 64;
+    while (nova < necessario)
+        nova *= 2;
+    void *novos = realloc(dados, (size_t)nova * tamanho_item);
+    if (!novos) {
+        fprintf(stderr, "Erro: memoria insuficiente.\n");
+        exit(1);
+    }
+    *capacidade = nova;
+    return novos;
+}
@@ -0,0 +1,12 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stddef.h>
+
+/* Vetores que crescem por dobra. 'crescer' garante espaco para
+   'necessario' itens de 'tamanho_item' bytes: se a capacidade nao basta,
+   dobra a partir de 64 ate caber e realoca. Retorna o vetor (possivelmente
+   movido) e atualiza '*capacidade'. Sem memoria, o programa termina. */
+void *crescer(void *dados, int *capacidade, int necessario, size_t tamanho_item);
+
+#endif
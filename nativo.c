@@ -0,0 +1,443 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "nativo.h"
+#include "construcao.h"
+
+static void *alocar(size_t quantidade, size_t tamanho_item) {
+    void *dados = calloc(quantidade, tamanho_item);
+    if (!dados) {
+        fprintf(stderr, "Erro: memoria insuficiente para o codigo nativo.\n");
+        exit(1);
+    }
+    return dados;
+}
+
+/* ============================ Runtime ============================ */
+
+// Ligado junto com o assembly: mesmos formatos de vm.c.
+static const char runtime_c[] =
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <stdint.h>\n"
+    VM_TEXTO_DE(VM_DEFINIR_FLOAT_PARA_INT(cmini_float_para_int)) "\n"
+    "int64_t cmini_ler_i(void) { long long v; return scanf(\"%lld\", &v) == 1 ? v : 0; }\n"
+    "double cmini_ler_f(void) { double v; return scanf(\"%lf\", &v) == 1 ? v : 0.0; }\n"
+    "int64_t cmini_ler_c(void) { char v; return scanf(\" %c\", &v) == 1 ? (unsigned char)v : 0; }\n"
+    "void cmini_escrever_i(int64_t v) { printf(\"%lld\\n\", (long long)v); }\n"
+    "void cmini_escrever_f(double v) { printf(\"%g\\n\", v); }\n"
+    "void cmini_escrever_c(int64_t v) { printf(\"%c\\n\", (char)v); }\n"
+    "void cmini_divisao_por_zero(int instrucao) {\n"
+    "    fflush(stdout);\n"
+    "    fprintf(stderr, \"Erro de execucao: divisao por zero (instrucao %d).\\n\", instrucao);\n"
+    "    exit(1);\n"
+    "}\n";
+
+/* ============================ Operandos ============================ */
+
+enum { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+static const char *const nomes_reg[16] = {
+    "%rax", "%rcx", "%rdx", "%rbx", "%rsp", "%rbp", "%rsi", "%rdi",
+    "%r8", "%r9", "%r10", "%r11", "%r12", "%r13", "%r14", "%r15",
+};
+
+// Preservados entre chamadas: as variaveis sobrevivem ao runtime sem salvar nada.
+static const int alocaveis[] = { RBX, RBP, R12, R13, R14, R15 };
+static const char *const nomes_32[] = { "%ebx", "%ebp", "%r12d", "%r13d", "%r14d", "%r15d" };
+#define NUM_ALOCAVEIS ((int)(sizeof(alocaveis) / sizeof(alocaveis[0])))
+
+typedef enum { LOCAL_REG, LOCAL_MEM, LOCAL_IMM } TipoLocal;
+
+typedef struct {
+    TipoLocal tipo;
+    int reg;
+    long long disp;
+    int64_t imm;
+} Local;
+
+typedef struct {
+    const Programa *prog;
+    FILE *saida;
+    int reg_vm[NUM_ALOCAVEIS];
+    int num_alocados;
+} Emissor;
+
+static int e_constante(const Programa *p, int reg, int64_t *valor) {
+    int k = reg - (p->num_variaveis + p->num_temporarios);
+    if (k < 0 || k >= p->num_constantes || p->registradores_constantes[k] != reg)
+        return 0;
+    *valor = p->valores_constantes[k].i;
+    return 1;
+}
+
+static Local local_de(const Emissor *e, int reg) {
+    Local l = { LOCAL_MEM, 0, (long long)reg * (long long)sizeof(Valor), 0 };
+    if (e_constante(e->prog, reg, &l.imm)) {
+        l.tipo = LOCAL_IMM;
+        return l;
+    }
+    for (int k = 0; k < e->num_alocados; k++)
+        if (e->reg_vm[k] == reg) {
+            l.tipo = LOCAL_REG;
+            l.reg = alocaveis[k];
+        }
+    return l;
+}
+
+static int cabe_32(int64_t v) {
+    return v >= INT32_MIN && v <= INT32_MAX;
+}
+
+// Texto AT&T do operando (imediatos so de 32 bits).
+static const char *texto(Local l, char *buf, size_t tamanho) {
+    if (l.tipo == LOCAL_REG)
+        snprintf(buf, tamanho, "%s", nomes_reg[l.reg]);
+    else if (l.tipo == LOCAL_MEM)
+        snprintf(buf, tamanho, "registradores+%lld(%%rip)", l.disp);
+    else
+        snprintf(buf, tamanho, "$%lld", (long long)l.imm);
+    return buf;
+}
+
+static void carregar(Emissor *e, int r, Local l) {
+    char buf[64];
+    if (l.tipo == LOCAL_REG && l.reg == r)
+        return;
+    if (l.tipo == LOCAL_IMM && !cabe_32(l.imm))
+        fprintf(e->saida, "\tmovabsq $%lld, %s\n", (long long)l.imm, nomes_reg[r]);
+    else
+        fprintf(e->saida, "\tmovq %s, %s\n", texto(l, buf, sizeof(buf)), nomes_reg[r]);
+}
+
+static void guardar(Emissor *e, Local l, int r) {
+    char buf[64];
+    if (l.tipo == LOCAL_REG && l.reg == r)
+        return;
+    fprintf(e->saida, "\tmovq %s, %s\n", nomes_reg[r], texto(l, buf, sizeof(buf)));
+}
+
+// r <- r op l ('op' = addq, subq, imulq, cmpq).
+static void operar(Emissor *e, const char *op, int r, Local l) {
+    char buf[64];
+    if (l.tipo == LOCAL_IMM && !cabe_32(l.imm)) {
+        carregar(e, RCX, l);
+        fprintf(e->saida, "\t%s %%rcx, %s\n", op, nomes_reg[r]);
+    } else {
+        fprintf(e->saida, "\t%s %s, %s\n", op, texto(l, buf, sizeof(buf)), nomes_reg[r]);
+    }
+}
+
+/* ============================ Modelos ============================ */
+
+static void binaria_i(Emissor *e, const Instrucao *ins, const char *op) {
+    Local a = local_de(e, ins->a);
+    Local b = local_de(e, ins->b);
+    Local c = ins->op == OP_SOMAR_K_I ? (Local){ LOCAL_IMM, 0, 0, ins->c } : local_de(e, ins->c);
+    int r = a.tipo == LOCAL_REG && !(c.tipo == LOCAL_REG && c.reg == a.reg) ? a.reg : RAX;
+    carregar(e, r, b);
+    operar(e, op, r, c);
+    guardar(e, a, r);
+}
+
+static void dividir_i(Emissor *e, const Instrucao *ins, int indice) {
+    FILE *s = e->saida;
+    carregar(e, RCX, local_de(e, ins->c));
+    fprintf(s, "\ttestq %%rcx, %%rcx\n\tjnz 1f\n");
+    fprintf(s, "\tmovl $%d, %%edi\n\tcall cmini_divisao_por_zero\n", indice);
+    // -1 a parte: INT64_MIN / -1 transborda.
+    fprintf(s, "1:\n\tcmpq $-1, %%rcx\n\tjne 2f\n");
+    carregar(e, RAX, local_de(e, ins->b));
+    fprintf(s, "\tnegq %%rax\n\tjmp 3f\n2:\n");
+    carregar(e, RAX, local_de(e, ins->b));
+    fprintf(s, "\tcqto\n\tidivq %%rcx\n3:\n");
+    guardar(e, local_de(e, ins->a), RAX);
+}
+
+static void binaria_f(Emissor *e, const Instrucao *ins, const char *op) {
+    carregar(e, RAX, local_de(e, ins->b));
+    carregar(e, RCX, local_de(e, ins->c));
+    fprintf(e->saida, "\tmovq %%rax, %%xmm0\n\tmovq %%rcx, %%xmm1\n\t%s %%xmm1, %%xmm0\n"
+            "\tmovq %%xmm0, %%rax\n", op);
+    guardar(e, local_de(e, ins->a), RAX);
+}
+
+static void comparar_i(Emissor *e, const Instrucao *ins, const char *cc) {
+    carregar(e, RAX, local_de(e, ins->b));
+    operar(e, "cmpq", RAX, local_de(e, ins->c));
+    fprintf(e->saida, "\tset%s %%al\n\tmovzbl %%al, %%eax\n", cc);
+    guardar(e, local_de(e, ins->a), RAX);
+}
+
+// al <- comparacao de xmm0 com xmm1; com NaN (ZF, PF e CF ligados) so != e verdadeiro.
+static void comparar_f(Emissor *e, int op) {
+    FILE *s = e->saida;
+    switch (op) {
+        case OP_IGUAL_F:
+        case OP_NAO_F:
+            fprintf(s, "\tucomisd %%xmm1, %%xmm0\n\tsete %%al\n\tsetnp %%cl\n\tandb %%cl, %%al\n");
+            break;
+        case OP_DIFERENTE_F:
+        case OP_VERDADE_F:
+            fprintf(s, "\tucomisd %%xmm1, %%xmm0\n\tsetne %%al\n\tsetp %%cl\n\torb %%cl, %%al\n");
+            break;
+        case OP_MENOR_F:        fprintf(s, "\tucomisd %%xmm0, %%xmm1\n\tseta %%al\n"); break;
+        case OP_MENOR_IGUAL_F:  fprintf(s, "\tucomisd %%xmm0, %%xmm1\n\tsetae %%al\n"); break;
+        case OP_MAIOR_F:        fprintf(s, "\tucomisd %%xmm1, %%xmm0\n\tseta %%al\n"); break;
+        default:                fprintf(s, "\tucomisd %%xmm1, %%xmm0\n\tsetae %%al\n"); break;
+    }
+    fprintf(s, "\tmovzbl %%al, %%eax\n");
+}
+
+static void testar_i(Emissor *e, const Instrucao *ins, const char *cc) {
+    carregar(e, RAX, local_de(e, ins->b));
+    fprintf(e->saida, "\ttestq %%rax, %%rax\n\tset%s %%al\n\tmovzbl %%al, %%eax\n", cc);
+    guardar(e, local_de(e, ins->a), RAX);
+}
+
+static void saltar_se(Emissor *e, const Instrucao *ins, const char *cc) {
+    Local a = local_de(e, ins->a);
+    int r = a.tipo == LOCAL_REG ? a.reg : RAX;
+    carregar(e, r, a);
+    fprintf(e->saida, "\ttestq %s, %s\n\tj%s .L%d\n", nomes_reg[r], nomes_reg[r], cc, ins->b);
+}
+
+static void saltar_se_comparacao(Emissor *e, const Instrucao *ins, const char *cc) {
+    Local a = local_de(e, ins->a);
+    int r = a.tipo == LOCAL_REG ? a.reg : RAX;
+    carregar(e, r, a);
+    operar(e, "cmpq", r, local_de(e, ins->b));
+    fprintf(e->saida, "\tj%s .L%d\n", cc, ins->c);
+}
+
+static void chamar_com(Emissor *e, const Instrucao *ins, const char *funcao, int em_xmm) {
+    if (em_xmm) {
+        carregar(e, RAX, local_de(e, ins->a));
+        fprintf(e->saida, "\tmovq %%rax, %%xmm0\n");
+    } else {
+        carregar(e, RDI, local_de(e, ins->a));
+    }
+    fprintf(e->saida, "\tcall %s\n", funcao);
+}
+
+static void chamar_para(Emissor *e, const Instrucao *ins, const char *funcao, int em_xmm) {
+    fprintf(e->saida, "\tcall %s\n", funcao);
+    if (em_xmm)
+        fprintf(e->saida, "\tmovq %%xmm0, %%rax\n");
+    guardar(e, local_de(e, ins->a), RAX);
+}
+
+static void traduzir(Emissor *e, int i) {
+    const Instrucao *ins = &e->prog->codigo[i];
+    FILE *s = e->saida;
+    switch (ins->op) {
+        case OP_MOVER: {
+            Local a = local_de(e, ins->a);
+            int r = a.tipo == LOCAL_REG ? a.reg : RAX;
+            carregar(e, r, local_de(e, ins->b));
+            guardar(e, a, r);
+            break;
+        }
+        case OP_I2F:
+            carregar(e, RAX, local_de(e, ins->b));
+            fprintf(s, "\tcvtsi2sdq %%rax, %%xmm0\n\tmovq %%xmm0, %%rax\n");
+            guardar(e, local_de(e, ins->a), RAX);
+            break;
+
+        case OP_SOMAR_I:
+        case OP_SOMAR_K_I:          binaria_i(e, ins, "addq"); break;
+        case OP_SUBTRAIR_I:         binaria_i(e, ins, "subq"); break;
+        case OP_MULTIPLICAR_I:      binaria_i(e, ins, "imulq"); break;
+        case OP_DIVIDIR_I:          dividir_i(e, ins, i); break;
+        case OP_SOMAR_F:            binaria_f(e, ins, "addsd"); break;
+        case OP_SUBTRAIR_F:         binaria_f(e, ins, "subsd"); break;
+        case OP_MULTIPLICAR_F:      binaria_f(e, ins, "mulsd"); break;
+        case OP_DIVIDIR_F:          binaria_f(e, ins, "divsd"); break;
+
+        case OP_IGUAL_I:            comparar_i(e, ins, "e"); break;
+        case OP_DIFERENTE_I:        comparar_i(e, ins, "ne"); break;
+        case OP_MENOR_I:            comparar_i(e, ins, "l"); break;
+        case OP_MENOR_IGUAL_I:      comparar_i(e, ins, "le"); break;
+        case OP_MAIOR_I:            comparar_i(e, ins, "g"); break;
+        case OP_MAIOR_IGUAL_I:      comparar_i(e, ins, "ge"); break;
+        case OP_IGUAL_F: case OP_DIFERENTE_F: case OP_MENOR_F:
+        case OP_MENOR_IGUAL_F: case OP_MAIOR_F: case OP_MAIOR_IGUAL_F:
+            carregar(e, RAX, local_de(e, ins->b));
+            carregar(e, RCX, local_de(e, ins->c));
+            fprintf(s, "\tmovq %%rax, %%xmm0\n\tmovq %%rcx, %%xmm1\n");
+            comparar_f(e, ins->op);
+            guardar(e, local_de(e, ins->a), RAX);
+            break;
+
+        case OP_NAO_I:              testar_i(e, ins, "e"); break;
+        case OP_VERDADE_I:          testar_i(e, ins, "ne"); break;
+        case OP_NAO_F:
+        case OP_VERDADE_F:
+            carregar(e, RAX, local_de(e, ins->b));
+            fprintf(s, "\tmovq %%rax, %%xmm0\n\txorpd %%xmm1, %%xmm1\n");
+            comparar_f(e, ins->op);
+            guardar(e, local_de(e, ins->a), RAX);
+            break;
+
+        case OP_SALTAR:             fprintf(s, "\tjmp .L%d\n", ins->a); break;
+        case OP_SALTAR_SE_FALSO:    saltar_se(e, ins, "z"); break;
+        case OP_SALTAR_SE_VERDADE:  saltar_se(e, ins, "nz"); break;
+        case OP_SALTAR_SE_IGUAL_I:          saltar_se_comparacao(e, ins, "e"); break;
+        case OP_SALTAR_SE_DIFERENTE_I:      saltar_se_comparacao(e, ins, "ne"); break;
+        case OP_SALTAR_SE_MENOR_I:          saltar_se_comparacao(e, ins, "l"); break;
+        case OP_SALTAR_SE_MENOR_IGUAL_I:    saltar_se_comparacao(e, ins, "le"); break;
+        case OP_SALTAR_SE_MAIOR_I:          saltar_se_comparacao(e, ins, "g"); break;
+        case OP_SALTAR_SE_MAIOR_IGUAL_I:    saltar_se_comparacao(e, ins, "ge"); break;
+
+        case OP_LER_I:              chamar_para(e, ins, "cmini_ler_i", 0); break;
+        case OP_LER_F:              chamar_para(e, ins, "cmini_ler_f", 1); break;
+        case OP_LER_C:              chamar_para(e, ins, "cmini_ler_c", 0); break;
+        case OP_ESCREVER_I:         chamar_com(e, ins, "cmini_escrever_i", 0); break;
+        case OP_ESCREVER_F:         chamar_com(e, ins, "cmini_escrever_f", 1); break;
+        case OP_ESCREVER_C:         chamar_com(e, ins, "cmini_escrever_c", 0); break;
+
+        case OP_RETORNAR_I:
+            carregar(e, RAX, local_de(e, ins->a));
+            fprintf(s, "\tjmp .Lfim\n");
+            break;
+        case OP_RETORNAR_F:
+            chamar_com(e, ins, "cmini_float_para_int", 1);
+            fprintf(s, "\tjmp .Lfim\n");
+            break;
+        default:
+            fprintf(s, "\txorl %%eax, %%eax\n\tjmp .Lfim\n");
+            break;
+    }
+}
+
+/* ============================ Alocacao ============================ */
+
+// Usos de cada registrador da VM, com peso 8^profundidade do laco em que
+// aparece; os seis mais pesados ficam nos alocaveis.
+static void alocar_registradores(Emissor *e) {
+    const Programa *p = e->prog;
+    int n = p->num_instrucoes;
+    int limite = p->num_variaveis + p->num_temporarios;
+    int *profundidade = alocar((size_t)n + 1, sizeof(int));
+    for (int i = 0; i < n; i++) {
+        const Instrucao *ins = &p->codigo[i];
+        const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+        for (int k = 0; k < 3; k++)
+            if (papeis_opcode[ins->op][k] == PAPEL_ALVO && operandos[k] <= i) {
+                profundidade[operandos[k]]++;
+                profundidade[i + 1]--;
+            }
+    }
+    double *peso = alocar((size_t)limite + 1, sizeof(double));
+    int atual = 0;
+    for (int i = 0; i < n; i++) {
+        atual += profundidade[i];
+        double fator = 1.0;
+        for (int d = 0; d < atual && d < 10; d++)
+            fator *= 8.0;
+        const Instrucao *ins = &p->codigo[i];
+        const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+        for (int k = 0; k < 3; k++) {
+            int papel = papeis_opcode[ins->op][k];
+            if ((papel == PAPEL_LIDO || papel == PAPEL_ESCRITO) && operandos[k] < limite)
+                peso[operandos[k]] += fator;
+        }
+    }
+    e->num_alocados = 0;
+    while (e->num_alocados < NUM_ALOCAVEIS) {
+        int melhor = -1;
+        for (int r = 0; r < limite; r++)
+            if (peso[r] > 0 && (melhor < 0 || peso[r] > peso[melhor]))
+                melhor = r;
+        if (melhor < 0)
+            break;
+        e->reg_vm[e->num_alocados++] = melhor;
+        peso[melhor] = 0;
+    }
+    free(peso);
+    free(profundidade);
+}
+
+/* ============================ Emissao ============================ */
+
+void nativo_emitir_assembly(const Programa *p, FILE *saida) {
+    Emissor e;
+    memset(&e, 0, sizeof(e));
+    e.prog = p;
+    e.saida = saida;
+    alocar_registradores(&e);
+
+    int n = p->num_instrucoes;
+    unsigned char *e_alvo = alocar((size_t)n + 1, 1);
+    for (int i = 0; i < n; i++) {
+        const Instrucao *ins = &p->codigo[i];
+        const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+        for (int k = 0; k < 3; k++)
+            if (papeis_opcode[ins->op][k] == PAPEL_ALVO)
+                e_alvo[operandos[k]] = 1;
+    }
+
+    fprintf(saida, "# Gerado pelo analisador cmini (%d instrucoes de bytecode).\n", n);
+    fprintf(saida, "\t.text\n\t.globl main\n\t.type main, @function\nmain:\n");
+    for (int k = 0; k < NUM_ALOCAVEIS; k++)
+        fprintf(saida, "\tpushq %s\n", nomes_reg[alocaveis[k]]);
+    // Seis empilhados + o endereco de retorno: alinha a pilha em 16 para as chamadas.
+    fprintf(saida, "\tsubq $8, %%rsp\n");
+    // As variaveis comecam em zero, como na VM.
+    for (int k = 0; k < e.num_alocados; k++)
+        fprintf(saida, "\txorl %s, %s\t# r%d\n", nomes_32[k], nomes_32[k], e.reg_vm[k]);
+    for (int i = 0; i < n; i++) {
+        if (e_alvo[i])
+            fprintf(saida, ".L%d:\n", i);
+        fprintf(saida, "\t# %d %s\n", i, nome_opcode(p->codigo[i].op));
+        traduzir(&e, i);
+    }
+    if (e_alvo[n])
+        fprintf(saida, ".L%d:\n", n);
+    fprintf(saida, "\txorl %%eax, %%eax\n.Lfim:\n\taddq $8, %%rsp\n");
+    for (int k = NUM_ALOCAVEIS - 1; k >= 0; k--)
+        fprintf(saida, "\tpopq %s\n", nomes_reg[alocaveis[k]]);
+    fprintf(saida, "\tret\n\t.size main, .-main\n");
+
+    fprintf(saida, "\t.bss\n\t.align 16\nregistradores:\n\t.zero %lld\n",
+            ((long long)p->num_variaveis + p->num_temporarios + 1) * (long long)sizeof(Valor));
+    fprintf(saida, "\t.section .note.GNU-stack,\"\",@progbits\n");
+    free(e_alvo);
+}
+
+/* ============================ Construcao ============================ */
+
+int nativo_construir(const Programa *p, const char *binario) {
+    char diretorio[512];
+    if (!construcao_criar_diretorio(diretorio, sizeof(diretorio)))
+        return 1;
+    char assembly[600], runtime[600];
+    snprintf(assembly, sizeof(assembly), "%s/programa.s", diretorio);
+    snprintf(runtime, sizeof(runtime), "%s/runtime.c", diretorio);
+
+    int erro = 1;
+    FILE *s = fopen(assembly, "w");
+    FILE *r = s ? fopen(runtime, "w") : NULL;
+    if (s && r) {
+        nativo_emitir_assembly(p, s);
+        fputs(runtime_c, r);
+        erro = ferror(s) || ferror(r);
+    }
+    if (s && fclose(s) != 0)
+        erro = 1;
+    if (r && fclose(r) != 0)
+        erro = 1;
+
+    if (!erro) {
+        const char *fontes[] = { assembly, runtime };
+        erro = construcao_compilar("-O2", binario, fontes, 2);
+    } else {
+        fprintf(stderr, "Erro: nao foi possivel escrever em '%s'.\n", diretorio);
+    }
+    remove(assembly);
+    remove(runtime);
+    rmdir(diretorio);
+    return erro;
+}
@@ -0,0 +1,23 @@
+#ifndef NATIVO_H
+#define NATIVO_H
+
+#include <stdio.h>
+#include "vm.h"
+
+/* Compilacao antecipada para x86-64: o bytecode pronto (depois da fusao)
+   vira assembly GAS de uma funcao main pela ABI System V, instrucao por
+   instrucao como em jit.c. Os registradores da VM moram num vetor em .bss;
+   os seis mais usados (com peso pela profundidade de laco) ficam o tempo
+   todo nos registradores preservados entre chamadas (rbx, rbp, r12-r15) e
+   as constantes viram imediatos. read, print e o erro de divisao por zero
+   chamam um runtime pequeno em C, com os mesmos formatos e mensagens da
+   VM. O binario e montado e ligado pelo compilador C do sistema ($CC, ou
+   cc), sem outras dependencias. */
+
+// Escreve o assembly de 'p' em 'saida'.
+void nativo_emitir_assembly(const Programa *p, FILE *saida);
+
+// Gera o executavel 'binario' para 'p'. Retorna 0 se deu certo.
+int nativo_construir(const Programa *p, const char *binario);
+
+#endif
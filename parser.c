@@ -1,6 +1,22 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
-#include "tokens.h"
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "parser.h"
+#include "verificador_paralelo.h"
+#include "analise_fatiada.h"
+#include "servidor.h"
+#include "incremental.h"
+#include "pipeline.h"
+#include "analise_empurrada.h"
+#include "saida.h"
+#include "estatisticas.h"
+#include "perfil.h"
+#include "gerador.h"
+#include "semantica.h"
+#include "compilador.h"
 
 /* ============================
    Interface com o Analisador Lexico (Lexer)
@@ -8,7 +24,9 @@
 
 /* Prototipos do Flex: yylex retorna o tipo do token, yytext o lexema. */
 int yylex(void);
+void yyrestart(FILE *arquivo);
 extern char *yytext;
+extern int yyleng;
 
 #define MAX_TOKENS 4096
 
@@ -46,67 +64,47 @@ int obter_proximo_token() {
     return tk;
 }
 
+static int fonte_flex_proximo(void *dados, const char **lexema, int *tamanho) {
+    (void)dados;
+    int tk = obter_proximo_token();
+    if (tk == T_EOF || !yytext) {
+        *lexema = "";
+        *tamanho = 0;
+    } else {
+        *lexema = yytext;
+        *tamanho = yyleng;
+    }
+    return tk;
+}
+
+const FonteTokens fonte_flex = { fonte_flex_proximo, NULL };
+
+// Como fonte_flex, somando a FASE_LEXICO o tempo gasto em cada token.
+static int fonte_flex_cronometrada(void *dados, const char **lexema, int *tamanho) {
+    double inicio = relogio_monotonico();
+    int tk = fonte_flex_proximo(dados, lexema, tamanho);
+    estatisticas.segundos[FASE_LEXICO] += relogio_monotonico() - inicio;
+    return tk;
+}
+
+static int fonte_lexer_r_proximo(void *dados, const char **lexema, int *tamanho) {
+    LexerReentrante *lx = dados;
+    int tk = lexer_r_proximo(lx);
+    *lexema = lx->lexema;
+    *tamanho = lx->tamanho;
+    return tk;
+}
+
+FonteTokens fonte_lexer_reentrante(LexerReentrante *lx) {
+    FonteTokens fonte = { fonte_lexer_r_proximo, lx };
+    return fonte;
+}
 
-/* ============================================
-   Nao-Terminais (Estruturas Sintaticas)
-   ============================================ */
-
-// Enumeracao de todos os simbolos Nao-Terminais da gramatica.
-typedef enum {
-    NT_PROGRAM = 0,
-    NT_MAIN_FUNC,
-    NT_LISTA_COMANDOS,
-    NT_COMANDO,
-    NT_BLOCO,
-    NT_DECLARACAO_VAR,
-    NT_DECL_VAR_CAUDA,
-    NT_ATRIBUICAO,
-    NT_COMANDO_LEITURA,
-    NT_COMANDO_ESCRITA,
-    NT_COMANDO_RETORNO,
-    NT_COMANDO_SE,
-    NT_ELSE_OPCIONAL,
-    NT_COMANDO_ENQUANTO,
-    NT_COMANDO_PARA,
-    NT_ATRIBUICAO_SIMPLES,
-    NT_EXPR_BOOLEANA,
-    NT_EXPR_BOOL_RESTO,
-    NT_TERMO_BOOL,
-    NT_EXPR_RELACIONAL,
-    NT_EXPR_REL_RESTO,
-    NT_EXPR_ARITMETICA,
-    NT_EXPR_ARIT_RESTO,
-    NT_TERMO,
-    NT_TERMO_RESTO,
-    NT_FATOR,
-    NUM_NONTERMINALS
-} NonTerminal;
-
-/* Simbolos especiais da pilha de analise */
-#define EPSILON   (-1) // Simbolo para a producao vazia (epsilon)
-#define SIM_FIM   (-2) // Marcador de fundo da pilha/fim da entrada
-
-/* Mapeamento de simbolos: Terminais e Nao-Terminais */
-#define SIM_TERMINAL(t)   (t)
-#define SIM_NAOTERMINAL(nt)   (NUM_TOKENS + (nt))
-
-#define E_TERMINAL(sim)  ((sim) >= 0 && (sim) < NUM_TOKENS)
-#define E_NAOTERMINAL(sim)   ((sim) >= NUM_TOKENS)
 
 /* =======================
    Producoes da Gramatica (Regras de Substituicao)
    ======================= */
 
-#define MAX_RHS 8
-#define NUM_PRODUCTIONS 46
-
-// Estrutura para uma regra de producao (Cabeça -> Corpo).
-typedef struct {
-    int cabeca;              // Nao-Terminal (LHS)
-    int corpo[MAX_RHS];     // Sequencia de simbolos (RHS)
-    int tam_corpo;          // Tamanho da sequencia RHS
-} Producao;
-
 // Array que armazena todas as 46 regras de producao.
 Producao producoes[NUM_PRODUCTIONS];
 
@@ -465,6 +463,11 @@ static int conjunto_first[NUM_NONTERMINALS][NUM_TOKENS];
 static int conjunto_follow[NUM_NONTERMINALS][NUM_TOKENS];
 // Indica se um Nao-Terminal pode derivar a string vazia (e anulavel).
 static int anulavel[NUM_NONTERMINALS];
+// Conjunto de sincronizacao usado na recuperacao de erros (modo panico).
+static int conjunto_sincronizacao[NUM_NONTERMINALS][NUM_TOKENS];
+// Indica se um Nao-Terminal e uma lista: tem producao vazia e uma producao
+// que termina nele mesmo (LISTA_COMANDOS e os *_RESTO).
+int lista_recursiva[NUM_NONTERMINALS];
 
 // Calcula quais nao-terminais podem derivar a string vazia (ε).
 void calcular_anulaveis() {
@@ -663,18 +666,85 @@ void construir_tabela_analise_ll1() {
     }
 }
 
+// Pre-calcula os conjuntos de sincronizacao de cada Nao-Terminal:
+// FOLLOW(A), o fim da entrada e as palavras-chave que so podem iniciar um
+// comando (T_ID fica de fora, pois tambem aparece dentro de expressoes).
+void calcular_conjuntos_sincronizacao() {
+    for (int nt = 0; nt < NUM_NONTERMINALS; nt++) {
+        for (int t = 0; t < NUM_TOKENS; t++) {
+            conjunto_sincronizacao[nt][t] = conjunto_follow[nt][t] ||
+                (conjunto_first[NT_COMANDO][t] && t != T_ID);
+        }
+        conjunto_sincronizacao[nt][T_EOF] = 1;
+    }
+}
+
+// Marca os Nao-Terminais que sao listas recursivas a direita.
+void calcular_listas_recursivas() {
+    for (int nt = 0; nt < NUM_NONTERMINALS; nt++)
+        lista_recursiva[nt] = 0;
+
+    for (int p = 0; p < NUM_PRODUCTIONS; p++) {
+        Producao *prod = &producoes[p];
+        int A = prod->cabeca - NUM_TOKENS;
+        if (prod->tam_corpo > 0 && prod->corpo[prod->tam_corpo - 1] == prod->cabeca && anulavel[A])
+            lista_recursiva[A] = 1;
+    }
+}
+
+// Prepara todas as estruturas da gramatica na ordem de dependencia.
+void preparar_gramatica(void) {
+    double t = estatisticas_marcar();
+    inicializar_producoes();
+    estatisticas_fase(FASE_PRODUCOES, t);
+
+    t = estatisticas_marcar();
+    calcular_anulaveis();
+    calcular_conjuntos_first();
+    estatisticas_fase(FASE_FIRST, t);
+
+    t = estatisticas_marcar();
+    calcular_conjuntos_follow();
+    estatisticas_fase(FASE_FOLLOW, t);
+
+    t = estatisticas_marcar();
+    construir_tabela_analise_ll1();
+    estatisticas_fase(FASE_TABELA, t);
+
+    t = estatisticas_marcar();
+    calcular_conjuntos_sincronizacao();
+    calcular_listas_recursivas();
+    estatisticas_fase(FASE_SINCRONIZACAO, t);
+}
+
 /* ==================
    Pilha de analise
    ================== */
 
-// Estrutura de Pilha usada para simular a derivacao.
-typedef struct {
-    int data[2048];
-    int topo; // Indice do topo da pilha.
-} Pilha;
+#define PILHA_CAPACIDADE_INICIAL 2048
 
-void pilha_init(Pilha *s) { s->topo = -1; }
-void pilha_push(Pilha *s, int v) { s->data[++(s->topo)] = v; }
+void pilha_init(Pilha *s) {
+    s->data = NULL;
+    s->capacidade = 0;
+    s->topo = -1;
+}
+void pilha_liberar(Pilha *s) {
+    free(s->data);
+    pilha_init(s);
+}
+void pilha_push(Pilha *s, int v) {
+    if (s->topo + 1 >= s->capacidade) {
+        int nova = s->capacidade ? s->capacidade * 2 : PILHA_CAPACIDADE_INICIAL;
+        int *dados = realloc(s->data, (size_t)nova * sizeof(int));
+        if (!dados) {
+            fprintf(stderr, "Erro: memoria insuficiente para a pilha de analise.\n");
+            exit(1);
+        }
+        s->data = dados;
+        s->capacidade = nova;
+    }
+    s->data[++(s->topo)] = v;
+}
 int pilha_pop(Pilha *s) {
     if (s->topo < 0) return SIM_FIM;
     return s->data[(s->topo)--];
@@ -684,71 +754,302 @@ int pilha_peek(Pilha *s) {
     return s->data[s->topo];
 }
 
+/* Marcador empilhado abaixo do corpo de uma producao para gerar sair_nt.
+   Usa valores <= -3 para nao colidir com EPSILON e SIM_FIM. */
+#define SIM_SAIDA(p)            (-3 - (p))
+#define E_SAIDA(sim)            ((sim) <= -3)
+#define PRODUCAO_DA_SAIDA(sim)  (-3 - (sim))
+
 /* ==============
    Funcao de Analise Sintatica (Parsing)
    ============== */
 
-// Executa a analise sintatica LL(1) da entrada.
-int analisar() {
-    Pilha pilha;
-    pilha_init(&pilha);
+// Prepara 'e' para uma analise sobre 'pilha_reusada' (que so e esvaziada,
+// nunca liberada, para ser reaproveitada entre arquivos). A pilha comeca
+// com SIM_FIM e os 'num_iniciais' simbolos de 'simbolos_iniciais' (do fundo
+// para o topo). 'receptor' (pode ser NULL) e notificado a cada passo.
+// Fora do modo prefixo, a entrada tem de acabar junto com a pilha e os erros
+// nao interrompem a analise: o parser se recupera e conta todos numa so
+// passada; cada um e impresso se 'relatar_erros' for verdadeiro.
+// No modo prefixo, a analise para quando a pilha esvazia ou no primeiro erro.
+void analise_iniciar(EstadoAnalise *e, Pilha *pilha_reusada, const int *simbolos_iniciais,
+                     int num_iniciais, const ReceptorEventos *receptor, int relatar_erros,
+                     int prefixo) {
+    e->pilha = *pilha_reusada;
+    e->pilha.topo = -1;
+    e->receptor = receptor;
+    // So empilha marcadores de saida se alguem vai ouvir o evento.
+    e->emitir_saida = receptor && receptor->sair_nt;
+    e->relatar_erros = relatar_erros;
+    e->prefixo = prefixo;
+    e->erros = 0;
+    e->casados_desde_erro = ERROS_TOKENS_SILENCIO;
+    e->indice_token = 0;
+    e->terminou = 0;
+    e->expansoes = 0;
+    e->casamentos = 0;
+    e->topo_maximo = 0;
+
+    // Empilha marcador de fim e os simbolos iniciais.
+    pilha_push(&e->pilha, SIM_FIM);
+    for (int i = 0; i < num_iniciais; i++)
+        pilha_push(&e->pilha, simbolos_iniciais[i]);
+}
 
-    // Empilha marcador de fim e o simbolo inicial da gramatica.
-    pilha_push(&pilha, SIM_FIM);
-    pilha_push(&pilha, SIM_NAOTERMINAL(NT_PROGRAM));
+// Avisa o receptor de um passo de recuperacao com o lookahead atual.
+static inline void avisar_recuperacao(EstadoAnalise *e, int contado) {
+    if (e->receptor && e->receptor->recuperar)
+        e->receptor->recuperar(e->receptor->contexto, e->indice_token, contado);
+}
 
-    // O token atual de entrada (lookahead).
-    int token_de_entrada = obter_proximo_token();
+// Passo do driver LL(1): avanca a derivacao com o lookahead 'token' ate ele
+// ser casado ou descartado (retorna 0: falta o proximo token) ou ate a
+// analise acabar (retorna 1). Todo o estado fica em 'e', entao o mesmo
+// passo serve ao laco que puxa tokens e ao analisador empurrado.
+static inline int analise_passo(EstadoAnalise *e, int token, const char *lexema, int tamanho) {
+    Pilha *pilha = &e->pilha;
+    const ReceptorEventos *receptor = e->receptor;
 
-    while (1) {
-        int topo = pilha_peek(&pilha);
+    while (e->erros < MAX_ERROS_SINTATICOS) {
+        int topo = pilha_peek(pilha);
 
         if (topo == SIM_FIM) {
-            // Se o topo da pilha e a entrada acabaram, a analise e um sucesso.
-            if (token_de_entrada == T_EOF) {
-                printf("\nSucesso: programa sintaticamente correto.\n\n");
-                return 1;
-            } else {
-                printf("\nErro sintatico: tokens restantes na entrada.\n\n");
-                return 0;
+            // Se o topo da pilha e a entrada acabaram, a analise terminou.
+            // No modo prefixo o simbolo inicial foi reconhecido por inteiro.
+            if (!e->prefixo && token != T_EOF) {
+                if (e->relatar_erros)
+                    saida_diagnostico(e->indice_token, "tokens restantes na entrada (%.*s)",
+                                      tamanho, lexema);
+                e->erros++;
+                avisar_recuperacao(e, 1);
             }
+            e->terminou = 1;
+            return 1;
         }
 
-        if (E_TERMINAL(topo)) {
+        if (E_SAIDA(topo)) {
+            // Fim do corpo de uma producao: avisa a saida do NT.
+            pilha_pop(pilha);
+            int p = PRODUCAO_DA_SAIDA(topo);
+            receptor->sair_nt(receptor->contexto, producoes[p].cabeca - NUM_TOKENS,
+                              p, e->indice_token);
+        } else if (E_TERMINAL(topo)) {
             // Se for Terminal, tenta dar 'match' com o lookahead.
-            if (topo == token_de_entrada) {
-               pilha_pop(&pilha); // Consome o simbolo da pilha.
-               token_de_entrada = obter_proximo_token(); // Avanca na entrada.
-            } else {
-                printf("\nErro sintatico: esperado token %d, encontrado %d (%s)\n\n",
-                       topo, token_de_entrada, yytext);
-                return 0;
+            if (topo == token) {
+               if (receptor && receptor->casar_terminal)
+                   receptor->casar_terminal(receptor->contexto, token,
+                                            e->indice_token, lexema, tamanho);
+               pilha_pop(pilha); // Consome o simbolo da pilha.
+               e->indice_token++;
+               e->casamentos++;
+               e->casados_desde_erro++;
+               return 0;         // Avanca na entrada.
+            }
+            if (e->prefixo) {
+                e->erros++;
+                break;
             }
+            // Recuperacao: considera o terminal esperado como inserido.
+            int contado = e->casados_desde_erro >= ERROS_TOKENS_SILENCIO;
+            if (contado) {
+                if (e->relatar_erros)
+                    saida_diagnostico(e->indice_token, "esperado %s, encontrado %s (%.*s)",
+                                      token_name(topo), token_name(token), tamanho, lexema);
+                e->erros++;
+            }
+            avisar_recuperacao(e, contado);
+            e->casados_desde_erro = 0;
+            pilha_pop(pilha);
         } else {
             // Se for Nao-Terminal, consulta a tabela LL(1).
             int nt = topo - NUM_TOKENS;
             int prod_index = -1;
 
-            if (token_de_entrada >= 0 && token_de_entrada < NUM_TOKENS)
-                prod_index = tabela_analise[nt][token_de_entrada];
+            if (token >= 0 && token < NUM_TOKENS) {
+                prod_index = tabela_analise[nt][token];
+                PERFIL_CONSULTA(nt, token);
+            }
 
             if (prod_index < 0) {
-                printf("\nErro sintatico: producao inexistente para NT=%d com lookahead=%d (%s)\n\n",
-                       nt, token_de_entrada, yytext);
+                if (e->prefixo) {
+                    e->erros++;
+                    break;
+                }
+                int contado = e->casados_desde_erro >= ERROS_TOKENS_SILENCIO;
+                if (contado) {
+                    if (e->relatar_erros)
+                        saida_diagnostico(e->indice_token,
+                                          "producao inexistente para %s com lookahead %s (%.*s)",
+                                          nonterm_name(nt), token_name(token), tamanho, lexema);
+                    e->erros++;
+                }
+                avisar_recuperacao(e, contado);
+                e->casados_desde_erro = 0;
+
+                // Recuperacao: descarta o NT se o lookahead o sincroniza,
+                // senao descarta o token e tenta de novo.
+                if (token < 0 || token >= NUM_TOKENS ||
+                    conjunto_sincronizacao[nt][token]) {
+                    pilha_pop(pilha);
+                    continue;
+                }
+                e->indice_token++;
                 return 0;
             }
 
-            pilha_pop(&pilha); // Remove o NT.
+            pilha_pop(pilha); // Remove o NT.
             Producao *prod = &producoes[prod_index];
+            PERFIL_EXPANSAO(prod_index);
+
+            if (receptor && receptor->entrar_nt)
+                receptor->entrar_nt(receptor->contexto, nt, prod_index, e->indice_token);
+            if (e->emitir_saida)
+                pilha_push(pilha, SIM_SAIDA(prod_index));
 
             // Empilha o corpo da producao em ordem reversa.
             for (int i = prod->tam_corpo - 1; i >= 0; i--) {
-                pilha_push(&pilha, prod->corpo[i]);
+                pilha_push(pilha, prod->corpo[i]);
             }
+            e->expansoes++;
+            if (pilha->topo > e->topo_maximo)
+                e->topo_maximo = pilha->topo;
         }
     }
 
-    return 0;
+    e->terminou = 1;
+    return 1;
+}
+
+int analise_token(EstadoAnalise *e, int token, const char *lexema, int tamanho) {
+    return e->terminou || analise_passo(e, token, lexema, tamanho);
+}
+
+int analise_concluir(EstadoAnalise *e, Pilha *pilha_reusada) {
+    if (estatisticas.ativas)
+        estatisticas_somar_analise(e->indice_token, e->expansoes, e->casamentos, e->topo_maximo + 1);
+    if (e->erros >= MAX_ERROS_SINTATICOS && e->relatar_erros)
+        saida_diagnostico(-1, "Analise interrompida: limite de %d erros atingido.",
+                          MAX_ERROS_SINTATICOS);
+
+    // Devolve a pilha (possivelmente realocada) para reuso.
+    *pilha_reusada = e->pilha;
+    return e->erros;
+}
+
+// Nucleo da analise LL(1) que puxa os tokens de 'fonte'. Se 'consumidos'
+// nao for NULL (modo prefixo), guarda ali quantos tokens foram usados.
+// Retorna o numero de erros sintaticos.
+static int analisar_nucleo(Pilha *pilha_reusada, const int *simbolos_iniciais, int num_iniciais,
+                           const FonteTokens *fonte, const ReceptorEventos *receptor,
+                           int relatar_erros, int *consumidos) {
+    EstadoAnalise e;
+    analise_iniciar(&e, pilha_reusada, simbolos_iniciais, num_iniciais, receptor,
+                    relatar_erros, consumidos != NULL);
+
+    // O token atual de entrada (lookahead).
+    const char *lexema;
+    int tamanho, token;
+    do {
+        token = fonte->proximo(fonte->dados, &lexema, &tamanho);
+    } while (!analise_passo(&e, token, lexema, tamanho));
+
+    if (consumidos)
+        *consumidos = e.indice_token;
+    return analise_concluir(&e, pilha_reusada);
+}
+
+int analisar_entrada_desde(Pilha *pilha_reusada, const int *simbolos_iniciais, int num_iniciais,
+                           const FonteTokens *fonte, const ReceptorEventos *receptor,
+                           int relatar_erros) {
+    return analisar_nucleo(pilha_reusada, simbolos_iniciais, num_iniciais, fonte, receptor,
+                           relatar_erros, NULL);
+}
+
+int analisar_prefixo(Pilha *pilha_reusada, int simbolo_inicial, const FonteTokens *fonte,
+                     const ReceptorEventos *receptor, int *consumidos) {
+    *consumidos = 0;
+    return analisar_nucleo(pilha_reusada, &simbolo_inicial, 1, fonte, receptor, 0, consumidos);
+}
+
+// Analisa um programa completo, a partir do simbolo inicial da gramatica.
+int analisar_entrada(Pilha *pilha_reusada, const FonteTokens *fonte,
+                     const ReceptorEventos *receptor, int relatar_erros) {
+    static const int inicial[] = { SIM_NAOTERMINAL(NT_PROGRAM) };
+    return analisar_entrada_desde(pilha_reusada, inicial, 1, fonte, receptor, relatar_erros);
+}
+
+/* Reconhecedor fundido: o parser puxa so o tipo do token direto de yylex(),
+   sem copiar o lexema para tokens_armazenados, sem FonteTokens, sem eventos
+   e sem recuperacao de erros. O laco fica reduzido ao DFA do Flex mais a
+   consulta na tabela LL(1). Para no primeiro erro.
+   Retorna 1 se a entrada e um programa sintaticamente correto. */
+int reconhecer(Pilha *pilha_reusada) {
+    Pilha pilha = *pilha_reusada;
+    pilha.topo = -1;
+    pilha_push(&pilha, SIM_FIM);
+    pilha_push(&pilha, SIM_NAOTERMINAL(NT_PROGRAM));
+
+    int token = yylex(); // 0 ja e T_EOF.
+    int aceito = 0;
+    for (;;) {
+        int topo = pilha.data[pilha.topo];
+        if (topo == SIM_FIM) {
+            aceito = token == T_EOF;
+            break;
+        }
+        if (E_TERMINAL(topo)) {
+            if (topo != token)
+                break;
+            pilha.topo--;
+            token = yylex();
+        } else {
+            int p = tabela_analise[topo - NUM_TOKENS][token];
+            if (p < 0)
+                break;
+            pilha.topo--;
+            const Producao *prod = &producoes[p];
+            for (int i = prod->tam_corpo - 1; i >= 0; i--)
+                pilha_push(&pilha, prod->corpo[i]);
+        }
+    }
+
+    *pilha_reusada = pilha;
+    return aceito;
+}
+
+// Imprime o veredito final da analise. Retorna 1 se nao houve erros.
+int imprimir_veredito(int erros) {
+    saida_resultado(erros);
+    return erros == 0;
+}
+
+// Analisa a entrada do Flex com 'receptor' e retorna o numero de erros.
+static int analisar_entrada_flex(const ReceptorEventos *receptor) {
+    // Com --stats, o tempo dentro do lexer e separado do tempo do driver.
+    FonteTokens cronometrada = { fonte_flex_cronometrada, NULL };
+    const FonteTokens *fonte = estatisticas.ativas ? &cronometrada : &fonte_flex;
+    double lexico_antes = estatisticas.segundos[FASE_LEXICO];
+    double inicio = estatisticas_marcar();
+
+    Pilha pilha;
+    pilha_init(&pilha);
+    int erros = analisar_entrada(&pilha, fonte, receptor, nivel_saida >= NIVEL_DIAGNOSTICO);
+    pilha_liberar(&pilha);
+
+    estatisticas_fase(FASE_ANALISE, inicio);
+    estatisticas.segundos[FASE_ANALISE] -= estatisticas.segundos[FASE_LEXICO] - lexico_antes;
+    return erros;
+}
+
+// Executa a analise sintatica LL(1) da entrada, notificando 'receptor'
+// (pode ser NULL) a cada passo da derivacao, e imprime o veredito.
+int analisar_com_eventos(const ReceptorEventos *receptor) {
+    return imprimir_veredito(analisar_entrada_flex(receptor));
+}
+
+// Executa a analise sintatica LL(1) da entrada.
+int analisar() {
+    return analisar_com_eventos(NULL);
 }
 
 /* ==================
@@ -825,50 +1126,50 @@ const char* nonterm_name(int nt) {
 }
 
 void imprimir_conjuntos_first() {
-    printf("=============== FIRST ======================\n");
+    saida_printf("=============== FIRST ======================\n");
     for (int nt = 0; nt < NUM_NONTERMINALS; nt++) {
 
         // opcional: se não quiser mostrar o NT_MAIN_BLOCK, que não tem produções
 
-        printf("FIRST(%s) = { ", nonterm_name(nt));
+        saida_printf("FIRST(%s) = { ", nonterm_name(nt));
         int primeiro = 1;
 
         for (int t = 0; t < NUM_TOKENS; t++) {
             if (conjunto_first[nt][t]) {
-                if (!primeiro) printf(", ");
-                printf("%s", token_name(t));
+                if (!primeiro) saida_printf(", ");
+                saida_printf("%s", token_name(t));
                 primeiro = 0;
             }
         }
 
         // se é anulável, mostra ε
         if (anulavel[nt]) {
-            if (!primeiro) printf(", ");
-            printf("ε");
+            if (!primeiro) saida_printf(", ");
+            saida_printf("ε");
         }
 
-        printf(" }\n");
+        saida_printf(" }\n");
     }
-    printf("===========================================\n\n");
+    saida_printf("===========================================\n\n");
 }
 
 
 // Imprime o conjunto FOLLOW de cada Nao-Terminal.
 void imprimir_conjuntos_follow() {
-    printf("============================== FOLLOW ======================================\n");
+    saida_printf("============================== FOLLOW ======================================\n");
     for (int nt = 0; nt < NUM_NONTERMINALS; nt++) {
-        printf("FOLLOW(%s) = { ", nonterm_name(nt));
+        saida_printf("FOLLOW(%s) = { ", nonterm_name(nt));
         int firstPrinted = 0;
         for (int t = 0; t < NUM_TOKENS; t++) {
             if (conjunto_follow[nt][t]) {
-                if (firstPrinted) printf(", ");
-                printf("%s", token_name(t));
+                if (firstPrinted) saida_printf(", ");
+                saida_printf("%s", token_name(t));
                 firstPrinted = 1;
             }
         }
-        printf(" }\n");
+        saida_printf(" }\n");
     }
-    printf("============================================================================\n\n");
+    saida_printf("============================================================================\n\n");
 }
 
 // Imprime o conteudo de uma producao (regra da gramatica).
@@ -876,18 +1177,18 @@ void imprimir_producao(int p) {
     Producao *prod = &producoes[p];
     int A = prod->cabeca - NUM_TOKENS;
 
-    printf("%s -> ", nonterm_name(A));
+    saida_printf("%s -> ", nonterm_name(A));
 
     if (prod->tam_corpo == 0) {
-        printf("e");
+        saida_printf("e");
     } else {
         for (int i = 0; i < prod->tam_corpo; i++) {
             int sim = prod->corpo[i];
             if (E_TERMINAL(sim)) {
-                printf("%s ", token_name(sim));
+                saida_printf("%s ", token_name(sim));
             } else {
                 int B = sim - NUM_TOKENS;
-                printf("%s ", nonterm_name(B));
+                saida_printf("%s ", nonterm_name(B));
             }
         }
     }
@@ -896,45 +1197,652 @@ void imprimir_producao(int p) {
 
 // Imprime a tabela de analise sintatica LL(1).
 void imprimir_tabela_analise() {
-    printf("================================ TABELA LL(1) ================================\n");
+    saida_printf("================================ TABELA LL(1) ================================\n");
 
     for (int nt = 0; nt < NUM_NONTERMINALS; nt++) {
         for (int t = 0; t < NUM_TOKENS; t++) {
             int p = tabela_analise[nt][t];
             if (p >= 0) {
-                printf("M[%s, %s] = ", nonterm_name(nt), token_name(t));
+                saida_printf("M[%s, %s] = ", nonterm_name(nt), token_name(t));
                 imprimir_producao(p);
-                printf("  (p=%d)\n", p);
+                saida_printf("  (p=%d)\n", p);
             }
         }
     }
-    printf("==============================================================================\n");
+    saida_printf("==============================================================================\n");
 }
 
-// Funcao principal do programa.
-int main() {
-    inicializar_producoes();
-    calcular_anulaveis();
-    calcular_conjuntos_first();
-    calcular_conjuntos_follow();
-    construir_tabela_analise_ll1();
+/* ==================
+   Metricas da derivacao (exemplo de receptor de eventos)
+   ================== */
+
+// Contadores preenchidos pelos eventos; nenhuma alocacao durante a analise.
+typedef struct {
+    long expansoes[NUM_NONTERMINALS];
+    long terminais[NUM_TOKENS];
+    int profundidade;
+    int profundidade_maxima;
+} Metricas;
+
+static void metricas_entrar(void *contexto, int nt, int producao, int indice_token) {
+    Metricas *m = contexto;
+    (void)producao; (void)indice_token;
+    m->expansoes[nt]++;
+    if (++m->profundidade > m->profundidade_maxima)
+        m->profundidade_maxima = m->profundidade;
+}
+
+static void metricas_sair(void *contexto, int nt, int producao, int indice_token) {
+    Metricas *m = contexto;
+    (void)nt; (void)producao; (void)indice_token;
+    m->profundidade--;
+}
+
+static void metricas_casar(void *contexto, int token, int indice_token,
+                           const char *lexema, int tamanho) {
+    Metricas *m = contexto;
+    (void)indice_token; (void)lexema; (void)tamanho;
+    m->terminais[token]++;
+}
+
+void imprimir_metricas(const Metricas *m) {
+    saida_printf("================================ METRICAS ===================================\n");
+    for (int nt = 0; nt < NUM_NONTERMINALS; nt++)
+        if (m->expansoes[nt])
+            saida_printf("NT %-20s expansoes: %ld\n", nonterm_name(nt), m->expansoes[nt]);
+    for (int t = 0; t < NUM_TOKENS; t++)
+        if (m->terminais[t])
+            saida_printf("Token %-17s casamentos: %ld\n", token_name(t), m->terminais[t]);
+    saida_printf("Profundidade maxima da derivacao: %d\n", m->profundidade_maxima);
+    saida_printf("=============================================================================\n");
+}
+
+// Lista o tipo anotado em cada token que representa uma expressao.
+static void imprimir_tipos(const AnalisadorSemantico *semantica) {
+    saida_printf("================================ TIPOS ======================================\n");
+    for (int i = 0; i < quantidade_tokens_lidos; i++) {
+        TipoDado tipo = semantica_tipo_token(semantica, i);
+        if (tipo != TIPO_INDEFINIDO)
+            saida_printf("Token %-6d %-12s tipo: %s\n", i, tokens_armazenados[i].lexema,
+                         nome_tipo(tipo));
+    }
+    saida_printf("=============================================================================\n");
+}
+
+// Le todo o conteudo de 'arquivo' para um buffer alocado (terminado em '\0').
+char *ler_fluxo_inteiro(FILE *arquivo, size_t *tamanho) {
+    size_t capacidade = 65536, lidos = 0;
+    char *buffer = malloc(capacidade);
+    while (buffer) {
+        if (capacidade - lidos < 2) {
+            char *maior = realloc(buffer, capacidade * 2);
+            if (!maior) {
+                free(buffer);
+                buffer = NULL;
+                break;
+            }
+            buffer = maior;
+            capacidade *= 2;
+        }
+        size_t n = fread(buffer + lidos, 1, capacidade - lidos - 1, arquivo);
+        if (n == 0)
+            break;
+        lidos += n;
+    }
+    if (!buffer) {
+        fprintf(stderr, "Erro: memoria insuficiente para ler a entrada.\n");
+        exit(1);
+    }
+    buffer[lidos] = '\0';
+    *tamanho = lidos;
+    return buffer;
+}
+
+/* ==================
+   Modo lote: varios arquivos num so processo
+   ================== */
+
+// Valida um arquivo reaproveitando a pilha e o buffer do lexer, e imprime
+// uma linha de veredito. Retorna 1 se o arquivo esta correto.
+int analisar_arquivo_lote(const char *caminho, Pilha *pilha) {
+    FILE *arquivo = fopen(caminho, "r");
+    if (!arquivo) {
+        printf("%s: ERRO (nao foi possivel abrir)\n", caminho);
+        return 0;
+    }
+
+    yyrestart(arquivo);          // Reusa o buffer atual do Flex.
+    quantidade_tokens_lidos = 0; // Reusa o armazenamento de tokens.
+    int erros = analisar_entrada(pilha, &fonte_flex, NULL, 0);
+    fclose(arquivo);
+
+    if (erros == 0)
+        printf("%s: OK\n", caminho);
+    else
+        printf("%s: ERRO (%d erro(s) sintatico(s))\n", caminho, erros);
+    return erros == 0;
+}
+
+// Lista dinamica de caminhos a validar (argumentos e manifesto).
+typedef struct {
+    char **itens;
+    int quantidade;
+    int capacidade;
+} ListaCaminhos;
+
+void lista_caminhos_adicionar(ListaCaminhos *l, char *caminho) {
+    if (l->quantidade == l->capacidade) {
+        int nova = l->capacidade ? l->capacidade * 2 : 64;
+        char **itens = realloc(l->itens, (size_t)nova * sizeof(char *));
+        if (!itens) {
+            fprintf(stderr, "Erro: memoria insuficiente para a lista de arquivos.\n");
+            exit(1);
+        }
+        l->itens = itens;
+        l->capacidade = nova;
+    }
+    l->itens[l->quantidade++] = caminho;
+}
+
+// Le os caminhos de um manifesto (um por linha; "-" le da entrada padrao).
+// Retorna 0 se o manifesto nao pode ser aberto.
+int ler_manifesto(const char *manifesto, ListaCaminhos *l) {
+    FILE *lista = strcmp(manifesto, "-") == 0 ? stdin : fopen(manifesto, "r");
+    if (!lista) {
+        fprintf(stderr, "Erro: nao foi possivel abrir o manifesto '%s'.\n", manifesto);
+        return 0;
+    }
+
+    char linha[4096];
+    while (fgets(linha, sizeof(linha), lista)) {
+        size_t n = strcspn(linha, "\r\n");
+        linha[n] = '\0';
+        if (n == 0)
+            continue;
+        char *copia = malloc(n + 1);
+        if (!copia) {
+            fprintf(stderr, "Erro: memoria insuficiente para a lista de arquivos.\n");
+            exit(1);
+        }
+        memcpy(copia, linha, n + 1);
+        lista_caminhos_adicionar(l, copia);
+    }
+
+    if (lista != stdin)
+        fclose(lista);
+    return 1;
+}
+
+// Analisa 'caminho' repetidamente por ~0,5 s com o caminho atual
+// (analisar_entrada sobre fonte_flex, que guarda os tokens) ou com o
+// reconhecedor fundido. Retorna segundos por analise, ou -1 se nao abriu.
+static double medir_caminho(const char *caminho, int fundido, Pilha *pilha, int *aceito) {
+    int repeticoes = 0;
+    double inicio = relogio_monotonico(), decorrido;
+    do {
+        FILE *arquivo = fopen(caminho, "r");
+        if (!arquivo)
+            return -1;
+        yyrestart(arquivo);
+        quantidade_tokens_lidos = 0;
+        *aceito = fundido ? reconhecer(pilha) : analisar_entrada(pilha, &fonte_flex, NULL, 0) == 0;
+        fclose(arquivo);
+        repeticoes++;
+        decorrido = relogio_monotonico() - inicio;
+    } while (decorrido < 0.5 || repeticoes < 3);
+    return decorrido / repeticoes;
+}
+
+// Compara o caminho atual com o reconhecedor fundido sobre o mesmo arquivo.
+int comparar_reconhecedor(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "r");
+    if (!arquivo) {
+        fprintf(stderr, "Erro: nao foi possivel abrir '%s'.\n", caminho);
+        return 2;
+    }
+    fseek(arquivo, 0, SEEK_END);
+    double megabytes = (double)ftell(arquivo) / 1e6;
+    fclose(arquivo);
+
+    Pilha pilha;
+    pilha_init(&pilha);
+    int aceito_atual, aceito_fundido;
+    double atual = medir_caminho(caminho, 0, &pilha, &aceito_atual);
+    double fundido = medir_caminho(caminho, 1, &pilha, &aceito_fundido);
+    pilha_liberar(&pilha);
+
+    printf("Arquivo: %s (%.2f MB)\n", caminho, megabytes);
+    printf("Caminho atual (log de tokens):  %10.3f ms/analise  %8.1f MB/s  [%s]\n",
+           atual * 1e3, megabytes / atual, aceito_atual ? "OK" : "ERRO");
+    printf("Reconhecedor fundido:           %10.3f ms/analise  %8.1f MB/s  [%s]\n",
+           fundido * 1e3, megabytes / fundido, aceito_fundido ? "OK" : "ERRO");
+    printf("Aceleracao: %.2fx\n", atual / fundido);
+    return aceito_atual == aceito_fundido ? 0 : 1;
+}
+
+// Lexa 'caminho' com o scanner do Flex (lexer.l) e com o lexer reentrante
+// e compara os tokens um a um: os dois devem reconhecer a mesma linguagem.
+// Retorna 0 se concordam, 1 na primeira divergencia.
+static int conferir_lexer(const char *caminho) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo) {
+        fprintf(stderr, "Erro: nao foi possivel abrir '%s'.\n", caminho);
+        return 2;
+    }
+    size_t tamanho;
+    char *texto = ler_fluxo_inteiro(arquivo, &tamanho);
+    if (!texto) {
+        fprintf(stderr, "Erro: memoria insuficiente para ler '%s'.\n", caminho);
+        fclose(arquivo);
+        return 2;
+    }
+    rewind(arquivo);
+    yyrestart(arquivo);
+
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, texto, tamanho);
+    lx.relatar_erros = 0; // O Flex ja relata os caracteres invalidos.
+    long tokens = 0;
+    int divergiu = 0;
+    for (;;) {
+        int flex = yylex(); // 0 ja e T_EOF.
+        int reentrante = lexer_r_proximo(&lx);
+        int tamanho_flex = flex == T_EOF ? 0 : yyleng;
+        if (flex != reentrante || tamanho_flex != lx.tamanho ||
+            memcmp(yytext, lx.lexema, (size_t)lx.tamanho) != 0) {
+            printf("%s: token %ld (linha %d) diverge: Flex %s '%.*s', reentrante %s '%.*s'\n",
+                   caminho, tokens + 1, lx.linha, token_name(flex), tamanho_flex, yytext,
+                   token_name(reentrante), lx.tamanho, lx.lexema);
+            divergiu = 1;
+            break;
+        }
+        if (flex == T_EOF)
+            break;
+        tokens++;
+    }
+    if (!divergiu)
+        printf("%s: %ld tokens iguais nos dois lexers\n", caminho, tokens);
+    fclose(arquivo);
+    free(texto);
+    return divergiu;
+}
+
+// Le a entrada padrao inteira, contando o tempo e os bytes para --stats.
+static char *ler_entrada_medida(size_t *tamanho) {
+    double inicio = estatisticas_marcar();
+    char *texto = ler_fluxo_inteiro(stdin, tamanho);
+    estatisticas_fase(FASE_LEITURA, inicio);
+    estatisticas.bytes = (long)*tamanho;
+    return texto;
+}
+
+// Analisa o programa da entrada padrao no modo escolhido, escrevendo pelo
+// buffer de saida. Retorna o codigo de saida do processo.
+static int analisar_programa_unico(int num_fatias, int tam_lote, int tam_pedaco,
+                                   int modo_reconhecer, int modo_metricas, int modo_semantico) {
+    int relatar = nivel_saida >= NIVEL_DIAGNOSTICO;
+
+    if (num_fatias >= 0) {
+        // Um arquivo grande: lexico e analise divididos entre threads.
+        size_t tamanho;
+        char *texto = ler_entrada_medida(&tamanho);
+        double inicio = estatisticas_marcar();
+        int erros = analisar_em_fatias(texto, tamanho, num_fatias, relatar);
+        estatisticas_fase(FASE_ANALISE, inicio);
+        free(texto);
+        return imprimir_veredito(erros) ? 0 : 1;
+    }
+
+    if (tam_lote >= 0) {
+        // Lexico e analise em threads separadas, ligadas por um anel.
+        size_t tamanho;
+        char *texto = ler_entrada_medida(&tamanho);
+        double inicio = estatisticas_marcar();
+        int erros = analisar_em_pipeline(texto, tamanho, tam_lote, relatar);
+        estatisticas_fase(FASE_ANALISE, inicio);
+        free(texto);
+        return imprimir_veredito(erros) ? 0 : 1;
+    }
+
+    if (tam_pedaco > 0) {
+        // Entrada em pedacos de 'tam_pedaco' bytes, como chegaria da rede.
+        char *pedaco = malloc((size_t)tam_pedaco);
+        if (!pedaco) {
+            fprintf(stderr, "Erro: memoria insuficiente para a analise empurrada.\n");
+            return 2;
+        }
+        AnalisadorEmpurrado analisador;
+        empurrado_iniciar(&analisador, NULL, relatar);
+        double inicio = estatisticas_marcar();
+        size_t n;
+        estatisticas.bytes = 0;
+        while ((n = fread(pedaco, 1, (size_t)tam_pedaco, stdin)) > 0) {
+            estatisticas.bytes += (long)n;
+            if (empurrado_alimentar(&analisador, pedaco, n) == EMPURRADO_TERMINOU)
+                break;
+        }
+        int erros = empurrado_finalizar(&analisador);
+        estatisticas_fase(FASE_ANALISE, inicio);
+        empurrado_liberar(&analisador);
+        free(pedaco);
+        return imprimir_veredito(erros) ? 0 : 1;
+    }
+
+    if (modo_reconhecer) {
+        // So o veredito: nenhum token e copiado nem guardado.
+        Pilha pilha;
+        pilha_init(&pilha);
+        double inicio = estatisticas_marcar();
+        int aceito = reconhecer(&pilha);
+        estatisticas_fase(FASE_ANALISE, inicio);
+        pilha_liberar(&pilha);
+        return imprimir_veredito(aceito ? 0 : 1) ? 0 : 1;
+    }
+
+    if (modo_metricas) {
+        // Apenas observa a derivacao: sem listagem de tokens nem tabelas.
+        static Metricas metricas;
+        ReceptorEventos receptor = { metricas_entrar, metricas_sair, metricas_casar, NULL, &metricas };
+        int ok = analisar_com_eventos(&receptor);
+        if (formato_saida == FORMATO_TEXTO)
+            imprimir_metricas(&metricas);
+        return ok ? 0 : 1;
+    }
+
+    if (modo_semantico) {
+        // Declaracoes verificadas na mesma passada, pelos eventos.
+        AnalisadorSemantico semantica;
+        semantica_iniciar(&semantica);
+        ReceptorEventos receptor = semantica_receptor(&semantica);
+        int erros = analisar_entrada_flex(&receptor);
+        int codigo;
+        if (erros) {
+            codigo = imprimir_veredito(erros) ? 0 : 1;
+        } else {
+            codigo = semantica_relatar(&semantica, relatar) ? 1 : 0;
+            if (nivel_saida == NIVEL_DEPURACAO && formato_saida == FORMATO_TEXTO)
+                imprimir_tipos(&semantica);
+        }
+        semantica_liberar(&semantica);
+        return codigo;
+    }
+
     if (!analisar()) {
         // Retorna 1 se houve erro sintatico.
         return 1;
     }
+    if (nivel_saida < NIVEL_DEPURACAO || formato_saida != FORMATO_TEXTO)
+        return 0;
+    double inicio = estatisticas_marcar();
+
     // Se a analise foi bem-sucedida, lista os tokens processados.
-    printf("================================ TOKENS LIDOS ===============================\n");
+    saida_printf("================================ TOKENS LIDOS ===============================\n");
     for (int i = 0; i < quantidade_tokens_lidos; i++) {
-        printf("Token: %-12s Lexema: %s\n",
-               token_name(tokens_armazenados[i].tipo),
-               tokens_armazenados[i].lexema);
+        saida_printf("Token: %-12s Lexema: %s\n",
+                     token_name(tokens_armazenados[i].tipo),
+                     tokens_armazenados[i].lexema);
     }
-    printf("=============================================================================\n");
+    saida_printf("=============================================================================\n");
     /* Visualizacao*/
-/* Visualizacao*/
     imprimir_conjuntos_first();
     imprimir_conjuntos_follow();
     imprimir_tabela_analise();
-    
+    estatisticas_fase(FASE_SAIDA, inicio);
     return 0;
+}
+
+// Nomes aceitos por --nivel e --formato, na ordem dos enums de saida.h.
+static const char *const nomes_niveis[] = { "silencioso", "diagnostico", "depuracao", NULL };
+static const char *const nomes_formatos[] = { "texto", "json", "binario", NULL };
+
+// Posicao de 'nome' em 'opcoes' (terminada em NULL), ou -1.
+static int indice_da_opcao(const char *nome, const char *const *opcoes) {
+    for (int i = 0; opcoes[i]; i++)
+        if (strcmp(nome, opcoes[i]) == 0)
+            return i;
+    return -1;
+}
+
+// Opcoes que compilam um programa e escolhem o que fazer com o bytecode.
+// 'argumentos' conta o arquivo do programa e, se houver, o binario.
+typedef struct {
+    const char *nome;
+    ModoExecucao modo;
+    int argumentos;
+} OpcaoExecucao;
+
+static const OpcaoExecucao opcoes_execucao[] = {
+    { "--executar",       EXECUCAO_RODAR,      1 },
+    { "--bytecode",       EXECUCAO_LISTAR,     1 },
+    { "--medir-execucao", EXECUCAO_MEDIR,      1 },
+    { "--assembly",       EXECUCAO_ASSEMBLY,   1 },
+    { "--nativo",         EXECUCAO_NATIVO,     2 },
+    { "--codigo-c",       EXECUCAO_C,          1 },
+    { "--compilar-c",     EXECUCAO_COMPILAR_C, 2 },
+    { "--conferir-c",     EXECUCAO_CONFERIR_C, 1 },
+    { "--cfg",            EXECUCAO_CFG,        1 },
+    { "--ssa",            EXECUCAO_SSA,        1 },
+    { NULL,               EXECUCAO_RODAR,      0 },
+};
+
+static const OpcaoExecucao *opcao_execucao(const char *nome) {
+    for (const OpcaoExecucao *o = opcoes_execucao; o->nome; o++)
+        if (strcmp(nome, o->nome) == 0)
+            return o;
+    return NULL;
+}
+
+// Funcao principal do programa.
+int main(int argc, char **argv) {
+    double inicio_execucao = relogio_monotonico();
+    int modo_perfil = 0;
+    int modo_metricas = 0;
+    int modo_semantico = 0;
+    int modo_lote = 0;
+    int num_threads = -1;           // -1 = sequencial; 0 = um por nucleo.
+    int modo_escalabilidade = 0;
+    int num_fatias = -1;            // -1 = analise sequencial da entrada.
+    const char *socket_servidor = NULL;
+    const char *arquivo_incremental = NULL;
+    int conferir = 0;
+    int modo_reconhecer = 0;
+    int tam_lote = -1;              // -1 = lexico e analise na mesma thread.
+    int medir_pipe = 0;
+    int tam_pedaco = 0;             // > 0 = analise empurrada em pedacos.
+    const char *arquivo_comparacao = NULL;
+    const char *arquivo_lexer = NULL;
+    int modo_gerar = 0;
+    const char *arquivo_execucao = NULL;
+    OpcoesExecucao execucao = { EXECUCAO_RODAR, 0, 1, 1, 1, NULL };
+    int modo_pares = 0;
+    ConfigGerador gerador;
+    gerador_config_padrao(&gerador);
+    ListaCaminhos arquivos = { NULL, 0, 0 };
+    int valor;
+    const OpcaoExecucao *opcao;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--metricas") == 0) {
+            modo_metricas = 1;
+        } else if (strcmp(argv[i], "--semantico") == 0) {
+            modo_semantico = 1;
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            estatisticas.ativas = 1;
+        } else if (strcmp(argv[i], "--perfil") == 0) {
+            if (!PERFIL_DISPONIVEL) {
+                fprintf(stderr, "Erro: --perfil exige um binario compilado com -DPERFIL_GRAMATICA.\n");
+                return 2;
+            }
+            modo_perfil = 1;
+        } else if (strcmp(argv[i], "--lista") == 0 && i + 1 < argc) {
+            if (!ler_manifesto(argv[++i], &arquivos))
+                return 2;
+            modo_lote = 1;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc) {
+            socket_servidor = argv[++i];
+        } else if (strcmp(argv[i], "--fatias") == 0 && i + 1 < argc) {
+            num_fatias = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc) {
+            tam_lote = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--empurrado") == 0 && i + 1 < argc) {
+            tam_pedaco = atoi(argv[++i]);
+            if (tam_pedaco <= 0)
+                tam_pedaco = 4096;
+        } else if (strcmp(argv[i], "--medir-pipeline") == 0) {
+            medir_pipe = 1;
+        } else if (strcmp(argv[i], "--reconhecer") == 0) {
+            modo_reconhecer = 1;
+        } else if (strcmp(argv[i], "--comparar-reconhecedor") == 0 && i + 1 < argc) {
+            arquivo_comparacao = argv[++i];
+        } else if (strcmp(argv[i], "--conferir-lexer") == 0 && i + 1 < argc) {
+            arquivo_lexer = argv[++i];
+        } else if (strcmp(argv[i], "--incremental") == 0 && i + 1 < argc) {
+            arquivo_incremental = argv[++i];
+        } else if (strcmp(argv[i], "--conferir") == 0) {
+            conferir = 1;
+        } else if (strcmp(argv[i], "--nivel") == 0 && i + 1 < argc &&
+                   (valor = indice_da_opcao(argv[i + 1], nomes_niveis)) >= 0) {
+            nivel_saida = (NivelSaida)valor;
+            i++;
+        } else if (strcmp(argv[i], "--formato") == 0 && i + 1 < argc &&
+                   (valor = indice_da_opcao(argv[i + 1], nomes_formatos)) >= 0) {
+            formato_saida = (FormatoSaida)valor;
+            i++;
+        } else if (strcmp(argv[i], "--gerar") == 0 && i + 1 < argc &&
+                   (gerador.tamanho_alvo = gerador_ler_tamanho(argv[i + 1])) >= 0) {
+            modo_gerar = 1;
+            i++;
+        } else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) {
+            gerador.semente = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--profundidade") == 0 && i + 1 < argc) {
+            gerador.profundidade_maxima = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--largura") == 0 && i + 1 < argc) {
+            gerador.largura_maxima = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--peso") == 0 && i + 1 < argc &&
+                   gerador_ajustar_peso(&gerador, argv[i + 1])) {
+            i++;
+        } else if ((opcao = opcao_execucao(argv[i])) != NULL && i + opcao->argumentos < argc) {
+            execucao.modo = opcao->modo;
+            arquivo_execucao = argv[++i];
+            if (opcao->argumentos == 2)
+                execucao.binario = argv[++i];
+        } else if (strcmp(argv[i], "--uma-passada") == 0) {
+            execucao.uma_passada = 1;
+        } else if (strcmp(argv[i], "--sem-sccp") == 0) {
+            execucao.otimizar = 0;
+        } else if (strcmp(argv[i], "--sem-fusao") == 0) {
+            execucao.fundir = 0;
+        } else if (strcmp(argv[i], "--sem-jit") == 0) {
+            execucao.jit = 0;
+        } else if (strcmp(argv[i], "--perfil-pares") == 0) {
+            // O restante dos argumentos sao os programas.
+            for (i++; i < argc; i++)
+                lista_caminhos_adicionar(&arquivos, argv[i]);
+            modo_pares = 1;
+        } else if (strcmp(argv[i], "--escalabilidade") == 0) {
+            modo_escalabilidade = 1;
+        } else if (strcmp(argv[i], "--lote") == 0) {
+            // O restante dos argumentos sao os arquivos.
+            for (i++; i < argc; i++)
+                lista_caminhos_adicionar(&arquivos, argv[i]);
+            modo_lote = 1;
+        } else {
+            fprintf(stderr,
+                    "Uso: %s [--metricas | --semantico | --fatias N | --pipeline L | --empurrado B | --reconhecer]\n"
+                    "        [--nivel silencioso|diagnostico|depuracao] [--formato texto|json|binario]\n"
+                    "        [--stats] [--perfil] < programa.cmini\n"
+                    "     %s [--threads N] [--escalabilidade] [--perfil] [--lista manifesto] [--lote arquivo...]\n"
+                    "     %s --servidor caminho.sock\n"
+                    "     %s --incremental arquivo [--conferir] < edicoes\n"
+                    "     %s --comparar-reconhecedor arquivo | --conferir-lexer arquivo\n"
+                    "     %s --medir-pipeline < programa.cmini\n"
+                    "     %s --gerar TAMANHO[K|M|G] [--semente S] [--profundidade D] [--largura L]\n"
+                    "        [--peso producao=peso]... > programa.cmini\n"
+                    "     %s [--uma-passada] [--sem-sccp] [--sem-fusao] [--sem-jit] --executar|--bytecode|--medir-execucao programa.cmini\n"
+                    "     %s [--uma-passada] [--sem-sccp] [--sem-fusao] --assembly programa.cmini | --nativo programa.cmini binario\n"
+                    "     %s [--uma-passada] [--sem-sccp] [--sem-fusao] --codigo-c programa.cmini | --compilar-c programa.cmini binario\n"
+                    "     %s [--uma-passada] [--sem-sccp] [--sem-fusao] --conferir-c programa.cmini < entrada\n"
+                    "     %s [--uma-passada] [--sem-sccp] [--sem-fusao] --cfg programa.cmini | --ssa programa.cmini\n"
+                    "     %s [--uma-passada] [--sem-sccp] [--sem-fusao] --perfil-pares programa.cmini...\n",
+                    argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0],
+                    argv[0], argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    preparar_gramatica();
+
+    if (socket_servidor)
+        return executar_servidor(socket_servidor);
+
+    if (modo_gerar)
+        return gerar_programa(&gerador, stdout) < 0 ? 1 : 0;
+
+    if (arquivo_execucao)
+        return executar_arquivo(arquivo_execucao, &execucao);
+
+    if (modo_pares)
+        return perfilar_pares(arquivos.itens, arquivos.quantidade, &execucao);
+
+    if (arquivo_incremental)
+        return executar_edicoes(arquivo_incremental, conferir);
+
+    if (arquivo_comparacao)
+        return comparar_reconhecedor(arquivo_comparacao);
+
+    if (arquivo_lexer)
+        return conferir_lexer(arquivo_lexer);
+
+    if (modo_lote) {
+        // Tabelas construidas uma vez; pilha e buffers reaproveitados.
+        int falhas = 0;
+        if (modo_escalabilidade) {
+            medir_escalabilidade(arquivos.itens, arquivos.quantidade,
+                                 num_threads > 0 ? num_threads : 0);
+            return 0;
+        } else if (num_threads >= 0) {
+            falhas = verificar_corpus_paralelo(arquivos.itens, arquivos.quantidade, num_threads);
+        } else {
+            Pilha pilha;
+            pilha_init(&pilha);
+            for (int i = 0; i < arquivos.quantidade; i++)
+                if (!analisar_arquivo_lote(arquivos.itens[i], &pilha))
+                    falhas++;
+            pilha_liberar(&pilha);
+        }
+        printf("Total: %d arquivo(s), %d com erro.\n", arquivos.quantidade, falhas);
+        if (modo_perfil) {
+            fflush(stdout);
+            perfil_imprimir(stderr);
+        }
+        return falhas ? 1 : 0;
+    }
+
+    if (medir_pipe) {
+        size_t tamanho;
+        char *texto = ler_fluxo_inteiro(stdin, &tamanho);
+        medir_pipeline(texto, tamanho);
+        free(texto);
+        return 0;
+    }
+
+    // Um unico programa: toda a saida vai para o buffer e e escrita no fim.
+    if (estatisticas.ativas) {
+        // No caminho do Flex o tamanho so e conhecido se a entrada e um arquivo.
+        struct stat st;
+        if (fstat(STDIN_FILENO, &st) == 0 && S_ISREG(st.st_mode))
+            estatisticas.bytes = (long)st.st_size;
+    }
+    int codigo = analisar_programa_unico(num_fatias, tam_lote, tam_pedaco,
+                                         modo_reconhecer, modo_metricas, modo_semantico);
+    double inicio_escrita = estatisticas_marcar();
+    if (!saida_descarregar())
+        codigo = 2;
+    estatisticas_fase(FASE_SAIDA, inicio_escrita);
+    if (estatisticas.ativas)
+        estatisticas_imprimir_json(stderr, relogio_monotonico() - inicio_execucao, codigo);
+    if (modo_perfil)
+        perfil_imprimir(stderr);
+    return codigo;
 }
\ No newline at end of file
@@ -0,0 +1,204 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <stdio.h>
+#include "tokens.h"
+#include "lexer_reentrante.h"
+
+/* ============================================
+   Nao-Terminais (Estruturas Sintaticas)
+   ============================================ */
+
+// Enumeracao de todos os simbolos Nao-Terminais da gramatica.
+typedef enum {
+    NT_PROGRAM = 0,
+    NT_MAIN_FUNC,
+    NT_LISTA_COMANDOS,
+    NT_COMANDO,
+    NT_BLOCO,
+    NT_DECLARACAO_VAR,
+    NT_DECL_VAR_CAUDA,
+    NT_ATRIBUICAO,
+    NT_COMANDO_LEITURA,
+    NT_COMANDO_ESCRITA,
+    NT_COMANDO_RETORNO,
+    NT_COMANDO_SE,
+    NT_ELSE_OPCIONAL,
+    NT_COMANDO_ENQUANTO,
+    NT_COMANDO_PARA,
+    NT_ATRIBUICAO_SIMPLES,
+    NT_EXPR_BOOLEANA,
+    NT_EXPR_BOOL_RESTO,
+    NT_TERMO_BOOL,
+    NT_EXPR_RELACIONAL,
+    NT_EXPR_REL_RESTO,
+    NT_EXPR_ARITMETICA,
+    NT_EXPR_ARIT_RESTO,
+    NT_TERMO,
+    NT_TERMO_RESTO,
+    NT_FATOR,
+    NUM_NONTERMINALS
+} NonTerminal;
+
+/* Simbolos especiais da pilha de analise */
+#define EPSILON   (-1) // Simbolo para a producao vazia (epsilon)
+#define SIM_FIM   (-2) // Marcador de fundo da pilha/fim da entrada
+
+/* Mapeamento de simbolos: Terminais e Nao-Terminais */
+#define SIM_TERMINAL(t)   (t)
+#define SIM_NAOTERMINAL(nt)   (NUM_TOKENS + (nt))
+
+#define E_TERMINAL(sim)  ((sim) >= 0 && (sim) < NUM_TOKENS)
+#define E_NAOTERMINAL(sim)   ((sim) >= NUM_TOKENS)
+
+/* =======================
+   Producoes da Gramatica (Regras de Substituicao)
+   ======================= */
+
+#define MAX_RHS 8
+#define NUM_PRODUCTIONS 46
+
+// Estrutura para uma regra de producao (Cabeça -> Corpo).
+typedef struct {
+    int cabeca;              // Nao-Terminal (LHS)
+    int corpo[MAX_RHS];     // Sequencia de simbolos (RHS)
+    int tam_corpo;          // Tamanho da sequencia RHS
+} Producao;
+
+// Regras da gramatica e tabela LL(1): preenchidas uma vez por
+// preparar_gramatica() e somente lidas depois (seguras entre threads).
+extern Producao producoes[NUM_PRODUCTIONS];
+extern int tabela_analise[NUM_NONTERMINALS][NUM_TOKENS];
+// 1 para Nao-Terminais que sao listas recursivas a direita (LISTA_COMANDOS,
+// EXPR_ARIT_RESTO, ...), que a arvore sintatica achata.
+extern int lista_recursiva[NUM_NONTERMINALS];
+
+// Inicializa producoes, conjuntos FIRST/FOLLOW/sincronizacao e a tabela LL(1).
+void preparar_gramatica(void);
+
+/* ==================
+   Pilha de analise
+   ================== */
+
+// Estrutura de Pilha usada para simular a derivacao.
+// Cresce por duplicacao, entao a alocacao e amortizada (nunca por simbolo).
+typedef struct {
+    int *data;
+    int capacidade;
+    int topo; // Indice do topo da pilha.
+} Pilha;
+
+void pilha_init(Pilha *s);
+void pilha_liberar(Pilha *s);
+void pilha_push(Pilha *s, int v);
+int pilha_pop(Pilha *s);
+int pilha_peek(Pilha *s);
+
+/* ============================================
+   Eventos da Analise (interface estilo SAX)
+   ============================================ */
+
+// Receptor de eventos da derivacao, para ferramentas que so observam a
+// analise (metricas, linters) sem construir arvore. Qualquer callback pode
+// ser NULL. Nenhum evento aloca memoria: os dados vao direto nos argumentos.
+//   entrar_nt:      NT expandido pela producao 'producao' (indice em 'producoes'),
+//                   'indice_token' e o lookahead no momento da expansao.
+//   sair_nt:        derivacao do NT terminou; 'indice_token' e o primeiro
+//                   token depois dela.
+//   casar_terminal: token 'indice_token' casou com o topo da pilha. O lexema
+//                   aponta para o buffer do lexer e so vale durante a chamada.
+//   recuperar:      passo de recuperacao de erro com o lookahead
+//                   'indice_token' (terminal inserido, NT descartado, token
+//                   descartado ou tokens restantes); 'contado' diz se o erro
+//                   entrou na contagem ou caiu no silencio depois de outro.
+typedef struct {
+    void (*entrar_nt)(void *contexto, int nt, int producao, int indice_token);
+    void (*sair_nt)(void *contexto, int nt, int producao, int indice_token);
+    void (*casar_terminal)(void *contexto, int token, int indice_token, const char *lexema, int tamanho);
+    void (*recuperar)(void *contexto, int indice_token, int contado);
+    void *contexto;
+} ReceptorEventos;
+
+/* ============================================
+   Fonte de Tokens
+   ============================================ */
+
+// De onde o driver tira os tokens: 'proximo' devolve o tipo do proximo
+// token (T_EOF no fim) e aponta 'lexema'/'tamanho' para o seu texto, que so
+// precisa valer ate a chamada seguinte. Todo o estado fica em 'dados'.
+typedef struct {
+    int (*proximo)(void *dados, const char **lexema, int *tamanho);
+    void *dados;
+} FonteTokens;
+
+// Fonte que le do Flex (yylex/yyin) e registra os tokens em tokens_armazenados.
+extern const FonteTokens fonte_flex;
+// Fonte sobre um lexer reentrante; nao guarda tokens (cada thread tem a sua).
+FonteTokens fonte_lexer_reentrante(LexerReentrante *lx);
+
+/* ==============
+   Analise Sintatica
+   ============== */
+
+/* Recuperacao de erros em modo panico: depois de um erro, novos erros so sao
+   reportados apos ERROS_TOKENS_SILENCIO casamentos, o que limita cascatas. */
+#define MAX_ERROS_SINTATICOS   100
+#define ERROS_TOKENS_SILENCIO  3
+
+// Analisa um programa completo lido de 'fonte'; retorna o numero de erros.
+// A pilha e reaproveitada entre chamadas (so e esvaziada, nunca liberada).
+int analisar_entrada(Pilha *pilha_reusada, const FonteTokens *fonte,
+                     const ReceptorEventos *receptor, int relatar_erros);
+// Como analisar_entrada, mas a pilha comeca com SIM_FIM seguido de
+// 'simbolos_iniciais' (do fundo para o topo), p. ex. so uma LISTA_COMANDOS.
+int analisar_entrada_desde(Pilha *pilha_reusada, const int *simbolos_iniciais, int num_iniciais,
+                           const FonteTokens *fonte, const ReceptorEventos *receptor,
+                           int relatar_erros);
+// Reconhece uma unica ocorrencia de 'simbolo_inicial' no comeco de 'fonte',
+// sem exigir o fim da entrada e sem recuperacao de erros. Em caso de sucesso
+// retorna 0 e guarda em 'consumidos' quantos tokens foram usados (o
+// lookahead final nao conta); no primeiro erro retorna 1.
+int analisar_prefixo(Pilha *pilha_reusada, int simbolo_inicial, const FonteTokens *fonte,
+                     const ReceptorEventos *receptor, int *consumidos);
+
+// Estado do driver LL(1) entre um token e o seguinte. Permite dirigir a
+// analise empurrando um token por vez, em vez de puxar de uma FonteTokens.
+typedef struct {
+    Pilha pilha;
+    const ReceptorEventos *receptor;
+    int emitir_saida;
+    int relatar_erros;
+    int prefixo;
+    int erros;
+    int casados_desde_erro;
+    int indice_token;       // Indice do lookahead atual.
+    int terminou;
+    long expansoes;         // Contadores para --stats.
+    long casamentos;
+    int topo_maximo;
+} EstadoAnalise;
+
+// Comeca uma analise em 'e' a partir de 'simbolos_iniciais' (ver
+// analisar_entrada_desde). Com 'prefixo', para quando a pilha esvazia ou no
+// primeiro erro (ver analisar_prefixo).
+void analise_iniciar(EstadoAnalise *e, Pilha *pilha_reusada, const int *simbolos_iniciais,
+                     int num_iniciais, const ReceptorEventos *receptor, int relatar_erros,
+                     int prefixo);
+// Entrega o proximo token. Retorna 0 se a analise quer mais tokens e 1 se
+// ja terminou (depois disso os tokens sao ignorados). O fim da entrada e
+// entregue como T_EOF, repetido ate o retorno ser 1.
+int analise_token(EstadoAnalise *e, int token, const char *lexema, int tamanho);
+// Devolve a pilha para reuso e retorna o numero de erros sintaticos.
+int analise_concluir(EstadoAnalise *e, Pilha *pilha_reusada);
+// Reconhecedor fundido com o Flex: so o veredito, para no primeiro erro.
+// Retorna 1 se a entrada e um programa correto.
+int reconhecer(Pilha *pilha_reusada);
+// Imprime "Sucesso" ou o total de erros. Retorna 1 se nao houve erros.
+int imprimir_veredito(int erros);
+// Le todo o conteudo de 'arquivo' para um buffer alocado (terminado em '\0').
+char *ler_fluxo_inteiro(FILE *arquivo, size_t *tamanho);
+
+const char* token_name(int token);
+const char* nonterm_name(int nt);
+
+#endif
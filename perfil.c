@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "perfil.h"
+
+#ifdef PERFIL_GRAMATICA
+#include <pthread.h>
+
+_Thread_local long perfil_expansoes[NUM_PRODUCTIONS];
+_Thread_local long perfil_consultas[NUM_NONTERMINALS][NUM_TOKENS];
+
+// Totais das threads ja juntadas; o mutex so e tomado uma vez por thread.
+static long total_expansoes[NUM_PRODUCTIONS];
+static long total_consultas[NUM_NONTERMINALS][NUM_TOKENS];
+static pthread_mutex_t trava_totais = PTHREAD_MUTEX_INITIALIZER;
+
+void perfil_juntar_thread(void) {
+    pthread_mutex_lock(&trava_totais);
+    for (int p = 0; p < NUM_PRODUCTIONS; p++)
+        total_expansoes[p] += perfil_expansoes[p];
+    for (int nt = 0; nt < NUM_NONTERMINALS; nt++)
+        for (int t = 0; t < NUM_TOKENS; t++)
+            total_consultas[nt][t] += perfil_consultas[nt][t];
+    pthread_mutex_unlock(&trava_totais);
+    memset(perfil_expansoes, 0, sizeof(perfil_expansoes));
+    memset(perfil_consultas, 0, sizeof(perfil_consultas));
+}
+
+// Texto "CABECA -> corpo" de uma producao.
+static void formatar_producao(int p, char *destino, size_t n) {
+    const Producao *prod = &producoes[p];
+    int usado = snprintf(destino, n, "%s ->", nonterm_name(prod->cabeca - NUM_TOKENS));
+    if (prod->tam_corpo == 0)
+        snprintf(destino + usado, n - (size_t)usado, " e");
+    for (int i = 0; i < prod->tam_corpo && (size_t)usado < n; i++) {
+        int sim = prod->corpo[i];
+        usado += snprintf(destino + usado, n - (size_t)usado, " %s",
+                          E_TERMINAL(sim) ? token_name(sim) : nonterm_name(sim - NUM_TOKENS));
+    }
+}
+
+static long contagem_expansoes[NUM_PRODUCTIONS];
+
+static int comparar_producoes(const void *a, const void *b) {
+    long x = contagem_expansoes[*(const int *)a], y = contagem_expansoes[*(const int *)b];
+    if (x != y)
+        return x < y ? 1 : -1;
+    return *(const int *)a - *(const int *)b;
+}
+
+// Intensidade de 1 a 9 numa escala logaritmica em relacao ao maximo.
+static char nivel_calor(long valor, long maximo) {
+    if (valor <= 0)
+        return ' ';
+    int nivel = 1;
+    long limite = maximo;
+    while (nivel < 9 && valor * 4 <= limite) {
+        limite /= 4;
+        nivel++;
+    }
+    return (char)('0' + 10 - nivel);
+}
+
+void perfil_imprimir(FILE *destino) {
+    // As threads de trabalho ja juntaram as suas; falta a que imprime.
+    perfil_juntar_thread();
+    long total = 0;
+    int ordem[NUM_PRODUCTIONS];
+    for (int p = 0; p < NUM_PRODUCTIONS; p++) {
+        contagem_expansoes[p] = total_expansoes[p];
+        total += contagem_expansoes[p];
+        ordem[p] = p;
+    }
+    qsort(ordem, NUM_PRODUCTIONS, sizeof(int), comparar_producoes);
+
+    fprintf(destino, "============================ PRODUCOES MAIS USADAS ==========================\n");
+    fprintf(destino, "%4s %5s %12s %7s %7s  %s\n", "#", "p", "expansoes", "%", "acum %", "producao");
+    long acumulado = 0;
+    for (int i = 0; i < NUM_PRODUCTIONS; i++) {
+        int p = ordem[i];
+        if (contagem_expansoes[p] == 0)
+            continue;
+        char texto[256];
+        formatar_producao(p, texto, sizeof(texto));
+        acumulado += contagem_expansoes[p];
+        fprintf(destino, "%4d %5d %12ld %6.2f%% %6.2f%%  %s\n", i + 1, p, contagem_expansoes[p],
+                100.0 * (double)contagem_expansoes[p] / (double)(total ? total : 1),
+                100.0 * (double)acumulado / (double)(total ? total : 1), texto);
+    }
+    fprintf(destino, "Nunca expandidas:");
+    int nenhuma = 1;
+    for (int p = 0; p < NUM_PRODUCTIONS; p++) {
+        if (contagem_expansoes[p] == 0) {
+            fprintf(destino, " %d", p);
+            nenhuma = 0;
+        }
+    }
+    fprintf(destino, "%s\n", nenhuma ? " (nenhuma)" : "");
+
+    // Mapa de calor: uma linha por NT, uma coluna por token.
+    long maximo = 0;
+    for (int nt = 0; nt < NUM_NONTERMINALS; nt++)
+        for (int t = 0; t < NUM_TOKENS; t++)
+            if (total_consultas[nt][t] > maximo)
+                maximo = total_consultas[nt][t];
+
+    fprintf(destino, "============================ MAPA DE CALOR DA TABELA ========================\n");
+    fprintf(destino, "9 = mais consultada ... 1 = ate 4^8 vezes menos; '.' celula valida nunca\n"
+                     "consultada; 'x' celula vazia consultada (erro); branco = vazia.\n");
+    fprintf(destino, "%-20s ", "");
+    for (int t = 0; t < NUM_TOKENS; t++)
+        fprintf(destino, "%d", t / 10);
+    fprintf(destino, "\n%-20s ", "");
+    for (int t = 0; t < NUM_TOKENS; t++)
+        fprintf(destino, "%d", t % 10);
+    fprintf(destino, "\n");
+    for (int nt = 0; nt < NUM_NONTERMINALS; nt++) {
+        fprintf(destino, "%-20s ", nonterm_name(nt));
+        for (int t = 0; t < NUM_TOKENS; t++) {
+            long n = total_consultas[nt][t];
+            char c = nivel_calor(n, maximo);
+            if (tabela_analise[nt][t] < 0)
+                c = n ? 'x' : ' ';
+            else if (n == 0)
+                c = '.';
+            fputc(c, destino);
+        }
+        fprintf(destino, "\n");
+    }
+    fprintf(destino, "Colunas:");
+    for (int t = 0; t < NUM_TOKENS; t++)
+        fprintf(destino, "%s %d=%s", t % 6 == 0 ? "\n " : "", t, token_name(t));
+    fprintf(destino, "\n=============================================================================\n");
+}
+
+#else
+
+void perfil_imprimir(FILE *destino) {
+    fprintf(destino, "Perfil indisponivel: compile com -DPERFIL_GRAMATICA.\n");
+}
+
+#endif
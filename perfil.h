@@ -0,0 +1,36 @@
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <stdio.h>
+#include "parser.h"
+
+/* Perfil da gramatica: quantas vezes cada producao foi expandida e cada
+   celula tabela_analise[nt][t] foi consultada. So existe num binario
+   compilado com -DPERFIL_GRAMATICA; sem a macro os contadores somem e o
+   driver fica exatamente como era. Cada thread conta nos seus proprios
+   vetores (_Thread_local, incremento simples, sem disputa de linha de
+   cache) e os soma ao total com PERFIL_JUNTAR_THREAD() antes de terminar,
+   entao o perfil de um corpus verificado com --threads tambem e exato. */
+
+#ifdef PERFIL_GRAMATICA
+extern _Thread_local long perfil_expansoes[NUM_PRODUCTIONS];
+extern _Thread_local long perfil_consultas[NUM_NONTERMINALS][NUM_TOKENS];
+
+// Soma os contadores da thread atual ao total e os zera.
+void perfil_juntar_thread(void);
+
+#define PERFIL_CONSULTA(nt, t)  (perfil_consultas[nt][t]++)
+#define PERFIL_EXPANSAO(p)      (perfil_expansoes[p]++)
+#define PERFIL_JUNTAR_THREAD()  perfil_juntar_thread()
+#define PERFIL_DISPONIVEL 1
+#else
+#define PERFIL_CONSULTA(nt, t)  ((void)0)
+#define PERFIL_EXPANSAO(p)      ((void)0)
+#define PERFIL_JUNTAR_THREAD()  ((void)0)
+#define PERFIL_DISPONIVEL 0
+#endif
+
+// Imprime as producoes mais usadas (ordenadas) e o mapa de calor da tabela.
+void perfil_imprimir(FILE *destino);
+
+#endif
@@ -0,0 +1,295 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include "parser.h"
+#include "pipeline.h"
+#include "estatisticas.h"
+
+/* ============================
+   Anel de lotes (um produtor, um consumidor)
+   ============================ */
+
+#define LINHA_CACHE   64
+#define NUM_LOTES     64   // Potencia de 2.
+#define GIROS_ESPERA  128  // Tentativas antes de ceder o processador.
+
+typedef struct {
+    int tipo;
+    int tamanho;
+    const char *lexema;    // Aponta para o texto de entrada, nao para o lote.
+} TokenLote;
+
+typedef struct {
+    // Escritos so pelo produtor.
+    _Alignas(LINHA_CACHE) atomic_size_t publicados;
+    size_t consumidos_visto;   // Copia local de 'liberados'.
+
+    // Escritos so pelo consumidor.
+    _Alignas(LINHA_CACHE) atomic_size_t liberados;
+    size_t publicados_visto;   // Copia local de 'publicados'.
+    atomic_int abandonado;     // O parser parou antes do fim da entrada.
+
+    // Somente leitura depois de iniciado.
+    _Alignas(LINHA_CACHE) TokenLote *tokens;   // NUM_LOTES * tam_lote.
+    int quantidades[NUM_LOTES];
+    int tam_lote;
+    const char *texto;
+    size_t tamanho;
+    int relatar_erros;         // O produtor relata os erros lexicos.
+} AnelTokens;
+
+static void esperar(int *giros) {
+    if (++*giros >= GIROS_ESPERA) {
+        sched_yield();
+        *giros = 0;
+    }
+}
+
+// Thread do lexer: preenche e publica lotes ate o T_EOF.
+static void *produzir_tokens(void *arg) {
+    AnelTokens *anel = arg;
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, anel->texto, anel->tamanho);
+    lx.relatar_erros = anel->relatar_erros;
+
+    size_t lote = 0;
+    int fim = 0;
+    while (!fim) {
+        // Espera um espaco livre; so le 'liberados' se o anel parece cheio.
+        int giros = 0;
+        while (lote - anel->consumidos_visto == NUM_LOTES) {
+            if (atomic_load_explicit(&anel->abandonado, memory_order_relaxed))
+                return NULL;
+            anel->consumidos_visto = atomic_load_explicit(&anel->liberados, memory_order_acquire);
+            if (lote - anel->consumidos_visto == NUM_LOTES)
+                esperar(&giros);
+        }
+
+        size_t slot = lote & (NUM_LOTES - 1);
+        TokenLote *t = &anel->tokens[slot * (size_t)anel->tam_lote];
+        int n = 0;
+        while (n < anel->tam_lote) {
+            t[n].tipo = lexer_r_proximo(&lx);
+            t[n].lexema = lx.lexema;
+            t[n].tamanho = lx.tamanho;
+            if (t[n++].tipo == T_EOF) {
+                fim = 1;
+                break;
+            }
+        }
+        anel->quantidades[slot] = n;
+        atomic_store_explicit(&anel->publicados, ++lote, memory_order_release);
+    }
+    return NULL;
+}
+
+// Lado do parser: percorre o lote atual e so espera quando ele acaba.
+typedef struct {
+    AnelTokens *anel;
+    size_t lote;           // Lote em leitura.
+    int pos, quantidade;
+    int terminou;          // Ja devolveu T_EOF.
+} ConsumidorAnel;
+
+static int fonte_anel_proximo(void *dados, const char **lexema, int *tamanho) {
+    ConsumidorAnel *c = dados;
+    AnelTokens *anel = c->anel;
+
+    if (c->pos == c->quantidade) {
+        if (c->terminou) {
+            *lexema = "";
+            *tamanho = 0;
+            return T_EOF;
+        }
+        if (c->quantidade > 0)
+            atomic_store_explicit(&anel->liberados, ++c->lote, memory_order_release);
+
+        int giros = 0;
+        while (anel->publicados_visto == c->lote) {
+            anel->publicados_visto = atomic_load_explicit(&anel->publicados, memory_order_acquire);
+            if (anel->publicados_visto == c->lote)
+                esperar(&giros);
+        }
+        c->quantidade = anel->quantidades[c->lote & (NUM_LOTES - 1)];
+        c->pos = 0;
+    }
+
+    const TokenLote *t = &anel->tokens[(c->lote & (NUM_LOTES - 1)) * (size_t)anel->tam_lote + (size_t)c->pos++];
+    *lexema = t->lexema;
+    *tamanho = t->tamanho;
+    if (t->tipo == T_EOF)
+        c->terminou = 1;
+    return t->tipo;
+}
+
+/* ============================
+   Execucao
+   ============================ */
+
+int analisar_em_pipeline(const char *texto, size_t tamanho, int tam_lote, int relatar_erros) {
+    if (tam_lote <= 0)
+        tam_lote = PIPELINE_LOTE_PADRAO;
+
+    AnelTokens *anel = aligned_alloc(LINHA_CACHE, sizeof(AnelTokens));
+    TokenLote *tokens = malloc((size_t)NUM_LOTES * (size_t)tam_lote * sizeof(TokenLote));
+    if (!anel || !tokens) {
+        fprintf(stderr, "Erro: memoria insuficiente para o pipeline.\n");
+        exit(1);
+    }
+    atomic_init(&anel->publicados, 0);
+    atomic_init(&anel->liberados, 0);
+    atomic_init(&anel->abandonado, 0);
+    anel->consumidos_visto = 0;
+    anel->publicados_visto = 0;
+    anel->tokens = tokens;
+    anel->tam_lote = tam_lote;
+    anel->texto = texto;
+    anel->tamanho = tamanho;
+    anel->relatar_erros = relatar_erros;
+
+    // Sem a thread produtora ninguem enche o anel: analisa em sequencia,
+    // com o lexer puxado direto pelo parser.
+    pthread_t produtor;
+    if (pthread_create(&produtor, NULL, produzir_tokens, anel) != 0) {
+        free(tokens);
+        free(anel);
+        LexerReentrante lx;
+        lexer_r_iniciar(&lx, texto, tamanho);
+        lx.relatar_erros = relatar_erros;
+        FonteTokens fonte = fonte_lexer_reentrante(&lx);
+        Pilha pilha;
+        pilha_init(&pilha);
+        int erros = analisar_entrada(&pilha, &fonte, NULL, relatar_erros);
+        pilha_liberar(&pilha);
+        return erros;
+    }
+
+    ConsumidorAnel consumidor = { anel, 0, 0, 0, 0 };
+    FonteTokens fonte = { fonte_anel_proximo, &consumidor };
+    Pilha pilha;
+    pilha_init(&pilha);
+    int erros = analisar_entrada(&pilha, &fonte, NULL, relatar_erros);
+    pilha_liberar(&pilha);
+
+    // O parser pode parar antes do T_EOF (limite de erros).
+    atomic_store_explicit(&anel->abandonado, 1, memory_order_relaxed);
+    pthread_join(produtor, NULL);
+
+    free(tokens);
+    free(anel);
+    return erros;
+}
+
+/* ============================
+   Medicao
+   ============================ */
+
+typedef struct {
+    const TokenLote *tokens;
+    long pos;
+} FonteVetor;
+
+static int fonte_vetor_proximo(void *dados, const char **lexema, int *tamanho) {
+    FonteVetor *f = dados;
+    const TokenLote *t = &f->tokens[f->pos];
+    if (t->tipo != T_EOF)
+        f->pos++;
+    *lexema = t->lexema;
+    *tamanho = t->tamanho;
+    return t->tipo;
+}
+
+#define MEDICOES 3 // Fica com a melhor de 3.
+
+void medir_pipeline(const char *texto, size_t tamanho) {
+    // Vetor de tokens pre-lexado para medir a analise sozinha.
+    long capacidade = 1024, quantidade = 0;
+    TokenLote *tokens = malloc((size_t)capacidade * sizeof(TokenLote));
+    double lexico = 1e30, analise = 1e30, sequencial = 1e30;
+    for (int m = 0; m < MEDICOES && tokens; m++) {
+        double inicio = relogio_monotonico();
+        LexerReentrante lx;
+        lexer_r_iniciar(&lx, texto, tamanho);
+        lx.relatar_erros = 0;
+        quantidade = 0;
+        for (;;) {
+            if (quantidade == capacidade) {
+                TokenLote *maior = realloc(tokens, (size_t)capacidade * 2 * sizeof(TokenLote));
+                if (!maior) {
+                    free(tokens);
+                    tokens = NULL;
+                    break;
+                }
+                tokens = maior;
+                capacidade *= 2;
+            }
+            TokenLote *t = &tokens[quantidade++];
+            t->tipo = lexer_r_proximo(&lx);
+            t->lexema = lx.lexema;
+            t->tamanho = lx.tamanho;
+            if (t->tipo == T_EOF)
+                break;
+        }
+        double tempo = relogio_monotonico() - inicio;
+        if (tempo < lexico)
+            lexico = tempo;
+    }
+    if (!tokens) {
+        fprintf(stderr, "Erro: memoria insuficiente para o pipeline.\n");
+        exit(1);
+    }
+
+    Pilha pilha;
+    pilha_init(&pilha);
+    int erros = 0;
+    for (int m = 0; m < MEDICOES; m++) {
+        FonteVetor dados = { tokens, 0 };
+        FonteTokens fonte = { fonte_vetor_proximo, &dados };
+        double inicio = relogio_monotonico();
+        erros = analisar_entrada(&pilha, &fonte, NULL, 0);
+        double tempo = relogio_monotonico() - inicio;
+        if (tempo < analise)
+            analise = tempo;
+
+        LexerReentrante lx;
+        lexer_r_iniciar(&lx, texto, tamanho);
+        lx.relatar_erros = 0;
+        FonteTokens direta = fonte_lexer_reentrante(&lx);
+        inicio = relogio_monotonico();
+        analisar_entrada(&pilha, &direta, NULL, 0);
+        tempo = relogio_monotonico() - inicio;
+        if (tempo < sequencial)
+            sequencial = tempo;
+    }
+    pilha_liberar(&pilha);
+    free(tokens);
+
+    printf("================================ PIPELINE ===================================\n");
+    printf("Entrada: %.2f MB, %ld tokens, %s\n", (double)tamanho / 1e6, quantidade,
+           erros ? "com erros" : "correta");
+    printf("%-24s %12s\n", "etapa", "tempo (ms)");
+    printf("%-24s %12.3f\n", "so lexico", lexico * 1000.0);
+    printf("%-24s %12.3f\n", "so analise", analise * 1000.0);
+    printf("%-24s %12.3f\n", "sequencial", sequencial * 1000.0);
+    double ideal = lexico > analise ? lexico : analise;
+    printf("%-24s %12.3f\n", "ideal (maior etapa)", ideal * 1000.0);
+
+    static const int lotes[] = { 16, 64, 256, 1024, 4096 };
+    for (size_t k = 0; k < sizeof(lotes) / sizeof(lotes[0]); k++) {
+        double melhor = 1e30;
+        for (int m = 0; m < MEDICOES; m++) {
+            double inicio = relogio_monotonico();
+            analisar_em_pipeline(texto, tamanho, lotes[k], 0);
+            double tempo = relogio_monotonico() - inicio;
+            if (tempo < melhor)
+                melhor = tempo;
+        }
+        char rotulo[32];
+        snprintf(rotulo, sizeof(rotulo), "pipeline (lote %d)", lotes[k]);
+        printf("%-24s %12.3f   %.2fx do sequencial\n", rotulo, melhor * 1000.0, sequencial / melhor);
+    }
+    printf("=============================================================================\n");
+}
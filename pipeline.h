@@ -0,0 +1,25 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stddef.h>
+
+/* Lexico e analise em duas threads.
+   O lexer (produtor) preenche lotes de tokens num anel circular de um
+   produtor e um consumidor, sem travas; o parser (consumidor) le os lotes
+   por uma FonteTokens. Os indices do anel ficam em linhas de cache
+   separadas, e cada lado guarda uma copia local do indice do outro, para
+   so tocar na linha alheia quando o anel parece cheio ou vazio. */
+
+#define PIPELINE_LOTE_PADRAO 256
+
+// Analisa 'texto' com o lexer e o parser em threads separadas, trocando
+// lotes de 'tam_lote' tokens (0 = PIPELINE_LOTE_PADRAO).
+// Retorna o numero de erros sintaticos (impressos, como os lexicos, se
+// 'relatar_erros').
+int analisar_em_pipeline(const char *texto, size_t tamanho, int tam_lote, int relatar_erros);
+
+// Mede o lexico sozinho, a analise sozinha, os dois em sequencia e o
+// pipeline com varios tamanhos de lote, e imprime a tabela.
+void medir_pipeline(const char *texto, size_t tamanho);
+
+#endif
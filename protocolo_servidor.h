@@ -0,0 +1,40 @@
+#ifndef PROTOCOLO_SERVIDOR_H
+#define PROTOCOLO_SERVIDOR_H
+
+#include <stdint.h>
+
+/* Protocolo binario entre o servidor de verificacao (analisador --servidor)
+   e o cliente, sobre um socket Unix. Inteiros na ordem de bytes da maquina
+   (cliente e servidor estao sempre no mesmo host).
+
+   Pedido:   CabecalhoPedido seguido de 'tamanho' bytes de carga:
+               PEDIDO_BUFFER   -> texto do programa
+               PEDIDO_CAMINHO  -> caminho do arquivo (sem '\0')
+               PEDIDO_ENCERRAR -> sem carga; o servidor termina
+   Resposta: RespostaServidor.
+   Uma conexao pode levar varios pedidos em sequencia. */
+
+#define PROTOCOLO_MAGICO 0x314E4D43u /* "CMN1" */
+
+enum {
+    PEDIDO_BUFFER   = 1,
+    PEDIDO_CAMINHO  = 2,
+    PEDIDO_ENCERRAR = 3
+};
+
+// Codigos de 'erros' negativos na resposta.
+#define RESPOSTA_ARQUIVO_ILEGIVEL (-1)
+#define RESPOSTA_PEDIDO_INVALIDO  (-2)
+
+typedef struct {
+    uint32_t magico;
+    uint32_t tipo;
+    uint32_t tamanho;
+} CabecalhoPedido;
+
+typedef struct {
+    int32_t erros;          // Erros sintaticos (0 = correto) ou codigo negativo.
+    uint32_t microssegundos; // Tempo gasto pelo servidor no pedido.
+} RespostaServidor;
+
+#endif
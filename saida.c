@@ -0,0 +1,234 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include "saida.h"
+
+NivelSaida nivel_saida = NIVEL_DEPURACAO;
+FormatoSaida formato_saida = FORMATO_TEXTO;
+
+/* ============================
+   Buffers
+   ============================ */
+
+typedef struct {
+    char *dados;
+    size_t tamanho;
+    size_t capacidade;
+} Buffer;
+
+static Buffer saida;        // O que vai para a saida padrao.
+static Buffer mensagens;    // Texto dos diagnosticos (json/binario).
+
+typedef struct {
+    int indice_token;
+    size_t inicio, tamanho; // Faixa em 'mensagens'.
+} Diagnostico;
+
+static Diagnostico *diagnosticos;
+static int num_diagnosticos, capacidade_diagnosticos;
+
+static void buffer_reservar(Buffer *b, size_t extra) {
+    if (b->tamanho + extra <= b->capacidade)
+        return;
+    size_t nova = b->capacidade ? b->capacidade : 65536;
+    while (nova < b->tamanho + extra)
+        nova *= 2;
+    char *dados = realloc(b->dados, nova);
+    if (!dados) {
+        fprintf(stderr, "Erro: memoria insuficiente para o buffer de saida.\n");
+        exit(1);
+    }
+    b->dados = dados;
+    b->capacidade = nova;
+}
+
+static void buffer_bytes(Buffer *b, const void *dados, size_t n) {
+    buffer_reservar(b, n);
+    memcpy(b->dados + b->tamanho, dados, n);
+    b->tamanho += n;
+}
+
+static void buffer_vprintf(Buffer *b, const char *formato, va_list args) {
+    va_list copia;
+    va_copy(copia, args);
+    int n = vsnprintf(b->dados + b->tamanho, b->capacidade - b->tamanho, formato, copia);
+    va_end(copia);
+    if (n < 0)
+        return;
+    if ((size_t)n >= b->capacidade - b->tamanho) {
+        buffer_reservar(b, (size_t)n + 1);
+        vsnprintf(b->dados + b->tamanho, b->capacidade - b->tamanho, formato, args);
+    }
+    b->tamanho += (size_t)n;
+}
+
+/* ============================
+   Interface
+   ============================ */
+
+void saida_printf(const char *formato, ...) {
+    buffer_reservar(&saida, 256);
+    va_list args;
+    va_start(args, formato);
+    buffer_vprintf(&saida, formato, args);
+    va_end(args);
+}
+
+static void diagnostico(const char *categoria, int indice_token, const char *formato, va_list args) {
+    if (formato_saida == FORMATO_TEXTO) {
+        if (indice_token >= 0)
+            saida_printf("Erro %s (token %d): ", categoria, indice_token);
+        buffer_vprintf(&saida, formato, args);
+        saida_printf("\n");
+    } else {
+        if (num_diagnosticos == capacidade_diagnosticos) {
+            int nova = capacidade_diagnosticos ? capacidade_diagnosticos * 2 : 64;
+            Diagnostico *d = realloc(diagnosticos, (size_t)nova * sizeof(Diagnostico));
+            if (!d) {
+                fprintf(stderr, "Erro: memoria insuficiente para o buffer de saida.\n");
+                exit(1);
+            }
+            diagnosticos = d;
+            capacidade_diagnosticos = nova;
+        }
+        Diagnostico *d = &diagnosticos[num_diagnosticos++];
+        d->indice_token = indice_token;
+        d->inicio = mensagens.tamanho;
+        buffer_reservar(&mensagens, 256);
+        buffer_vprintf(&mensagens, formato, args);
+        d->tamanho = mensagens.tamanho - d->inicio;
+    }
+}
+
+void saida_diagnostico(int indice_token, const char *formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    diagnostico("sintatico", indice_token, formato, args);
+    va_end(args);
+}
+
+void saida_diagnostico_semantico(int indice_token, const char *formato, ...) {
+    va_list args;
+    va_start(args, formato);
+    diagnostico("semantico", indice_token, formato, args);
+    va_end(args);
+}
+
+void saida_erro_lexico(const char *lexema, int tamanho) {
+    fprintf(stderr, "Erro léxico: caractere inválido '%.*s'\n", tamanho, lexema);
+}
+
+// Tamanho da sequencia UTF-8 valida que comeca em s[0], ou 0 se o byte
+// nao inicia uma (continuacao solta, forma longa demais, surrogate,
+// acima de U+10FFFF ou sequencia truncada).
+static size_t utf8_sequencia(const unsigned char *s, size_t n) {
+    unsigned char c = s[0];
+    size_t tam;
+    unsigned char min = 0x80, max = 0xbf;   // faixa do segundo byte
+    if (c >= 0xc2 && c <= 0xdf) tam = 2;
+    else if (c >= 0xe0 && c <= 0xef) {
+        tam = 3;
+        if (c == 0xe0) min = 0xa0;
+        else if (c == 0xed) max = 0x9f;
+    } else if (c >= 0xf0 && c <= 0xf4) {
+        tam = 4;
+        if (c == 0xf0) min = 0x90;
+        else if (c == 0xf4) max = 0x8f;
+    } else return 0;
+    if (n < tam || s[1] < min || s[1] > max) return 0;
+    for (size_t i = 2; i < tam; i++)
+        if ((s[i] & 0xc0) != 0x80) return 0;
+    return tam;
+}
+
+// Texto como string JSON. UTF-8 valido passa inalterado; escapam-se so
+// aspas, barra invertida e bytes de controle. Bytes que nao formam UTF-8
+// valido viram \u00XX para o documento continuar sendo JSON valido.
+static void json_string(const char *s, size_t n) {
+    static const char hex[] = "0123456789abcdef";
+    buffer_reservar(&saida, n * 6 + 2);
+    char *p = saida.dados + saida.tamanho;
+    *p++ = '"';
+    for (size_t i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)s[i];
+        size_t tam;
+        if (c == '"' || c == '\\') {
+            *p++ = '\\';
+            *p++ = (char)c;
+        } else if (c >= 0x80 && (tam = utf8_sequencia((const unsigned char *)s + i, n - i)) > 0) {
+            memcpy(p, s + i, tam);
+            p += tam;
+            i += tam - 1;
+        } else if (c < 0x20 || c >= 0x80) {
+            memcpy(p, "\\u00", 4);
+            p[4] = hex[c >> 4];
+            p[5] = hex[c & 15];
+            p += 6;
+        } else {
+            *p++ = (char)c;
+        }
+    }
+    *p++ = '"';
+    saida.tamanho = (size_t)(p - saida.dados);
+}
+
+static void resultado(int erros, const char *adverbio, const char *categoria) {
+    if (formato_saida == FORMATO_TEXTO) {
+        if (erros == 0)
+            saida_printf("\nSucesso: programa %s correto.\n\n", adverbio);
+        else
+            saida_printf("\nErro %s: %d erro(s) encontrado(s).\n\n", categoria, erros);
+    } else if (formato_saida == FORMATO_JSON) {
+        saida_printf("{\"ok\":%s,\"erros\":%d,\"diagnosticos\":[", erros ? "false" : "true", erros);
+        for (int i = 0; i < num_diagnosticos; i++) {
+            saida_printf("%s{\"token\":%d,\"mensagem\":", i ? "," : "",
+                         diagnosticos[i].indice_token);
+            json_string(mensagens.dados + diagnosticos[i].inicio, diagnosticos[i].tamanho);
+            saida_printf("}");
+        }
+        saida_printf("]}\n");
+    } else {
+        uint32_t cabecalho[3] = { 0, (uint32_t)erros, (uint32_t)num_diagnosticos };
+        memcpy(cabecalho, "CMR1", 4);
+        buffer_bytes(&saida, cabecalho, sizeof(cabecalho));
+        for (int i = 0; i < num_diagnosticos; i++) {
+            int32_t token = diagnosticos[i].indice_token;
+            uint32_t tamanho = (uint32_t)diagnosticos[i].tamanho;
+            buffer_bytes(&saida, &token, sizeof(token));
+            buffer_bytes(&saida, &tamanho, sizeof(tamanho));
+            buffer_bytes(&saida, mensagens.dados + diagnosticos[i].inicio, tamanho);
+        }
+    }
+    num_diagnosticos = 0;
+    mensagens.tamanho = 0;
+}
+
+void saida_resultado(int erros) {
+    resultado(erros, "sintaticamente", "sintatico");
+}
+
+void saida_resultado_semantico(int erros) {
+    resultado(erros, "semanticamente", "semantico");
+}
+
+int saida_descarregar(void) {
+    const char *p = saida.dados;
+    size_t n = saida.tamanho;
+    fflush(stdout); // O que ainda estiver no stdio sai antes.
+    while (n > 0) {
+        ssize_t w = write(STDOUT_FILENO, p, n);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            return 0;
+        p += w;
+        n -= (size_t)w;
+    }
+    saida.tamanho = 0;
+    return 1;
+}
@@ -0,0 +1,58 @@
+#ifndef SAIDA_H
+#define SAIDA_H
+
+#include <stddef.h>
+
+/* Saida do analisador para um unico arquivo.
+   Tudo vai para um buffer grande em memoria, escrito de uma vez so por
+   saida_descarregar(), em vez de centenas de printf. O nivel escolhe o que
+   aparece e o formato escolhe como:
+     - texto:   as mensagens de sempre (veredito, erros e, no nivel de
+                depuracao, tokens, FIRST, FOLLOW e tabela LL(1));
+     - json:    uma linha {"ok":...,"erros":N,"diagnosticos":[...]};
+     - binario: "CMR1", uint32 erros, uint32 quantidade de diagnosticos e,
+                para cada um, int32 token (-1 se nenhum), uint32 tamanho e
+                o texto da mensagem (sem '\0'), na ordem de bytes da maquina.
+   Os despejos de depuracao so existem no formato texto. */
+
+typedef enum {
+    NIVEL_SILENCIOSO,   // So o veredito.
+    NIVEL_DIAGNOSTICO,  // Veredito e erros sintaticos.
+    NIVEL_DEPURACAO     // Tudo, inclusive tokens, conjuntos e tabela.
+} NivelSaida;
+
+typedef enum {
+    FORMATO_TEXTO,
+    FORMATO_JSON,
+    FORMATO_BINARIO
+} FormatoSaida;
+
+extern NivelSaida nivel_saida;
+extern FormatoSaida formato_saida;
+
+// Acrescenta texto formatado ao buffer (use so no formato texto).
+void saida_printf(const char *formato, ...);
+
+// Registra um erro; 'indice_token' < 0 se a mensagem nao e de um token.
+// No formato texto vira "Erro sintatico (token N): mensagem".
+void saida_diagnostico(int indice_token, const char *formato, ...);
+
+// Como saida_diagnostico, para erros semanticos ("Erro semantico (token N)").
+void saida_diagnostico_semantico(int indice_token, const char *formato, ...);
+
+// Erro lexico (caractere invalido), no mesmo texto para os dois lexers
+// (lexer.l e lexer_reentrante.c). Vai direto para a saida de erro, fora do
+// buffer e do formato, no momento em que o token e lido; e uma unica
+// chamada a fprintf, entao pode vir de qualquer thread.
+void saida_erro_lexico(const char *lexema, int tamanho);
+
+// Escreve o resultado final (veredito e diagnosticos) no formato escolhido.
+void saida_resultado(int erros);
+// O mesmo, para o veredito da analise semantica.
+void saida_resultado_semantico(int erros);
+
+// Escreve o buffer na saida padrao com uma unica chamada (mais as que um
+// write parcial exigir) e o esvazia. Retorna 0 se a escrita falhou.
+int saida_descarregar(void);
+
+#endif
@@ -0,0 +1,625 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sccp.h"
+#include "cfg.h"
+#include "ssa.h"
+#include "memoria.h"
+
+// As mesmas de vm.c: int com transbordo circular.
+#define SOMA_I(x, y)           ((int64_t)((uint64_t)(x) + (uint64_t)(y)))
+#define SUBTRACAO_I(x, y)      ((int64_t)((uint64_t)(x) - (uint64_t)(y)))
+#define MULTIPLICACAO_I(x, y)  ((int64_t)((uint64_t)(x) * (uint64_t)(y)))
+
+static void *alocar(size_t quantidade, size_t tamanho_item) {
+    void *dados = calloc(quantidade ? quantidade : 1, tamanho_item);
+    if (!dados) {
+        fprintf(stderr, "Erro: memoria insuficiente para a propagacao de constantes.\n");
+        exit(1);
+    }
+    return dados;
+}
+
+/* ============================ Avaliacao ============================ */
+
+enum { INDEFINIDO, CONSTANTE, VARIADO };
+
+// Resultado de 'op' sobre os operandos lidos 'x' e 'y' (e o imediato de
+// SOMAR_K_I). Retorna 0 se a instrucao nao pode ser dobrada.
+static int dobrar(const Instrucao *ins, int op, Valor x, Valor y, Valor *r) {
+    switch (op) {
+        case OP_MOVER:          *r = x; break;
+        case OP_I2F:            r->f = (double)x.i; break;
+        case OP_SOMAR_I:        r->i = SOMA_I(x.i, y.i); break;
+        case OP_SUBTRAIR_I:     r->i = SUBTRACAO_I(x.i, y.i); break;
+        case OP_MULTIPLICAR_I:  r->i = MULTIPLICACAO_I(x.i, y.i); break;
+        case OP_DIVIDIR_I:
+            if (y.i == 0)
+                return 0;
+            r->i = y.i == -1 ? SUBTRACAO_I(0, x.i) : x.i / y.i;
+            break;
+        case OP_SOMAR_F:        r->f = x.f + y.f; break;
+        case OP_SUBTRAIR_F:     r->f = x.f - y.f; break;
+        case OP_MULTIPLICAR_F:  r->f = x.f * y.f; break;
+        case OP_DIVIDIR_F:      r->f = x.f / y.f; break;
+        case OP_IGUAL_I:        r->i = x.i == y.i; break;
+        case OP_DIFERENTE_I:    r->i = x.i != y.i; break;
+        case OP_MENOR_I:        r->i = x.i < y.i; break;
+        case OP_MENOR_IGUAL_I:  r->i = x.i <= y.i; break;
+        case OP_MAIOR_I:        r->i = x.i > y.i; break;
+        case OP_MAIOR_IGUAL_I:  r->i = x.i >= y.i; break;
+        case OP_IGUAL_F:        r->i = x.f == y.f; break;
+        case OP_DIFERENTE_F:    r->i = x.f != y.f; break;
+        case OP_MENOR_F:        r->i = x.f < y.f; break;
+        case OP_MENOR_IGUAL_F:  r->i = x.f <= y.f; break;
+        case OP_MAIOR_F:        r->i = x.f > y.f; break;
+        case OP_MAIOR_IGUAL_F:  r->i = x.f >= y.f; break;
+        case OP_NAO_I:          r->i = x.i == 0; break;
+        case OP_NAO_F:          r->i = x.f == 0; break;
+        case OP_VERDADE_I:      r->i = x.i != 0; break;
+        case OP_VERDADE_F:      r->i = x.f != 0; break;
+        case OP_SOMAR_K_I:      r->i = SOMA_I(x.i, ins->c); break;
+        default:                return 0;
+    }
+    return 1;
+}
+
+/* ============================ Propagacao ============================ */
+
+typedef struct {
+    const Programa *prog;
+    const Cfg *cfg;
+    const Ssa *ssa;
+    unsigned char *estado;      // Por valor.
+    Valor *valor;
+    unsigned char *aresta_executavel;   // Por aresta (indice em cfg->sucessores).
+    unsigned char *bloco_executavel;
+    int *aresta_pred;           // Aresta de cada entrada de cfg->predecessores.
+    int *bloco_phi;
+    // Usos de cada valor: instrucao i ou ~f para o phi f.
+    int *inicio_usos;
+    int *usos;
+    // Listas de trabalho: cada aresta entra uma vez e cada valor no maximo
+    // duas (so desce no reticulado).
+    int *arestas;
+    int num_arestas;
+    int *valores;
+    int num_valores;
+} Propagacao;
+
+// Estado e valor do operando 'k' da instrucao 'i'.
+static int operando(const Propagacao *s, int i, int k, Valor *v) {
+    const Programa *p = s->prog;
+    const Instrucao *ins = &p->codigo[i];
+    int reg = k == 0 ? ins->a : k == 1 ? ins->b : ins->c;
+    int valor = s->ssa->valores[3 * i + k];
+    if (valor != SSA_NENHUM) {
+        *v = s->valor[valor];
+        return s->estado[valor];
+    }
+    int c = reg - (p->num_variaveis + p->num_temporarios);
+    if (c >= 0 && c < p->num_constantes && p->registradores_constantes[c] == reg) {
+        *v = p->valores_constantes[c];
+        return CONSTANTE;
+    }
+    return VARIADO;
+}
+
+// Estado do resultado de 'op' lendo os operandos de 'i' (os lidos, em
+// ordem). Variado ganha de indefinido: o resultado nunca sobe.
+static int avaliar(const Propagacao *s, int i, int op, Valor *r) {
+    const Instrucao *ins = &s->prog->codigo[i];
+    Valor lidos[3] = { { 0 }, { 0 }, { 0 } };
+    int num_lidos = 0, indefinido = 0;
+    for (int k = 0; k < 3; k++) {
+        if (papeis_opcode[ins->op][k] != PAPEL_LIDO)
+            continue;
+        int estado = operando(s, i, k, &lidos[num_lidos++]);
+        if (estado == VARIADO)
+            return VARIADO;
+        indefinido |= estado == INDEFINIDO;
+    }
+    if (indefinido)
+        return INDEFINIDO;
+    return dobrar(ins, op, lidos[0], lidos[1], r) ? CONSTANTE : VARIADO;
+}
+
+static void baixar(Propagacao *s, int v, int estado, Valor valor) {
+    if (estado == INDEFINIDO || s->estado[v] == VARIADO)
+        return;
+    if (s->estado[v] == CONSTANTE) {
+        if (estado == CONSTANTE && valor.i == s->valor[v].i)
+            return;
+        estado = VARIADO;
+    }
+    s->estado[v] = (unsigned char)estado;
+    s->valor[v] = valor;
+    s->valores[s->num_valores++] = v;
+}
+
+// Torna executavel a aresta de 'b' para 'c' (se existir).
+static void ativar(Propagacao *s, int b, int c) {
+    const Cfg *g = s->cfg;
+    for (int e = g->inicio_suc[b]; e < g->inicio_suc[b + 1]; e++)
+        if (g->sucessores[e] == c && !s->aresta_executavel[e]) {
+            s->aresta_executavel[e] = 1;
+            s->arestas[s->num_arestas++] = e;
+        }
+}
+
+static void visitar_phi(Propagacao *s, int f) {
+    const Cfg *g = s->cfg;
+    const Ssa *ssa = s->ssa;
+    int b = s->bloco_phi[f];
+    int num_pred = g->inicio_pred[b + 1] - g->inicio_pred[b];
+    int estado = INDEFINIDO;
+    Valor valor = { 0 };
+    for (int a = ssa->inicio_argumentos[f]; a < ssa->inicio_argumentos[f + 1]; a++) {
+        int j = a - ssa->inicio_argumentos[f];
+        int v = ssa->argumentos[a];
+        // O argumento a mais do bloco 0 vem da entrada, sempre executavel.
+        if (v == SSA_NENHUM || (j < num_pred && !s->aresta_executavel[s->aresta_pred[g->inicio_pred[b] + j]]))
+            continue;
+        if (s->estado[v] == VARIADO || (s->estado[v] == CONSTANTE && estado == CONSTANTE &&
+                                        s->valor[v].i != valor.i)) {
+            estado = VARIADO;
+            break;
+        }
+        if (s->estado[v] == CONSTANTE) {
+            estado = CONSTANTE;
+            valor = s->valor[v];
+        }
+    }
+    baixar(s, ssa->phi_valor[f], estado, valor);
+}
+
+// Lados de um salto condicional que podem ser tomados: 1 = segue, 2 = salta.
+static int lados_salto(const Propagacao *s, int i) {
+    int op = s->prog->codigo[i].op;
+    Valor r;
+    int estado;
+    if (op == OP_SALTAR_SE_FALSO || op == OP_SALTAR_SE_VERDADE) {
+        estado = avaliar(s, i, OP_VERDADE_I, &r);
+        if (estado == CONSTANTE && op == OP_SALTAR_SE_FALSO)
+            r.i = !r.i;
+    } else {
+        estado = avaliar(s, i, OP_IGUAL_I + (op - OP_SALTAR_SE_IGUAL_I), &r);
+    }
+    if (estado != CONSTANTE)
+        return estado == VARIADO ? 3 : 0;
+    return r.i ? 2 : 1;
+}
+
+static void visitar_instrucao(Propagacao *s, int i) {
+    const Programa *p = s->prog;
+    const Cfg *g = s->cfg;
+    const Instrucao *ins = &p->codigo[i];
+    int v = s->ssa->valores[3 * i];
+    if (papeis_opcode[ins->op][0] == PAPEL_ESCRITO && v != SSA_NENHUM) {
+        Valor r = { 0 };
+        int estado = ins->op == OP_LER_I || ins->op == OP_LER_F || ins->op == OP_LER_C
+                         ? VARIADO : avaliar(s, i, ins->op, &r);
+        baixar(s, v, estado, r);
+    }
+
+    int b = g->bloco_de[i];
+    if (i != g->inicio[b + 1] - 1)
+        return;
+    int n = p->num_instrucoes;
+    int alvo = cfg_alvo(ins);
+    int lados = ins->op == OP_SALTAR ? 2 : alvo >= 0 ? lados_salto(s, i)
+              : cfg_sem_continuacao(ins) ? 0 : 1;
+    if ((lados & 1) && i + 1 < n)
+        ativar(s, b, b + 1);
+    if ((lados & 2) && alvo < n)
+        ativar(s, b, g->bloco_de[alvo]);
+}
+
+static void visitar_bloco(Propagacao *s, int b) {
+    const Cfg *g = s->cfg;
+    for (int f = s->ssa->inicio_phi[b]; f < s->ssa->inicio_phi[b + 1]; f++)
+        visitar_phi(s, f);
+    if (s->bloco_executavel[b])
+        return;
+    s->bloco_executavel[b] = 1;
+    for (int i = g->inicio[b]; i < g->inicio[b + 1]; i++)
+        visitar_instrucao(s, i);
+}
+
+static void iniciar_propagacao(Propagacao *s, const Ssa *ssa) {
+    const Cfg *g = ssa->cfg;
+    const Programa *p = g->prog;
+    int nb = g->num_blocos, n = p->num_instrucoes, nv = ssa->num_valores;
+    memset(s, 0, sizeof(*s));
+    s->prog = p;
+    s->cfg = g;
+    s->ssa = ssa;
+    s->estado = alocar((size_t)nv, 1);
+    s->valor = alocar((size_t)nv, sizeof(Valor));
+    for (int r = 0; r < ssa->num_registradores; r++)
+        s->estado[r] = CONSTANTE;   // A VM zera os registradores.
+    s->aresta_executavel = alocar((size_t)g->num_arestas, 1);
+    s->bloco_executavel = alocar((size_t)nb, 1);
+    s->arestas = alocar((size_t)g->num_arestas, sizeof(int));
+    s->valores = alocar((size_t)nv * 2, sizeof(int));
+
+    s->aresta_pred = alocar((size_t)g->num_arestas, sizeof(int));
+    int *livre = alocar((size_t)nb + 1, sizeof(int));
+    memcpy(livre, g->inicio_pred, ((size_t)nb + 1) * sizeof(int));
+    for (int b = 0; b < nb; b++)
+        for (int e = g->inicio_suc[b]; e < g->inicio_suc[b + 1]; e++)
+            s->aresta_pred[livre[g->sucessores[e]]++] = e;
+    s->bloco_phi = alocar((size_t)ssa->num_phis, sizeof(int));
+    for (int b = 0; b < nb; b++)
+        for (int f = ssa->inicio_phi[b]; f < ssa->inicio_phi[b + 1]; f++)
+            s->bloco_phi[f] = b;
+
+    // Usos por contagem: uma passada conta, a outra preenche.
+    s->inicio_usos = alocar((size_t)nv + 1, sizeof(int));
+    for (int passo = 0; passo < 2; passo++) {
+        if (passo == 1) {
+            for (int v = 0; v < nv; v++)
+                s->inicio_usos[v + 1] += s->inicio_usos[v];
+            s->usos = alocar((size_t)s->inicio_usos[nv], sizeof(int));
+            free(livre);
+            livre = alocar((size_t)nv + 1, sizeof(int));
+            memcpy(livre, s->inicio_usos, ((size_t)nv + 1) * sizeof(int));
+        }
+        for (int i = 0; i < n; i++)
+            for (int k = 0; k < 3; k++) {
+                int v = ssa->valores[3 * i + k];
+                if (papeis_opcode[p->codigo[i].op][k] != PAPEL_LIDO || v == SSA_NENHUM)
+                    continue;
+                if (passo == 0)
+                    s->inicio_usos[v + 1]++;
+                else
+                    s->usos[livre[v]++] = i;
+            }
+        for (int f = 0; f < ssa->num_phis; f++)
+            for (int a = ssa->inicio_argumentos[f]; a < ssa->inicio_argumentos[f + 1]; a++) {
+                int v = ssa->argumentos[a];
+                if (v == SSA_NENHUM)
+                    continue;
+                if (passo == 0)
+                    s->inicio_usos[v + 1]++;
+                else
+                    s->usos[livre[v]++] = ~f;
+            }
+    }
+    free(livre);
+}
+
+static void propagar(Propagacao *s) {
+    const Cfg *g = s->cfg;
+    if (g->num_blocos == 0)
+        return;
+    visitar_bloco(s, 0);
+    while (s->num_arestas > 0 || s->num_valores > 0) {
+        while (s->num_arestas > 0)
+            visitar_bloco(s, g->sucessores[s->arestas[--s->num_arestas]]);
+        while (s->num_valores > 0 && s->num_arestas == 0) {
+            int v = s->valores[--s->num_valores];
+            for (int u = s->inicio_usos[v]; u < s->inicio_usos[v + 1]; u++) {
+                int uso = s->usos[u];
+                if (uso >= 0 && s->bloco_executavel[g->bloco_de[uso]])
+                    visitar_instrucao(s, uso);
+                else if (uso < 0 && s->bloco_executavel[s->bloco_phi[~uso]])
+                    visitar_phi(s, ~uso);
+            }
+        }
+    }
+}
+
+static void liberar_propagacao(Propagacao *s) {
+    free(s->estado);
+    free(s->valor);
+    free(s->aresta_executavel);
+    free(s->bloco_executavel);
+    free(s->arestas);
+    free(s->valores);
+    free(s->aresta_pred);
+    free(s->bloco_phi);
+    free(s->inicio_usos);
+    free(s->usos);
+}
+
+/* ============================ Constantes ============================ */
+
+// Registradores de constante por valor (bits): os que o programa ja tem e
+// os criados aqui, acrescentados no fim de prog->registradores_constantes.
+typedef struct {
+    Programa *prog;
+    Valor *novas;
+    int num_novas;
+    int capacidade_novas;
+    int *tabela;    // Indice + 1 da constante (0 = vazio).
+    int capacidade_tabela;
+    int ocupados;
+} Constantes;
+
+static int64_t bits_constante(const Constantes *c, int k) {
+    int existentes = c->prog->num_constantes;
+    return k < existentes ? c->prog->valores_constantes[k].i : c->novas[k - existentes].i;
+}
+
+static int posicao_tabela(const Constantes *c, int64_t bits) {
+    unsigned mascara = (unsigned)c->capacidade_tabela - 1;
+    unsigned h = (unsigned)(((uint64_t)bits * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & mascara;
+    while (c->tabela[h] && bits_constante(c, c->tabela[h] - 1) != bits)
+        h = (h + 1) & mascara;
+    return (int)h;
+}
+
+static void inserir_constante(Constantes *c, int k) {
+    if (2 * (c->ocupados + 1) > c->capacidade_tabela) {
+        int *antiga = c->tabela;
+        int capacidade_antiga = c->capacidade_tabela;
+        c->capacidade_tabela = capacidade_antiga ? capacidade_antiga * 2 : 64;
+        c->tabela = alocar((size_t)c->capacidade_tabela, sizeof(int));
+        for (int h = 0; h < capacidade_antiga; h++)
+            if (antiga[h])
+                c->tabela[posicao_tabela(c, bits_constante(c, antiga[h] - 1))] = antiga[h];
+        free(antiga);
+    }
+    int h = posicao_tabela(c, bits_constante(c, k));
+    if (!c->tabela[h]) {
+        c->tabela[h] = k + 1;
+        c->ocupados++;
+    }
+}
+
+static void iniciar_constantes(Constantes *c, Programa *p) {
+    memset(c, 0, sizeof(*c));
+    c->prog = p;
+    for (int k = 0; k < p->num_constantes; k++)
+        inserir_constante(c, k);
+}
+
+static int registrador_constante(Constantes *c, Valor v) {
+    const Programa *p = c->prog;
+    int base = p->num_variaveis + p->num_temporarios;
+    int h = c->capacidade_tabela ? posicao_tabela(c, v.i) : 0;
+    if (!c->capacidade_tabela || !c->tabela[h]) {
+        c->novas = crescer(c->novas, &c->capacidade_novas, c->num_novas + 1, sizeof(Valor));
+        c->novas[c->num_novas++] = v;
+        inserir_constante(c, p->num_constantes + c->num_novas - 1);
+        h = posicao_tabela(c, v.i);
+    }
+    return base + c->tabela[h] - 1;
+}
+
+// Acrescenta as constantes novas ao programa.
+static void concluir_constantes(Constantes *c) {
+    Programa *p = c->prog;
+    int total = p->num_constantes + c->num_novas;
+    if (c->num_novas > 0) {
+        p->registradores_constantes = realloc(p->registradores_constantes, (size_t)total * sizeof(int));
+        p->valores_constantes = realloc(p->valores_constantes, (size_t)total * sizeof(Valor));
+        if (!p->registradores_constantes || !p->valores_constantes) {
+            fprintf(stderr, "Erro: memoria insuficiente para a propagacao de constantes.\n");
+            exit(1);
+        }
+        int base = p->num_variaveis + p->num_temporarios;
+        for (int k = p->num_constantes; k < total; k++) {
+            p->registradores_constantes[k] = base + k;
+            p->valores_constantes[k] = c->novas[k - p->num_constantes];
+        }
+        p->num_constantes = total;
+        p->capacidade_constantes = total;
+        p->num_registradores = base + total;
+    }
+    free(c->novas);
+    free(c->tabela);
+}
+
+/* ============================ Reescrita ============================ */
+
+// Instrucoes que ficam mesmo sem ninguem ler o resultado.
+static int essencial(const Programa *p, const Instrucao *ins) {
+    switch (ins->op) {
+        case OP_LER_I: case OP_LER_F: case OP_LER_C:
+        case OP_ESCREVER_I: case OP_ESCREVER_F: case OP_ESCREVER_C:
+        case OP_PARAR: case OP_RETORNAR_I: case OP_RETORNAR_F:
+            return 1;
+        case OP_DIVIDIR_I: {
+            int c = ins->c - (p->num_variaveis + p->num_temporarios);
+            return c < 0 || c >= p->num_constantes || p->registradores_constantes[c] != ins->c ||
+                   p->valores_constantes[c].i == 0;
+        }
+        default:
+            return cfg_alvo(ins) >= 0;
+    }
+}
+
+static int aresta_executavel(const Propagacao *s, int b, int c) {
+    const Cfg *g = s->cfg;
+    for (int e = g->inicio_suc[b]; e < g->inicio_suc[b + 1]; e++)
+        if (g->sucessores[e] == c)
+            return s->aresta_executavel[e];
+    return 0;
+}
+
+// Troca constantes e resolve saltos em 'p->codigo' (o grafo e a SSA
+// continuam valendo: os indices nao mudam) e marca em 'removida' os blocos
+// nao executaveis e os saltos que sobram.
+static void reescrever(const Propagacao *s, Programa *p, Constantes *constantes,
+                       unsigned char *removida, ResultadoSccp *r) {
+    const Cfg *g = s->cfg;
+    const Ssa *ssa = s->ssa;
+    int nb = g->num_blocos, n = p->num_instrucoes;
+    for (int b = 0; b < nb; b++) {
+        if (!s->bloco_executavel[b]) {
+            memset(removida + g->inicio[b], 1, (size_t)(g->inicio[b + 1] - g->inicio[b]));
+            r->blocos_removidos++;
+            continue;
+        }
+        for (int i = g->inicio[b]; i < g->inicio[b + 1]; i++) {
+            Instrucao *ins = &p->codigo[i];
+            int32_t *operandos[3] = { &ins->a, &ins->b, &ins->c };
+            for (int k = 0; k < 3; k++) {
+                int v = ssa->valores[3 * i + k];
+                if (papeis_opcode[ins->op][k] == PAPEL_LIDO && v != SSA_NENHUM &&
+                    s->estado[v] == CONSTANTE)
+                    *operandos[k] = registrador_constante(constantes, s->valor[v]);
+            }
+            int v = ssa->valores[3 * i];
+            if (papeis_opcode[ins->op][0] == PAPEL_ESCRITO && v != SSA_NENHUM &&
+                s->estado[v] == CONSTANTE) {
+                int k = registrador_constante(constantes, s->valor[v]);
+                if (ins->op != OP_MOVER || ins->b != k)
+                    r->resultados_constantes++;
+                ins->op = OP_MOVER;
+                ins->b = k;
+                ins->c = 0;
+            }
+        }
+
+        int ultima = g->inicio[b + 1] - 1;
+        Instrucao *ins = &p->codigo[ultima];
+        int alvo = cfg_alvo(ins);
+        if (alvo < 0 || ins->op == OP_SALTAR || alvo >= n || ultima + 1 >= n)
+            continue;
+        int salta = aresta_executavel(s, b, g->bloco_de[alvo]);
+        int segue = aresta_executavel(s, b, b + 1);
+        if (g->bloco_de[alvo] == b + 1) {
+            removida[ultima] = 1;
+        } else if (salta && !segue) {
+            ins->op = OP_SALTAR;
+            ins->a = alvo;
+            ins->b = ins->c = 0;
+            r->saltos_resolvidos++;
+        } else if (segue && !salta) {
+            removida[ultima] = 1;
+            r->saltos_resolvidos++;
+        }
+    }
+
+    // SALTAR para o proximo bloco que fica vira continuacao.
+    int *proximo = alocar((size_t)nb + 1, sizeof(int));
+    proximo[nb] = nb;
+    for (int b = nb - 1; b >= 0; b--)
+        proximo[b] = s->bloco_executavel[b] ? b : proximo[b + 1];
+    for (int b = 0; b < nb; b++) {
+        int ultima = g->inicio[b + 1] - 1;
+        const Instrucao *ins = &p->codigo[ultima];
+        if (s->bloco_executavel[b] && !removida[ultima] && ins->op == OP_SALTAR &&
+            ins->a < n && proximo[b + 1] == g->bloco_de[ins->a])
+            removida[ultima] = 1;
+    }
+    free(proximo);
+}
+
+// Marca as instrucoes que ficam: as essenciais e, para tras pela SSA, as
+// que escrevem os valores que elas leem (passando pelos phis).
+static void remover_mortas(const Propagacao *s, const Programa *p, unsigned char *removida) {
+    const Cfg *g = s->cfg;
+    const Ssa *ssa = s->ssa;
+    int n = p->num_instrucoes, nr = ssa->num_registradores;
+
+    int *definicao = alocar((size_t)ssa->num_valores, sizeof(int));   // i ou ~f.
+    for (int i = 0; i < n; i++)
+        if (papeis_opcode[p->codigo[i].op][0] == PAPEL_ESCRITO && ssa->valores[3 * i] != SSA_NENHUM)
+            definicao[ssa->valores[3 * i]] = i;
+    for (int f = 0; f < ssa->num_phis; f++)
+        definicao[ssa->phi_valor[f]] = ~f;
+
+    unsigned char *viva = alocar((size_t)n, 1);
+    unsigned char *phi_vivo = alocar((size_t)ssa->num_phis, 1);
+    int *lista = alocar((size_t)n + ssa->num_phis, sizeof(int));
+    int tamanho = 0;
+    for (int i = 0; i < n; i++)
+        if (!removida[i] && essencial(p, &p->codigo[i])) {
+            viva[i] = 1;
+            lista[tamanho++] = i;
+        }
+
+#define MARCAR(valor) do { \
+        int v_ = (valor); \
+        if (v_ >= nr) { \
+            int d_ = definicao[v_]; \
+            if (d_ >= 0 && !viva[d_]) { \
+                viva[d_] = 1; \
+                lista[tamanho++] = d_; \
+            } else if (d_ < 0 && !phi_vivo[~d_]) { \
+                phi_vivo[~d_] = 1; \
+                lista[tamanho++] = d_; \
+            } \
+        } \
+    } while (0)
+
+    while (tamanho > 0) {
+        int u = lista[--tamanho];
+        if (u >= 0) {
+            const Instrucao *ins = &p->codigo[u];
+            const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+            for (int k = 0; k < 3; k++)
+                if (papeis_opcode[ins->op][k] == PAPEL_LIDO && operandos[k] < nr)
+                    MARCAR(ssa->valores[3 * u + k]);
+        } else {
+            int f = ~u, b = s->bloco_phi[f];
+            int num_pred = g->inicio_pred[b + 1] - g->inicio_pred[b];
+            for (int a = ssa->inicio_argumentos[f]; a < ssa->inicio_argumentos[f + 1]; a++) {
+                int j = a - ssa->inicio_argumentos[f];
+                if (ssa->argumentos[a] != SSA_NENHUM &&
+                    (j >= num_pred || s->aresta_executavel[s->aresta_pred[g->inicio_pred[b] + j]]))
+                    MARCAR(ssa->argumentos[a]);
+            }
+        }
+    }
+#undef MARCAR
+
+    for (int i = 0; i < n; i++)
+        removida[i] |= !viva[i];
+    free(definicao);
+    free(viva);
+    free(phi_vivo);
+    free(lista);
+}
+
+ResultadoSccp propagar_constantes(Programa *p) {
+    ResultadoSccp r = { 0, 0, 0, 0 };
+    int n = p->num_instrucoes;
+    if (n == 0)
+        return r;
+
+    Cfg cfg;
+    cfg_construir(&cfg, p);
+    Ssa ssa;
+    ssa_construir(&ssa, &cfg);
+    Propagacao s;
+    iniciar_propagacao(&s, &ssa);
+    propagar(&s);
+
+    Constantes constantes;
+    iniciar_constantes(&constantes, p);
+    unsigned char *removida = alocar((size_t)n, 1);
+    reescrever(&s, p, &constantes, removida, &r);
+    concluir_constantes(&constantes);
+    remover_mortas(&s, p, removida);
+    liberar_propagacao(&s);
+    ssa_liberar(&ssa);
+    cfg_liberar(&cfg);
+
+    // Compacta e corrige os alvos dos saltos.
+    int *novo = alocar((size_t)n + 1, sizeof(int));
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        novo[i] = m;
+        if (!removida[i])
+            p->codigo[m++] = p->codigo[i];
+    }
+    novo[n] = m;
+    p->num_instrucoes = m;
+    for (int i = 0; i < m; i++) {
+        Instrucao *ins = &p->codigo[i];
+        int32_t *operandos[3] = { &ins->a, &ins->b, &ins->c };
+        for (int k = 0; k < 3; k++)
+            if (papeis_opcode[ins->op][k] == PAPEL_ALVO)
+                *operandos[k] = novo[*operandos[k]];
+    }
+    r.instrucoes_removidas = n - m;
+
+    free(novo);
+    free(removida);
+    return r;
+}
@@ -0,0 +1,35 @@
+#ifndef SCCP_H
+#define SCCP_H
+
+#include "vm.h"
+
+/* Propagacao de constantes condicional esparsa (SCCP, Wegman e Zadeck)
+   sobre o bytecode pronto, antes da fusao. O programa passa por cfg.h e
+   ssa.h; cada valor da SSA comeca indefinido (os registradores na entrada
+   valem 0, como na VM) e so desce: indefinido, constante, variado. Duas
+   listas de trabalho andam juntas, a de arestas do grafo que passam a ser
+   executaveis e a de valores que mudaram; um bloco so e avaliado quando
+   alguma aresta chega nele, e um salto com condicao constante so libera o
+   lado que toma. As contas de int e float sao as mesmas da VM; a divisao
+   de int por zero nunca e dobrada (o erro fica para a execucao).
+   Com o resultado, o bytecode e reescrito:
+     - operando lido com valor constante passa a ler um registrador de
+       constante (criado se ainda nao existe);
+     - instrucao com resultado constante vira MOVER da constante;
+     - salto condicional resolvido vira SALTAR ou some, e SALTAR para o
+       bloco que vem logo depois some;
+     - blocos que nenhuma aresta executavel alcanca somem;
+     - instrucoes cujo valor ninguem mais le somem (read, print, saltos,
+       fins e a divisao de int que pode falhar ficam sempre).
+   Os saltos sao corrigidos como na fusao (superinstrucoes.c). */
+
+typedef struct {
+    int instrucoes_removidas;
+    int blocos_removidos;       // Blocos que nenhuma aresta executavel alcanca.
+    int saltos_resolvidos;      // Saltos condicionais com condicao constante.
+    int resultados_constantes;  // Instrucoes trocadas por MOVER de constante.
+} ResultadoSccp;
+
+ResultadoSccp propagar_constantes(Programa *p);
+
+#endif
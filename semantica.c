@@ -0,0 +1,461 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "semantica.h"
+#include "saida.h"
+#include "memoria.h"
+
+void semantica_iniciar(AnalisadorSemantico *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+void semantica_limpar(AnalisadorSemantico *s) {
+    for (int i = 0; i < s->capacidade_tabela; i++)
+        s->tabela[i] = -1;
+    s->tamanho_nomes = 0;
+    s->num_ids = 0;
+    s->num_declaracoes = 0;
+    s->num_desfazer = 0;
+    s->num_marcas = 0;
+    s->declarando = 0;
+    s->num_valores = 0;
+    s->num_operadores = 0;
+    s->num_tipos = 0;
+    s->num_resolucoes = 0;
+    s->num_erros = 0;
+    s->usos = 0;
+}
+
+void semantica_liberar(AnalisadorSemantico *s) {
+    free(s->nomes);
+    free(s->inicio_nome);
+    free(s->tamanho_nome);
+    free(s->hash_nome);
+    free(s->visivel);
+    free(s->tabela);
+    free(s->declaracoes);
+    free(s->desfazer);
+    free(s->marcas);
+    free(s->valores);
+    free(s->operadores);
+    free(s->tipos);
+    free(s->resolucoes);
+    free(s->erros);
+    semantica_iniciar(s);
+}
+
+/* ============================ Internacao ============================ */
+
+// FNV-1a.
+static unsigned hash_nome(const char *nome, int tamanho) {
+    unsigned h = 2166136261u;
+    for (int i = 0; i < tamanho; i++) {
+        h ^= (unsigned char)nome[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Dobra a tabela e reinsere os ids pelo hash guardado.
+static void redistribuir(AnalisadorSemantico *s) {
+    int nova = s->capacidade_tabela ? s->capacidade_tabela * 2 : 1024;
+    int *tabela = malloc((size_t)nova * sizeof(int));
+    if (!tabela) {
+        fprintf(stderr, "Erro: memoria insuficiente para a tabela de simbolos.\n");
+        exit(1);
+    }
+    for (int i = 0; i < nova; i++)
+        tabela[i] = -1;
+    unsigned mascara = (unsigned)nova - 1;
+    for (int id = 0; id < s->num_ids; id++) {
+        unsigned i = s->hash_nome[id] & mascara;
+        while (tabela[i] >= 0)
+            i = (i + 1) & mascara;
+        tabela[i] = id;
+    }
+    free(s->tabela);
+    s->tabela = tabela;
+    s->capacidade_tabela = nova;
+}
+
+// Retorna o id do nome, criando-o na primeira ocorrencia.
+static int internar(AnalisadorSemantico *s, const char *nome, int tamanho) {
+    // Ocupacao de no maximo 1/2: sondagens curtas.
+    if (2 * (s->num_ids + 1) > s->capacidade_tabela)
+        redistribuir(s);
+
+    unsigned h = hash_nome(nome, tamanho);
+    unsigned mascara = (unsigned)s->capacidade_tabela - 1;
+    unsigned i = h & mascara;
+    for (;;) {
+        int id = s->tabela[i];
+        if (id < 0)
+            break;
+        if (s->hash_nome[id] == h && s->tamanho_nome[id] == tamanho &&
+            memcmp(s->nomes + s->inicio_nome[id], nome, (size_t)tamanho) == 0)
+            return id;
+        i = (i + 1) & mascara;
+    }
+
+    int id = s->num_ids;
+    int capacidade = s->capacidade_ids;
+    s->inicio_nome = crescer(s->inicio_nome, &capacidade, id + 1, sizeof(size_t));
+    capacidade = s->capacidade_ids;
+    s->tamanho_nome = crescer(s->tamanho_nome, &capacidade, id + 1, sizeof(int));
+    capacidade = s->capacidade_ids;
+    s->hash_nome = crescer(s->hash_nome, &capacidade, id + 1, sizeof(unsigned));
+    s->visivel = crescer(s->visivel, &s->capacidade_ids, id + 1, sizeof(int));
+
+    if (s->tamanho_nomes + (size_t)tamanho > s->capacidade_nomes) {
+        size_t nova = s->capacidade_nomes ? s->capacidade_nomes : 4096;
+        while (nova < s->tamanho_nomes + (size_t)tamanho)
+            nova *= 2;
+        char *nomes = realloc(s->nomes, nova);
+        if (!nomes) {
+            fprintf(stderr, "Erro: memoria insuficiente para a tabela de simbolos.\n");
+            exit(1);
+        }
+        s->nomes = nomes;
+        s->capacidade_nomes = nova;
+    }
+    memcpy(s->nomes + s->tamanho_nomes, nome, (size_t)tamanho);
+    s->inicio_nome[id] = s->tamanho_nomes;
+    s->tamanho_nomes += (size_t)tamanho;
+    s->tamanho_nome[id] = tamanho;
+    s->hash_nome[id] = h;
+    s->visivel[id] = -1;
+    s->tabela[i] = id;
+    s->num_ids++;
+    return id;
+}
+
+const char *semantica_nome(const AnalisadorSemantico *s, int id, int *tamanho) {
+    *tamanho = s->tamanho_nome[id];
+    return s->nomes + s->inicio_nome[id];
+}
+
+/* ============================ Escopos ============================ */
+
+static ErroSemantico *registrar_erro(AnalisadorSemantico *s, TipoErroSemantico tipo, int id,
+                                     int indice_token, int token_anterior) {
+    s->erros = crescer(s->erros, &s->capacidade_erros, s->num_erros + 1, sizeof(ErroSemantico));
+    ErroSemantico *e = &s->erros[s->num_erros++];
+    e->tipo = tipo;
+    e->id = id;
+    e->indice_token = indice_token;
+    e->token_anterior = token_anterior;
+    e->esperado = TIPO_INDEFINIDO;
+    e->encontrado = TIPO_INDEFINIDO;
+    return e;
+}
+
+static void abrir_escopo(AnalisadorSemantico *s) {
+    s->marcas = crescer(s->marcas, &s->capacidade_marcas, s->num_marcas + 1, sizeof(int));
+    s->marcas[s->num_marcas++] = s->num_desfazer;
+}
+
+static void fechar_escopo(AnalisadorSemantico *s) {
+    if (s->num_marcas == 0)
+        return; // So acontece na recuperacao de erros sintaticos.
+    int marca = s->marcas[--s->num_marcas];
+    while (s->num_desfazer > marca) {
+        const Declaracao *d = &s->declaracoes[s->desfazer[--s->num_desfazer]];
+        s->visivel[d->id] = d->anterior;
+    }
+}
+
+static void declarar(AnalisadorSemantico *s, int id, int indice_token) {
+    if (s->tipo_declarado == TIPO_VOID)
+        registrar_erro(s, SEM_VARIAVEL_VOID, id, indice_token, -1);
+    int atual = s->visivel[id];
+    if (atual >= 0 && s->declaracoes[atual].nivel == s->num_marcas) {
+        registrar_erro(s, SEM_REDECLARADA, id, indice_token, s->declaracoes[atual].indice_token);
+        return;
+    }
+    int k = s->num_declaracoes;
+    s->declaracoes = crescer(s->declaracoes, &s->capacidade_declaracoes, k + 1, sizeof(Declaracao));
+    s->declaracoes[k].id = id;
+    s->declaracoes[k].nivel = s->num_marcas;
+    s->declaracoes[k].indice_token = indice_token;
+    s->declaracoes[k].anterior = atual;
+    s->declaracoes[k].tipo = s->tipo_declarado;
+    s->num_declaracoes++;
+
+    s->desfazer = crescer(s->desfazer, &s->capacidade_desfazer, s->num_desfazer + 1, sizeof(int));
+    s->desfazer[s->num_desfazer++] = k;
+    s->visivel[id] = k;
+}
+
+/* ============================ Tipos ============================ */
+
+const char *nome_tipo(TipoDado tipo) {
+    switch (tipo) {
+        case TIPO_CHAR:  return "char";
+        case TIPO_INT:   return "int";
+        case TIPO_FLOAT: return "float";
+        case TIPO_VOID:  return "void";
+        default:         return "indefinido";
+    }
+}
+
+static void anotar(AnalisadorSemantico *s, int indice_token, TipoDado tipo) {
+    if (indice_token >= s->num_tipos) {
+        s->tipos = crescer(s->tipos, &s->capacidade_tipos, indice_token + 1, 1);
+        memset(s->tipos + s->num_tipos, TIPO_INDEFINIDO, (size_t)(indice_token + 1 - s->num_tipos));
+        s->num_tipos = indice_token + 1;
+    }
+    s->tipos[indice_token] = (unsigned char)tipo;
+}
+
+// Lembra a declaracao do T_ID 'indice_token': sempre em 'ultima_resolucao'
+// (para quem traduz na mesma passada) e, com 'guardar_resolucoes', por token.
+static void resolver(AnalisadorSemantico *s, int indice_token, int declaracao) {
+    s->ultima_resolucao = declaracao;
+    if (!s->guardar_resolucoes)
+        return;
+    if (indice_token >= s->num_resolucoes) {
+        s->resolucoes = crescer(s->resolucoes, &s->capacidade_resolucoes, indice_token + 1,
+                                sizeof(int));
+        for (int i = s->num_resolucoes; i <= indice_token; i++)
+            s->resolucoes[i] = -1;
+        s->num_resolucoes = indice_token + 1;
+    }
+    s->resolucoes[indice_token] = declaracao;
+}
+
+static void empilhar_valor(AnalisadorSemantico *s, TipoDado tipo, int id, int indice_token) {
+    s->valores = crescer(s->valores, &s->capacidade_valores, s->num_valores + 1, sizeof(ValorTipado));
+    ValorTipado *v = &s->valores[s->num_valores++];
+    v->tipo = tipo;
+    v->id = id;
+    v->indice_token = indice_token;
+}
+
+static ValorTipado desempilhar_valor(AnalisadorSemantico *s) {
+    if (s->num_valores == 0) {
+        // So acontece na recuperacao de erros sintaticos.
+        ValorTipado vazio = { TIPO_INDEFINIDO, -1, -1 };
+        return vazio;
+    }
+    return s->valores[--s->num_valores];
+}
+
+// Tipo de uma variavel numa expressao: void vira indefinido (o erro ja
+// foi relatado na declaracao).
+static TipoDado tipo_da_declaracao(const AnalisadorSemantico *s, int declaracao) {
+    if (declaracao < 0)
+        return TIPO_INDEFINIDO;
+    TipoDado tipo = s->declaracoes[declaracao].tipo;
+    return tipo == TIPO_VOID ? TIPO_INDEFINIDO : tipo;
+}
+
+static TipoDado tipo_do_lexema(const char *lexema) {
+    switch (lexema[0]) {
+        case 'c': return TIPO_CHAR;
+        case 'i': return TIPO_INT;
+        case 'f': return TIPO_FLOAT;
+        case 'v': return TIPO_VOID;
+        default:  return TIPO_INDEFINIDO;
+    }
+}
+
+// 'alvo' = 'valor': os dois tipos tem de ser iguais.
+static void verificar_atribuicao(AnalisadorSemantico *s, ValorTipado alvo, ValorTipado valor) {
+    if (alvo.tipo == TIPO_INDEFINIDO || valor.tipo == TIPO_INDEFINIDO || alvo.tipo == valor.tipo)
+        return;
+    ErroSemantico *e = registrar_erro(s, SEM_TIPOS_MISTURADOS, alvo.id, alvo.indice_token, -1);
+    e->esperado = alvo.tipo;
+    e->encontrado = valor.tipo;
+}
+
+// Producoes cujo corpo comeca por um operador (ou pelo '(' de FATOR): o
+// token do operador representa a subexpressao e recebe o tipo dela.
+static int producao_de_operador(int producao) {
+    const Producao *prod = &producoes[producao];
+    if (prod->tam_corpo == 0)
+        return 0;
+    switch (prod->corpo[0]) {
+        case T_SOMA: case T_SUB: case T_MUL: case T_DIV:
+        case T_OP_COM: case T_OP_LOG: case T_NOT:
+            return 1;
+        case T_PA:
+            return prod->cabeca == SIM_NAOTERMINAL(NT_FATOR);
+        default:
+            return 0;
+    }
+}
+
+// Fecha o operador aberto mais interno sobre a pilha de tipos.
+static void combinar(AnalisadorSemantico *s) {
+    if (s->num_operadores == 0)
+        return; // So acontece na recuperacao de erros sintaticos.
+    OperadorAberto aberto = s->operadores[--s->num_operadores];
+    int operador = aberto.indice_token;
+    int producao = aberto.producao;
+    ValorTipado direita = desempilhar_valor(s);
+    TipoDado tipo;
+    switch (producoes[producao].corpo[0]) {
+        case T_PA:
+            tipo = direita.tipo;
+            break;
+        case T_NOT:
+            tipo = direita.tipo == TIPO_INDEFINIDO ? TIPO_INDEFINIDO : TIPO_INT;
+            break;
+        case T_OP_COM:
+        case T_OP_LOG: {
+            ValorTipado esquerda = desempilhar_valor(s);
+            tipo = esquerda.tipo == TIPO_INDEFINIDO || direita.tipo == TIPO_INDEFINIDO
+                       ? TIPO_INDEFINIDO : TIPO_INT;
+            break;
+        }
+        default: {
+            // Aritmetica: o maior tipo dos dois lados.
+            ValorTipado esquerda = desempilhar_valor(s);
+            if (esquerda.tipo == TIPO_INDEFINIDO || direita.tipo == TIPO_INDEFINIDO)
+                tipo = TIPO_INDEFINIDO;
+            else
+                tipo = esquerda.tipo > direita.tipo ? esquerda.tipo : direita.tipo;
+            break;
+        }
+    }
+    empilhar_valor(s, tipo, -1, operador);
+    anotar(s, operador, tipo);
+}
+
+/* ============================ Eventos ============================ */
+
+static void semantica_entrar(void *contexto, int nt, int producao, int indice_token) {
+    AnalisadorSemantico *s = contexto;
+    if (nt == NT_MAIN_FUNC || nt == NT_BLOCO) {
+        abrir_escopo(s);
+    } else if (nt == NT_DECLARACAO_VAR) {
+        s->declarando = 1;
+        s->tipo_declarado = TIPO_INDEFINIDO;
+    } else {
+        // Em a - b - c o operando da direita de um operador de lista acaba
+        // quando a cauda seguinte comeca: fechar ali associa da esquerda
+        // para a direita, como na execucao. Um '(' no topo separa listas
+        // aninhadas do mesmo NT.
+        if (lista_recursiva[nt] && s->num_operadores > 0 &&
+            producoes[s->operadores[s->num_operadores - 1].producao].cabeca == SIM_NAOTERMINAL(nt))
+            combinar(s);
+        if (producao_de_operador(producao)) {
+            s->operadores = crescer(s->operadores, &s->capacidade_operadores,
+                                    s->num_operadores + 1, sizeof(OperadorAberto));
+            s->operadores[s->num_operadores].indice_token = indice_token;
+            s->operadores[s->num_operadores].producao = producao;
+            s->num_operadores++;
+        }
+    }
+}
+
+static void semantica_sair(void *contexto, int nt, int producao, int indice_token) {
+    AnalisadorSemantico *s = contexto;
+    (void)indice_token;
+    switch (nt) {
+        case NT_MAIN_FUNC:
+        case NT_BLOCO:
+            fechar_escopo(s);
+            break;
+        case NT_DECL_VAR_CAUDA:
+            // "= expressao ;": o nome declarado esta logo abaixo.
+            if (producoes[producao].tam_corpo > 1) {
+                ValorTipado valor = desempilhar_valor(s);
+                if (s->num_valores > 0)
+                    verificar_atribuicao(s, s->valores[s->num_valores - 1], valor);
+            }
+            break;
+        case NT_ATRIBUICAO:
+        case NT_ATRIBUICAO_SIMPLES: {
+            ValorTipado valor = desempilhar_valor(s);
+            verificar_atribuicao(s, desempilhar_valor(s), valor);
+            break;
+        }
+        case NT_DECLARACAO_VAR:
+        case NT_COMANDO_LEITURA:
+        case NT_COMANDO_ESCRITA:
+        case NT_COMANDO_RETORNO:
+        case NT_COMANDO_SE:
+        case NT_COMANDO_ENQUANTO:
+        case NT_COMANDO_PARA:
+            // Nome declarado, variavel lida, valor ou condicao.
+            desempilhar_valor(s);
+            break;
+        default:
+            // Operadores de lista ja foram fechados na entrada da cauda.
+            if (producao_de_operador(producao) && !lista_recursiva[nt])
+                combinar(s);
+            break;
+    }
+}
+
+static void semantica_casar(void *contexto, int token, int indice_token,
+                            const char *lexema, int tamanho) {
+    AnalisadorSemantico *s = contexto;
+    if (token == T_NUM) {
+        TipoDado tipo = memchr(lexema, '.', (size_t)tamanho) ? TIPO_FLOAT : TIPO_INT;
+        empilhar_valor(s, tipo, -1, indice_token);
+        anotar(s, indice_token, tipo);
+        return;
+    }
+    if (token == T_TIPO) {
+        if (s->declarando)
+            s->tipo_declarado = tipo_do_lexema(lexema);
+        return;
+    }
+    if (token != T_ID)
+        return;
+    int id = internar(s, lexema, tamanho);
+    if (s->declarando) {
+        s->declarando = 0;
+        declarar(s, id, indice_token);
+        TipoDado tipo = s->tipo_declarado == TIPO_VOID ? TIPO_INDEFINIDO : s->tipo_declarado;
+        empilhar_valor(s, tipo, id, indice_token);
+        anotar(s, indice_token, tipo);
+        resolver(s, indice_token, s->visivel[id]);
+    } else {
+        s->usos++;
+        if (s->visivel[id] < 0)
+            registrar_erro(s, SEM_NAO_DECLARADA, id, indice_token, -1);
+        TipoDado tipo = tipo_da_declaracao(s, s->visivel[id]);
+        empilhar_valor(s, tipo, id, indice_token);
+        anotar(s, indice_token, tipo);
+        resolver(s, indice_token, s->visivel[id]);
+    }
+}
+
+ReceptorEventos semantica_receptor(AnalisadorSemantico *s) {
+    ReceptorEventos r = { semantica_entrar, semantica_sair, semantica_casar, NULL, s };
+    return r;
+}
+
+int semantica_relatar(const AnalisadorSemantico *s, int relatar_erros) {
+    for (int i = 0; relatar_erros && i < s->num_erros; i++) {
+        const ErroSemantico *e = &s->erros[i];
+        int tamanho;
+        const char *nome = semantica_nome(s, e->id, &tamanho);
+        switch (e->tipo) {
+            case SEM_NAO_DECLARADA:
+                saida_diagnostico_semantico(e->indice_token, "variavel '%.*s' nao declarada",
+                                            tamanho, nome);
+                break;
+            case SEM_REDECLARADA:
+                saida_diagnostico_semantico(e->indice_token,
+                                            "variavel '%.*s' ja declarada neste escopo (token %d)",
+                                            tamanho, nome, e->token_anterior);
+                break;
+            case SEM_VARIAVEL_VOID:
+                saida_diagnostico_semantico(e->indice_token,
+                                            "variavel '%.*s' declarada como void", tamanho, nome);
+                break;
+            case SEM_TIPOS_MISTURADOS:
+                saida_diagnostico_semantico(e->indice_token,
+                                            "atribuicao de %s a variavel '%.*s' do tipo %s",
+                                            nome_tipo(e->encontrado), tamanho, nome,
+                                            nome_tipo(e->esperado));
+                break;
+        }
+    }
+    saida_resultado_semantico(s->num_erros);
+    return s->num_erros;
+}
@@ -0,0 +1,154 @@
+#ifndef SEMANTICA_H
+#define SEMANTICA_H
+
+#include "parser.h"
+
+/* Analise semantica de declaracoes, feita na mesma passada da analise
+   sintatica (e um receptor de eventos, sem arvore).
+   Cada identificador e internado uma vez numa tabela hash de enderecamento
+   aberto e vira um id denso. O id indexa 'visivel', a declaracao que o nome
+   resolve agora, entao resolver um T_ID e uma sondagem na tabela e uma
+   leitura de vetor. Declarar empilha a declaracao num registro de desfazer.
+   Sair de um BLOCO desempilha ate a marca do escopo e restaura o que cada
+   declaracao escondia. Nenhum escopo aloca tabela propria: todos os vetores
+   crescem por duplicacao e sao reaproveitados entre programas.
+   Relata variaveis nao declaradas e redeclaradas no mesmo escopo.
+
+   Na mesma passada verifica os tipos. Uma pilha de tipos acompanha as
+   expressoes: operandos empilham o seu tipo ao casar, e cada operador
+   combina o topo quando o seu operando da direita acaba (da esquerda para
+   a direita: em a * b / c, o '*' tem o tipo de a * b). Cada subexpressao tem um token que a
+   representa (o operando, o operador, o '(' ou o '!'), e o tipo dela fica
+   em 'tipos', um byte por token, sem dados por no. Fases seguintes leem
+   esse vetor (semantica_tipo_token) para escolher operacoes de int ou de
+   float. Relata variaveis void e atribuicoes entre tipos diferentes. */
+
+typedef enum {
+    SEM_NAO_DECLARADA,
+    SEM_REDECLARADA,
+    SEM_VARIAVEL_VOID,
+    SEM_TIPOS_MISTURADOS
+} TipoErroSemantico;
+
+// Ordem de promocao: char < int < float. TIPO_INDEFINIDO marca expressoes
+// com erro ja relatado (e tokens sem tipo) e nao gera novos erros.
+typedef enum {
+    TIPO_INDEFINIDO = 0,
+    TIPO_CHAR,
+    TIPO_INT,
+    TIPO_FLOAT,
+    TIPO_VOID
+} TipoDado;
+
+typedef struct {
+    int id;             // Identificador internado.
+    int nivel;          // Profundidade do escopo (1 = corpo do main).
+    int indice_token;   // Token do nome na declaracao.
+    int anterior;       // Declaracao que esta esconde (-1 se nenhuma).
+    TipoDado tipo;
+} Declaracao;
+
+typedef struct {
+    TipoErroSemantico tipo;
+    int id;
+    int indice_token;
+    int token_anterior; // Para SEM_REDECLARADA: a declaracao que ja existia.
+    TipoDado esperado;  // Para SEM_TIPOS_MISTURADOS: tipo da variavel
+    TipoDado encontrado; // e tipo da expressao.
+} ErroSemantico;
+
+// Operador cuja subexpressao ainda nao foi fechada.
+typedef struct {
+    int indice_token;
+    int producao;
+} OperadorAberto;
+
+// Entrada da pilha de tipos.
+typedef struct {
+    TipoDado tipo;
+    int id;             // Variavel, se a entrada e um T_ID (senao -1).
+    int indice_token;
+} ValorTipado;
+
+typedef struct {
+    // Internacao: nomes concatenados em 'nomes'; a tabela guarda ids.
+    char *nomes;
+    size_t tamanho_nomes;
+    size_t capacidade_nomes;
+    size_t *inicio_nome;        // Por id.
+    int *tamanho_nome;          // Por id.
+    unsigned *hash_nome;        // Por id, para redistribuir sem recalcular.
+    int *visivel;               // Por id: declaracao visivel ou -1.
+    int num_ids;
+    int capacidade_ids;
+    int *tabela;                // Slots com id ou -1; capacidade potencia de 2.
+    int capacidade_tabela;
+
+    // Escopos.
+    Declaracao *declaracoes;    // Todas as declaracoes, na ordem do texto.
+    int num_declaracoes;
+    int capacidade_declaracoes;
+    int *desfazer;              // Declaracoes dos escopos abertos.
+    int num_desfazer;
+    int capacidade_desfazer;
+    int *marcas;                // Tamanho de 'desfazer' na entrada de cada escopo.
+    int num_marcas;
+    int capacidade_marcas;
+    int declarando;             // O proximo T_ID e o nome de uma declaracao.
+    TipoDado tipo_declarado;    // Tipo lido na declaracao em curso.
+
+    // Tipos.
+    ValorTipado *valores;       // Pilha de tipos das expressoes abertas.
+    int num_valores;
+    int capacidade_valores;
+    OperadorAberto *operadores;
+    int num_operadores;
+    int capacidade_operadores;
+    unsigned char *tipos;       // TipoDado por indice de token.
+    int num_tipos;
+    int capacidade_tipos;
+    // Declaracao de cada T_ID, por indice de token (-1 nos demais). So e
+    // preenchido com 'guardar_resolucoes', para quem gera codigo.
+    int guardar_resolucoes;
+    int ultima_resolucao;       // Declaracao do ultimo T_ID casado (-1 se nenhuma).
+    int *resolucoes;
+    int num_resolucoes;
+    int capacidade_resolucoes;
+
+    ErroSemantico *erros;
+    int num_erros;
+    int capacidade_erros;
+    long usos;                  // T_IDs resolvidos.
+} AnalisadorSemantico;
+
+void semantica_iniciar(AnalisadorSemantico *s);
+// Esquece o programa anterior mantendo a memoria para reuso.
+void semantica_limpar(AnalisadorSemantico *s);
+void semantica_liberar(AnalisadorSemantico *s);
+
+// Receptor que alimenta 's' durante a analise sintatica.
+ReceptorEventos semantica_receptor(AnalisadorSemantico *s);
+
+// Tipo anotado no token 'indice_token' (TIPO_INDEFINIDO se nenhum).
+static inline TipoDado semantica_tipo_token(const AnalisadorSemantico *s, int indice_token) {
+    return indice_token >= 0 && indice_token < s->num_tipos
+               ? (TipoDado)s->tipos[indice_token] : TIPO_INDEFINIDO;
+}
+
+// Declaracao (indice em 'declaracoes') a que o T_ID 'indice_token' se refere.
+static inline int semantica_declaracao_token(const AnalisadorSemantico *s, int indice_token) {
+    return indice_token >= 0 && indice_token < s->num_resolucoes
+               ? s->resolucoes[indice_token] : -1;
+}
+
+const char *nome_tipo(TipoDado tipo);
+
+// Nome do identificador 'id' (nao terminado em '\0').
+const char *semantica_nome(const AnalisadorSemantico *s, int id, int *tamanho);
+
+// Com 'relatar_erros', envia os erros para saida_diagnostico_semantico;
+// depois escreve o veredito com saida_resultado_semantico. So faz sentido
+// se nao houve erro sintatico. Retorna o numero de erros.
+int semantica_relatar(const AnalisadorSemantico *s, int relatar_erros);
+
+#endif
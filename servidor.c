@@ -0,0 +1,330 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "parser.h"
+#include "protocolo_servidor.h"
+#include "servidor.h"
+#include "estatisticas.h"
+
+/* ============================
+   E/S completa sobre o socket
+   ============================ */
+
+static int ler_tudo(int fd, void *destino, size_t n) {
+    char *p = destino;
+    while (n > 0) {
+        ssize_t r = read(fd, p, n);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            return 0;
+        p += r;
+        n -= (size_t)r;
+    }
+    return 1;
+}
+
+static int escrever_tudo(int fd, const void *origem, size_t n) {
+    const char *p = origem;
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR)
+            continue;
+        if (w <= 0)
+            return 0;
+        p += w;
+        n -= (size_t)w;
+    }
+    return 1;
+}
+
+/* ============================
+   Estado de cada conexao
+   ============================ */
+
+// Buffers mantidos entre os pedidos de uma conexao: so crescem.
+typedef struct {
+    char *carga;           // Carga do pedido (texto ou caminho).
+    size_t capacidade_carga;
+    char *arquivo;         // Conteudo de arquivo pedido por caminho.
+    size_t capacidade_arquivo;
+    Pilha pilha;
+} EstadoServidor;
+
+static int garantir_capacidade(char **buffer, size_t *capacidade, size_t necessario) {
+    if (necessario <= *capacidade)
+        return 1;
+    size_t nova = *capacidade ? *capacidade : 65536;
+    while (nova < necessario)
+        nova *= 2;
+    char *dados = realloc(*buffer, nova);
+    if (!dados)
+        return 0;
+    *buffer = dados;
+    *capacidade = nova;
+    return 1;
+}
+
+// Le um arquivo para o buffer residente. Retorna -1 em falha.
+static long carregar_arquivo(EstadoServidor *e, const char *caminho) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo)
+        return -1;
+    size_t lidos = 0;
+    for (;;) {
+        if (!garantir_capacidade(&e->arquivo, &e->capacidade_arquivo, lidos + 65536)) {
+            fclose(arquivo);
+            return -1;
+        }
+        size_t n = fread(e->arquivo + lidos, 1, e->capacidade_arquivo - lidos, arquivo);
+        if (n == 0)
+            break;
+        lidos += n;
+    }
+    fclose(arquivo);
+    return (long)lidos;
+}
+
+static int verificar_texto(EstadoServidor *e, const char *texto, size_t tamanho) {
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, texto, tamanho);
+    FonteTokens fonte = fonte_lexer_reentrante(&lx);
+    return analisar_entrada(&e->pilha, &fonte, NULL, 0);
+}
+
+// Atende os pedidos de uma conexao ate ela fechar (ou ficar ociosa alem
+// do tempo limite de leitura). Retorna 1 se o cliente pediu para encerrar.
+static int atender_conexao(EstadoServidor *e, int fd) {
+    CabecalhoPedido cab;
+    while (ler_tudo(fd, &cab, sizeof(cab))) {
+        double inicio = relogio_monotonico();
+        RespostaServidor resp = { RESPOSTA_PEDIDO_INVALIDO, 0 };
+
+        if (cab.magico != PROTOCOLO_MAGICO)
+            return 0; // Conversa corrompida: descarta a conexao.
+
+        if (cab.tipo == PEDIDO_ENCERRAR) {
+            resp.erros = 0;
+            escrever_tudo(fd, &resp, sizeof(resp));
+            return 1;
+        }
+
+        // +1 para o '\0' do caminho.
+        if (!garantir_capacidade(&e->carga, &e->capacidade_carga, (size_t)cab.tamanho + 1) ||
+            !ler_tudo(fd, e->carga, cab.tamanho))
+            return 0;
+        e->carga[cab.tamanho] = '\0';
+
+        if (cab.tipo == PEDIDO_BUFFER) {
+            resp.erros = verificar_texto(e, e->carga, cab.tamanho);
+        } else if (cab.tipo == PEDIDO_CAMINHO) {
+            long tamanho = carregar_arquivo(e, e->carga);
+            resp.erros = tamanho < 0 ? RESPOSTA_ARQUIVO_ILEGIVEL
+                                     : verificar_texto(e, e->arquivo, (size_t)tamanho);
+        }
+
+        resp.microssegundos = (uint32_t)((relogio_monotonico() - inicio) * 1e6);
+        if (!escrever_tudo(fd, &resp, sizeof(resp)))
+            return 0;
+    }
+    return 0;
+}
+
+/* ============================
+   Conexoes concorrentes
+   ============================ */
+
+// Uma thread por conexao: um cliente que segura o socket aberto (um editor)
+// nao atrasa os outros (um hook de pre-commit). As tabelas LL(1) sao
+// compartilhadas somente para leitura, como em --threads.
+#define MAX_CONEXOES 64
+// Uma conexao que fica esse tempo sem mandar pedido (ou sem ler a
+// resposta) e descartada.
+#define SEGUNDOS_OCIOSO 30
+
+typedef struct {
+    pthread_mutex_t trava;
+    pthread_cond_t mudou;       // Uma conexao terminou ou pediu encerramento.
+    int fds[MAX_CONEXOES];      // Conexoes abertas.
+    int num_fds;
+    int encerrar;
+    int aviso[2];               // Pipe que acorda o laco de accept.
+} Conexoes;
+
+typedef struct {
+    Conexoes *c;
+    int fd;
+} Conexao;
+
+static void *executar_conexao(void *arg) {
+    Conexao *cx = arg;
+    Conexoes *c = cx->c;
+    int fd = cx->fd;
+    free(cx);
+
+    EstadoServidor estado = { NULL, 0, NULL, 0, { NULL, 0, -1 } };
+    int encerrar = atender_conexao(&estado, fd);
+    pilha_liberar(&estado.pilha);
+    free(estado.carga);
+    free(estado.arquivo);
+
+    pthread_mutex_lock(&c->trava);
+    for (int i = 0; i < c->num_fds; i++) {
+        if (c->fds[i] == fd) {
+            c->fds[i] = c->fds[--c->num_fds];
+            break;
+        }
+    }
+    close(fd);
+    if (encerrar && !c->encerrar) {
+        c->encerrar = 1;
+        if (write(c->aviso[1], "", 1) < 0)
+            perror("write");
+    }
+    pthread_cond_broadcast(&c->mudou);
+    pthread_mutex_unlock(&c->trava);
+    return NULL;
+}
+
+// Registra a conexao e cria a thread que a atende. Sem thread, a conexao
+// e fechada: o cliente ve o fim do socket e pode tentar de novo.
+static void abrir_conexao(Conexoes *c, int fd) {
+    struct timeval limite = { SEGUNDOS_OCIOSO, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &limite, sizeof(limite));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &limite, sizeof(limite));
+
+    Conexao *cx = malloc(sizeof(Conexao));
+    if (!cx) {
+        close(fd);
+        return;
+    }
+    cx->c = c;
+    cx->fd = fd;
+
+    pthread_mutex_lock(&c->trava);
+    c->fds[c->num_fds++] = fd;
+    pthread_t thread;
+    int erro = pthread_create(&thread, NULL, executar_conexao, cx);
+    if (erro == 0) {
+        pthread_detach(thread);
+    } else {
+        c->num_fds--;
+        close(fd);
+        free(cx);
+        fprintf(stderr, "Aviso: conexao recusada (pthread_create: %s).\n", strerror(erro));
+    }
+    pthread_mutex_unlock(&c->trava);
+}
+
+int executar_servidor(const char *caminho_socket) {
+    struct sockaddr_un endereco;
+    if (strlen(caminho_socket) >= sizeof(endereco.sun_path)) {
+        fprintf(stderr, "Erro: caminho do socket muito longo.\n");
+        return 1;
+    }
+
+    // So um socket antigo (de uma execucao que caiu) pode ser removido;
+    // qualquer outra coisa no caminho e um engano do usuario.
+    struct stat st;
+    if (lstat(caminho_socket, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "Erro: '%s' existe e nao e um socket.\n", caminho_socket);
+            return 1;
+        }
+        if (unlink(caminho_socket) < 0) {
+            perror("unlink");
+            return 1;
+        }
+    } else if (errno != ENOENT) {
+        perror("lstat");
+        return 1;
+    }
+
+    int servidor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (servidor < 0) {
+        perror("socket");
+        return 1;
+    }
+    memset(&endereco, 0, sizeof(endereco));
+    endereco.sun_family = AF_UNIX;
+    strcpy(endereco.sun_path, caminho_socket);
+    if (bind(servidor, (struct sockaddr *)&endereco, sizeof(endereco)) < 0 ||
+        listen(servidor, 64) < 0) {
+        perror("bind/listen");
+        close(servidor);
+        return 1;
+    }
+
+    // Um cliente que fecha cedo nao deve derrubar o servidor.
+    signal(SIGPIPE, SIG_IGN);
+    fprintf(stderr, "Servidor ouvindo em %s\n", caminho_socket);
+
+    Conexoes c;
+    if (pipe(c.aviso) < 0) {
+        perror("pipe");
+        close(servidor);
+        return 1;
+    }
+    pthread_mutex_init(&c.trava, NULL);
+    pthread_cond_init(&c.mudou, NULL);
+    c.num_fds = 0;
+    c.encerrar = 0;
+
+    for (;;) {
+        // Com o limite de conexoes atingido, espera alguma terminar; as
+        // novas ficam na fila do listen.
+        pthread_mutex_lock(&c.trava);
+        while (c.num_fds == MAX_CONEXOES && !c.encerrar)
+            pthread_cond_wait(&c.mudou, &c.trava);
+        int encerrar = c.encerrar;
+        pthread_mutex_unlock(&c.trava);
+        if (encerrar)
+            break;
+
+        struct pollfd eventos[2] = { { servidor, POLLIN, 0 }, { c.aviso[0], POLLIN, 0 } };
+        if (poll(eventos, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            perror("poll");
+            break;
+        }
+        if (eventos[1].revents)
+            continue; // Pedido de encerramento: conferido no topo do laco.
+        int fd = accept(servidor, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            perror("accept");
+            break;
+        }
+        abrir_conexao(&c, fd);
+    }
+
+    close(servidor);
+    unlink(caminho_socket);
+
+    // Fecha a leitura das conexoes ainda abertas: quem espera um pedido ve
+    // o fim do socket, quem esta no meio de um termina de responder.
+    pthread_mutex_lock(&c.trava);
+    for (int i = 0; i < c.num_fds; i++)
+        shutdown(c.fds[i], SHUT_RD);
+    while (c.num_fds > 0)
+        pthread_cond_wait(&c.mudou, &c.trava);
+    pthread_mutex_unlock(&c.trava);
+
+    close(c.aviso[0]);
+    close(c.aviso[1]);
+    pthread_mutex_destroy(&c.trava);
+    pthread_cond_destroy(&c.mudou);
+    return 0;
+}
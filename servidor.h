@@ -0,0 +1,15 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+/* Servidor de verificacao residente: mantem as tabelas LL(1) (ja
+   preparadas) e buffers aquecidos, e responde pedidos do protocolo de
+   protocolo_servidor.h num socket Unix. Cada conexao e atendida na sua
+   propria thread, com pilha e buffers proprios, e e descartada se ficar
+   ociosa (sem pedido ou sem ler a resposta) alem do tempo limite. */
+
+// Atende pedidos em 'caminho_socket' ate receber PEDIDO_ENCERRAR; as
+// conexoes abertas terminam o pedido em curso antes de o servidor sair.
+// Retorna o codigo de saida do processo.
+int executar_servidor(const char *caminho_socket);
+
+#endif
@@ -0,0 +1,466 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssa.h"
+#include "estatisticas.h"
+#include "memoria.h"
+
+static void *alocar(size_t quantidade, size_t tamanho_item) {
+    void *dados = calloc(quantidade ? quantidade : 1, tamanho_item);
+    if (!dados) {
+        fprintf(stderr, "Erro: memoria insuficiente para a forma SSA.\n");
+        exit(1);
+    }
+    return dados;
+}
+
+// Vetor de 'quantidade' inteiros, todos com 'valor'.
+static int *preencher(size_t quantidade, int valor) {
+    int *dados = alocar(quantidade, sizeof(int));
+    for (size_t i = 0; i < quantidade; i++)
+        dados[i] = valor;
+    return dados;
+}
+
+/* ============================ Ordem ============================ */
+
+// RPO dos blocos alcancaveis: a pos-ordem e escrita de tras para frente.
+static void calcular_ordem(Ssa *s) {
+    const Cfg *g = s->cfg;
+    int nb = g->num_blocos;
+    s->ordem = alocar((size_t)nb, sizeof(int));
+    s->posicao = preencher((size_t)nb, -1);
+    s->num_alcancaveis = 0;
+    if (nb == 0)
+        return;
+
+    int *pilha = alocar((size_t)nb, sizeof(int));
+    int *proxima = alocar((size_t)nb, sizeof(int));     // Proxima aresta de cada bloco.
+    int topo = 0, fim = nb;
+    pilha[topo++] = 0;
+    s->posicao[0] = 0;
+    proxima[0] = g->inicio_suc[0];
+    while (topo > 0) {
+        int b = pilha[topo - 1];
+        if (proxima[b] < g->inicio_suc[b + 1]) {
+            int c = g->sucessores[proxima[b]++];
+            if (s->posicao[c] < 0) {
+                s->posicao[c] = 0;
+                proxima[c] = g->inicio_suc[c];
+                pilha[topo++] = c;
+            }
+        } else {
+            topo--;
+            s->ordem[--fim] = b;
+        }
+    }
+    free(pilha);
+    free(proxima);
+
+    int m = nb - fim;
+    memmove(s->ordem, s->ordem + fim, (size_t)m * sizeof(int));
+    for (int k = 0; k < m; k++)
+        s->posicao[s->ordem[k]] = k;
+    s->num_alcancaveis = m;
+}
+
+/* ============================ Dominadores ============================ */
+
+// Ancestral comum de 'a' e 'b' na arvore de dominadores (posicoes da RPO:
+// o dominador sempre vem antes).
+static int intersecao(const int *idom, int a, int b) {
+    while (a != b) {
+        while (a > b)
+            a = idom[a];
+        while (b > a)
+            b = idom[b];
+    }
+    return a;
+}
+
+static void calcular_dominadores(Ssa *s) {
+    const Cfg *g = s->cfg;
+    int m = s->num_alcancaveis;
+    int *idom = preencher((size_t)m, -1);     // Por posicao na RPO.
+    if (m > 0)
+        idom[0] = 0;
+    int mudou = 1;
+    s->voltas_dominadores = 0;
+    while (mudou) {
+        mudou = 0;
+        s->voltas_dominadores++;
+        for (int k = 1; k < m; k++) {
+            int b = s->ordem[k];
+            int novo = -1;
+            for (int e = g->inicio_pred[b]; e < g->inicio_pred[b + 1]; e++) {
+                int p = s->posicao[g->predecessores[e]];
+                if (p < 0 || idom[p] < 0)
+                    continue;
+                novo = novo < 0 ? p : intersecao(idom, p, novo);
+            }
+            if (idom[k] != novo) {
+                idom[k] = novo;
+                mudou = 1;
+            }
+        }
+    }
+
+    s->idom = preencher((size_t)g->num_blocos, -1);
+    for (int k = 0; k < m; k++)
+        s->idom[s->ordem[k]] = s->ordem[idom[k]];
+    free(idom);
+}
+
+// Fronteiras de dominancia em CSR: uma passada conta, a outra preenche.
+// Um bloco e juncao se tem dois ou mais predecessores alcancaveis (a
+// entrada conta para o bloco 0). Subindo de cada predecessor, um bloco ja
+// marcado para a mesma juncao encerra a subida: o resto dela ja foi visto.
+static void calcular_fronteiras(Ssa *s) {
+    const Cfg *g = s->cfg;
+    int nb = g->num_blocos;
+    s->inicio_fronteira = alocar((size_t)nb + 1, sizeof(int));
+    int *marca = preencher((size_t)nb, -1);
+    int *livre = NULL;
+    for (int passo = 0; passo < 2; passo++) {
+        if (passo == 1) {
+            for (int b = 0; b < nb; b++)
+                s->inicio_fronteira[b + 1] += s->inicio_fronteira[b];
+            s->fronteira = alocar((size_t)s->inicio_fronteira[nb], sizeof(int));
+            livre = alocar((size_t)nb + 1, sizeof(int));
+            memcpy(livre, s->inicio_fronteira, ((size_t)nb + 1) * sizeof(int));
+        }
+        for (int k = 0; k < s->num_alcancaveis; k++) {
+            int b = s->ordem[k];
+            int chegadas = b == 0;
+            for (int e = g->inicio_pred[b]; e < g->inicio_pred[b + 1]; e++)
+                chegadas += s->posicao[g->predecessores[e]] >= 0;
+            if (chegadas < 2)
+                continue;
+            int parada = b == 0 ? -1 : s->idom[b];
+            int selo = passo * nb + b;
+            for (int e = g->inicio_pred[b]; e < g->inicio_pred[b + 1]; e++) {
+                int r = g->predecessores[e];
+                if (s->posicao[r] < 0)
+                    continue;
+                for (; r != parada && marca[r] != selo; r = r == 0 ? -1 : s->idom[r]) {
+                    marca[r] = selo;
+                    if (passo == 0)
+                        s->inicio_fronteira[r + 1]++;
+                    else
+                        s->fronteira[livre[r]++] = b;
+                }
+            }
+        }
+    }
+    free(marca);
+    free(livre);
+}
+
+/* ============================ Phis ============================ */
+
+static int renomeado(const Ssa *s, int reg) {
+    return reg >= 0 && reg < s->num_registradores;
+}
+
+static void posicionar_phis(Ssa *s) {
+    const Cfg *g = s->cfg;
+    const Programa *p = g->prog;
+    int nb = g->num_blocos, nr = s->num_registradores;
+
+    // Blocos que escrevem cada registrador (CSR, sem repetir) e os
+    // registradores lidos antes de escritos em algum bloco.
+    int *inicio_def = alocar((size_t)nr + 1, sizeof(int));
+    int *blocos_def = NULL;
+    int *livre = NULL;
+    int *marca = preencher((size_t)nr, -1);
+    int *escrito = preencher((size_t)nr, -1);
+    unsigned char *global = alocar((size_t)nr, 1);
+    for (int passo = 0; passo < 2; passo++) {
+        if (passo == 1) {
+            for (int r = 0; r < nr; r++)
+                inicio_def[r + 1] += inicio_def[r];
+            blocos_def = alocar((size_t)inicio_def[nr], sizeof(int));
+            livre = alocar((size_t)nr + 1, sizeof(int));
+            memcpy(livre, inicio_def, ((size_t)nr + 1) * sizeof(int));
+        }
+        for (int k = 0; k < s->num_alcancaveis; k++) {
+            int b = s->ordem[k];
+            int selo = passo * nb + b;
+            for (int i = g->inicio[b]; i < g->inicio[b + 1]; i++) {
+                const Instrucao *ins = &p->codigo[i];
+                const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+                if (passo == 0)
+                    for (int j = 0; j < 3; j++)
+                        if (papeis_opcode[ins->op][j] == PAPEL_LIDO && renomeado(s, operandos[j]) &&
+                            escrito[operandos[j]] != b)
+                            global[operandos[j]] = 1;
+                if (papeis_opcode[ins->op][0] != PAPEL_ESCRITO || !renomeado(s, ins->a))
+                    continue;
+                if (passo == 0)
+                    escrito[ins->a] = b;
+                if (marca[ins->a] == selo)
+                    continue;
+                marca[ins->a] = selo;
+                if (passo == 0)
+                    inicio_def[ins->a + 1]++;
+                else
+                    blocos_def[livre[ins->a]++] = b;
+            }
+        }
+    }
+    free(livre);
+    free(escrito);
+
+    // Fronteira iterada de cada registrador global. 'marca' guarda o
+    // ultimo registrador com phi em cada bloco e 'na_lista' o ultimo que
+    // pos o bloco na lista de trabalho.
+    free(marca);
+    marca = preencher((size_t)nb, -1);
+    int *na_lista = preencher((size_t)nb, -1);
+    int *lista = alocar((size_t)nb, sizeof(int));
+    int *pares = NULL;      // (bloco, registrador) de cada phi.
+    int capacidade_pares = 0, num_phis = 0;
+    for (int r = 0; r < nr; r++) {
+        if (!global[r])
+            continue;
+        int tamanho = 0;
+        for (int d = inicio_def[r]; d < inicio_def[r + 1]; d++) {
+            na_lista[blocos_def[d]] = r;
+            lista[tamanho++] = blocos_def[d];
+        }
+        while (tamanho > 0) {
+            int x = lista[--tamanho];
+            for (int f = s->inicio_fronteira[x]; f < s->inicio_fronteira[x + 1]; f++) {
+                int y = s->fronteira[f];
+                if (marca[y] == r)
+                    continue;
+                marca[y] = r;
+                pares = crescer(pares, &capacidade_pares, 2 * (num_phis + 1), sizeof(int));
+                pares[2 * num_phis] = y;
+                pares[2 * num_phis + 1] = r;
+                num_phis++;
+                if (na_lista[y] != r) {
+                    na_lista[y] = r;
+                    lista[tamanho++] = y;
+                }
+            }
+        }
+    }
+    free(inicio_def);
+    free(blocos_def);
+    free(global);
+    free(marca);
+    free(na_lista);
+    free(lista);
+
+    // Agrupa por bloco (contagem; dentro do bloco, em ordem de registrador).
+    s->num_phis = num_phis;
+    s->inicio_phi = alocar((size_t)nb + 1, sizeof(int));
+    s->phi_registrador = alocar((size_t)num_phis, sizeof(int));
+    s->phi_valor = preencher((size_t)num_phis, SSA_NENHUM);
+    for (int f = 0; f < num_phis; f++)
+        s->inicio_phi[pares[2 * f] + 1]++;
+    for (int b = 0; b < nb; b++)
+        s->inicio_phi[b + 1] += s->inicio_phi[b];
+    livre = alocar((size_t)nb + 1, sizeof(int));
+    memcpy(livre, s->inicio_phi, ((size_t)nb + 1) * sizeof(int));
+    for (int f = 0; f < num_phis; f++)
+        s->phi_registrador[livre[pares[2 * f]]++] = pares[2 * f + 1];
+    free(livre);
+    free(pares);
+
+    // Um argumento por predecessor, mais o da entrada no bloco 0.
+    s->inicio_argumentos = alocar((size_t)num_phis + 1, sizeof(int));
+    for (int b = 0; b < nb; b++)
+        for (int f = s->inicio_phi[b]; f < s->inicio_phi[b + 1]; f++)
+            s->inicio_argumentos[f + 1] = s->inicio_argumentos[f] +
+                g->inicio_pred[b + 1] - g->inicio_pred[b] + (b == 0);
+    s->argumentos = preencher((size_t)s->inicio_argumentos[num_phis], SSA_NENHUM);
+    for (int f = s->inicio_phi[0]; f < s->inicio_phi[1] && nb > 0; f++)
+        s->argumentos[s->inicio_argumentos[f + 1] - 1] = s->phi_registrador[f];
+}
+
+/* ============================ Renomeacao ============================ */
+
+static void renomear(Ssa *s) {
+    const Cfg *g = s->cfg;
+    const Programa *p = g->prog;
+    int nb = g->num_blocos, nr = s->num_registradores, n = p->num_instrucoes;
+
+    s->registrador_valor = alocar((size_t)nr + s->num_phis + n, sizeof(int));
+    s->valores = preencher((size_t)n * 3, SSA_NENHUM);
+    for (int r = 0; r < nr; r++)
+        s->registrador_valor[r] = r;
+    int num_valores = nr;
+
+    // Filhos na arvore de dominadores (CSR por contagem).
+    int *inicio_filhos = alocar((size_t)nb + 1, sizeof(int));
+    int *filhos = alocar((size_t)nb, sizeof(int));
+    for (int k = 1; k < s->num_alcancaveis; k++)
+        inicio_filhos[s->idom[s->ordem[k]] + 1]++;
+    for (int b = 0; b < nb; b++)
+        inicio_filhos[b + 1] += inicio_filhos[b];
+    int *livre = alocar((size_t)nb + 1, sizeof(int));
+    memcpy(livre, inicio_filhos, ((size_t)nb + 1) * sizeof(int));
+    for (int k = 1; k < s->num_alcancaveis; k++)
+        filhos[livre[s->idom[s->ordem[k]]]++] = s->ordem[k];
+
+    // Indice de cada aresta de sucessor na lista de predecessores do
+    // destino (os predecessores estao na ordem dos blocos de origem).
+    int num_arestas = g->num_arestas;
+    int *indice_pred = alocar((size_t)num_arestas, sizeof(int));
+    memset(livre, 0, ((size_t)nb + 1) * sizeof(int));
+    for (int b = 0; b < nb; b++)
+        for (int e = g->inicio_suc[b]; e < g->inicio_suc[b + 1]; e++)
+            indice_pred[e] = livre[g->sucessores[e]]++;
+    free(livre);
+
+    int *atual = alocar((size_t)nr, sizeof(int));
+    for (int r = 0; r < nr; r++)
+        atual[r] = r;
+    int *desfazer = alocar((size_t)2 * (s->num_phis + n), sizeof(int));     // (registrador, anterior)
+    int topo_desfazer = 0;
+    int *altura = alocar((size_t)nb, sizeof(int));
+    int *pilha = alocar((size_t)2 * nb + 1, sizeof(int));   // b entra, ~b sai.
+    int topo = 0;
+    if (s->num_alcancaveis > 0)
+        pilha[topo++] = 0;
+
+#define DEFINIR(reg, destino) do { \
+        desfazer[topo_desfazer++] = (reg); \
+        desfazer[topo_desfazer++] = atual[reg]; \
+        atual[reg] = num_valores; \
+        s->registrador_valor[num_valores] = (reg); \
+        (destino) = num_valores++; \
+    } while (0)
+
+    while (topo > 0) {
+        int b = pilha[--topo];
+        if (b < 0) {
+            for (b = ~b; topo_desfazer > altura[b]; topo_desfazer -= 2)
+                atual[desfazer[topo_desfazer - 2]] = desfazer[topo_desfazer - 1];
+            continue;
+        }
+        altura[b] = topo_desfazer;
+        for (int f = s->inicio_phi[b]; f < s->inicio_phi[b + 1]; f++)
+            DEFINIR(s->phi_registrador[f], s->phi_valor[f]);
+        for (int i = g->inicio[b]; i < g->inicio[b + 1]; i++) {
+            const Instrucao *ins = &p->codigo[i];
+            const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+            for (int j = 0; j < 3; j++)
+                if (papeis_opcode[ins->op][j] == PAPEL_LIDO && renomeado(s, operandos[j]))
+                    s->valores[3 * i + j] = atual[operandos[j]];
+            if (papeis_opcode[ins->op][0] == PAPEL_ESCRITO && renomeado(s, ins->a))
+                DEFINIR(ins->a, s->valores[3 * i]);
+        }
+        for (int e = g->inicio_suc[b]; e < g->inicio_suc[b + 1]; e++) {
+            int c = g->sucessores[e];
+            for (int f = s->inicio_phi[c]; f < s->inicio_phi[c + 1]; f++)
+                s->argumentos[s->inicio_argumentos[f] + indice_pred[e]] = atual[s->phi_registrador[f]];
+        }
+        pilha[topo++] = ~b;
+        for (int f = inicio_filhos[b]; f < inicio_filhos[b + 1]; f++)
+            pilha[topo++] = filhos[f];
+    }
+#undef DEFINIR
+
+    s->num_valores = num_valores;
+    free(inicio_filhos);
+    free(filhos);
+    free(indice_pred);
+    free(atual);
+    free(desfazer);
+    free(altura);
+    free(pilha);
+}
+
+/* ============================ Construcao ============================ */
+
+void ssa_construir(Ssa *s, const Cfg *g) {
+    memset(s, 0, sizeof(*s));
+    s->cfg = g;
+    s->num_registradores = g->prog->num_variaveis + g->prog->num_temporarios;
+
+    double inicio = relogio_monotonico();
+    calcular_ordem(s);
+    double marco = relogio_monotonico();
+    s->tempo_ordem = marco - inicio;
+    calcular_dominadores(s);
+    inicio = relogio_monotonico();
+    s->tempo_dominadores = inicio - marco;
+    calcular_fronteiras(s);
+    marco = relogio_monotonico();
+    s->tempo_fronteiras = marco - inicio;
+    posicionar_phis(s);
+    inicio = relogio_monotonico();
+    s->tempo_phis = inicio - marco;
+    renomear(s);
+    s->tempo_renomeacao = relogio_monotonico() - inicio;
+}
+
+void ssa_liberar(Ssa *s) {
+    free(s->ordem);
+    free(s->posicao);
+    free(s->idom);
+    free(s->inicio_fronteira);
+    free(s->fronteira);
+    free(s->inicio_phi);
+    free(s->phi_registrador);
+    free(s->phi_valor);
+    free(s->inicio_argumentos);
+    free(s->argumentos);
+    free(s->registrador_valor);
+    free(s->valores);
+    memset(s, 0, sizeof(*s));
+}
+
+/* ============================ Listagem ============================ */
+
+void ssa_imprimir(const Ssa *s, FILE *saida) {
+    const Cfg *g = s->cfg;
+    const Programa *p = g->prog;
+    for (int b = 0; b < g->num_blocos; b++) {
+        fprintf(saida, "B%d [%d, %d)", b, g->inicio[b], g->inicio[b + 1]);
+        if (s->idom[b] < 0)
+            fputs(" inalcancavel\n", saida);
+        else
+            fprintf(saida, " idom B%d\n", s->idom[b]);
+        for (int f = s->inicio_phi[b]; f < s->inicio_phi[b + 1]; f++) {
+            fprintf(saida, "        v%d = phi r%d (", s->phi_valor[f], s->phi_registrador[f]);
+            for (int a = s->inicio_argumentos[f]; a < s->inicio_argumentos[f + 1]; a++) {
+                const char *separador = a > s->inicio_argumentos[f] ? ", " : "";
+                if (s->argumentos[a] == SSA_NENHUM)
+                    fprintf(saida, "%s-", separador);
+                else
+                    fprintf(saida, "%sv%d", separador, s->argumentos[a]);
+            }
+            fputs(")\n", saida);
+        }
+        for (int i = g->inicio[b]; i < g->inicio[b + 1]; i++) {
+            const Instrucao *ins = &p->codigo[i];
+            fprintf(saida, "%6d  %-24s", i, nome_opcode(ins->op));
+            const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+            for (int k = 0; k < 3; k++) {
+                const char *separador = k ? ", " : " ";
+                int valor = s->valores[3 * i + k];
+                switch (papeis_opcode[ins->op][k]) {
+                    case PAPEL_LIDO:
+                    case PAPEL_ESCRITO:
+                        if (valor != SSA_NENHUM)
+                            fprintf(saida, "%sv%d", separador, valor);
+                        else
+                            fprintf(saida, "%sr%d", separador, operandos[k]);
+                        break;
+                    case PAPEL_ALVO:
+                        fprintf(saida, "%s@%d", separador, operandos[k]);
+                        break;
+                    case PAPEL_IMEDIATO:
+                        fprintf(saida, "%s#%d", separador, operandos[k]);
+                        break;
+                }
+            }
+            fputc('\n', saida);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef SSA_H
+#define SSA_H
+
+#include <stdio.h>
+#include "cfg.h"
+
+/* Forma SSA sobre o grafo de cfg.h. Os registradores de variaveis e de
+   temporarios sao renomeados para valores, cada um escrito uma unica vez;
+   os registradores de constantes ficam como estao. A construcao segue
+   Cytron et al. com os dominadores de Cooper, Harvey e Kennedy:
+     1. ordem reversa de pos-ordem (RPO) a partir do bloco 0, numa busca
+        em profundidade com pilha explicita;
+     2. dominadores imediatos pelo algoritmo iterativo sobre a RPO, com a
+        intersecao subindo pela arvore de dominadores (em grafos redutiveis
+        converge em duas voltas);
+     3. fronteiras de dominancia subindo de cada predecessor de uma juncao
+        ate o dominador imediato dela;
+     4. phis pela fronteira iterada dos blocos que escrevem cada
+        registrador, so para os registradores lidos antes de escritos em
+        algum bloco (SSA semipodada: os demais nunca precisam de phi);
+     5. renomeacao em pre-ordem da arvore de dominadores, com uma pilha
+        unica de (registrador, valor anterior) desfeita na saida de cada
+        bloco.
+   Tudo fica em vetores de inteiros, com as listas no formato CSR. Os
+   valores 0 .. num_registradores - 1 sao os registradores na entrada do
+   programa (zerados pela VM); os escritos vem depois. A entrada e uma
+   aresta a mais do bloco 0: se ele for cabeca de laco, os phis dele tem um
+   argumento a mais, o ultimo, com o valor de entrada. Os blocos
+   inalcancaveis nao sao renomeados. */
+
+#define SSA_NENHUM  (-1)    // Operando que nao e registrador renomeado.
+
+typedef struct {
+    const Cfg *cfg;
+    int num_registradores;  // Variaveis e temporarios (os renomeados).
+
+    // Ordem e dominadores.
+    int num_alcancaveis;
+    int *ordem;             // Blocos alcancaveis em RPO.
+    int *posicao;           // Posicao de cada bloco em 'ordem' (-1 inalcancavel).
+    int *idom;              // Dominador imediato (o bloco 0 e o proprio; -1 inalcancavel).
+    int voltas_dominadores;
+    int *inicio_fronteira;  // num_blocos + 1 entradas.
+    int *fronteira;
+
+    // Phis, agrupados por bloco: os do bloco k sao inicio_phi[k] .. inicio_phi[k + 1].
+    int num_phis;
+    int *inicio_phi;
+    int *phi_registrador;
+    int *phi_valor;
+    // Argumentos do phi f: argumentos[inicio_argumentos[f] .. inicio_argumentos[f + 1]),
+    // na ordem dos predecessores do bloco (SSA_NENHUM se o predecessor e inalcancavel).
+    int *inicio_argumentos;
+    int *argumentos;
+
+    // Valores: o registrador de cada um e o valor de cada operando.
+    int num_valores;
+    int *registrador_valor;
+    int *valores;           // 3 por instrucao (a, b, c); SSA_NENHUM fora dos renomeados.
+
+    // Tempo de cada etapa, em segundos.
+    double tempo_ordem, tempo_dominadores, tempo_fronteiras, tempo_phis, tempo_renomeacao;
+} Ssa;
+
+// Constroi a SSA de 'g', que deve continuar vivo enquanto a SSA for usada.
+void ssa_construir(Ssa *s, const Cfg *g);
+void ssa_liberar(Ssa *s);
+
+// Lista os blocos com o dominador imediato, os phis e as instrucoes com os
+// operandos renomeados (vN) no lugar dos registradores.
+void ssa_imprimir(const Ssa *s, FILE *saida);
+
+#endif
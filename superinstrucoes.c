@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "superinstrucoes.h"
+
+static void *alocar(size_t quantidade, size_t tamanho_item) {
+    void *dados = calloc(quantidade, tamanho_item);
+    if (!dados) {
+        fprintf(stderr, "Erro: memoria insuficiente para as superinstrucoes.\n");
+        exit(1);
+    }
+    return dados;
+}
+
+/* ============================ Registradores ============================ */
+
+// Bit do temporario 'reg' (0 se nao e temporario ou passa do 64o).
+static uint64_t bit_temporario(const Programa *p, int reg) {
+    int t = reg - p->num_variaveis;
+    return t >= 0 && t < p->num_temporarios && t < 64 ? (uint64_t)1 << t : 0;
+}
+
+// Valor inteiro do registrador de constante 'reg', se couber em 32 bits.
+static int constante_32(const Programa *p, int reg, int32_t *valor) {
+    int k = reg - (p->num_variaveis + p->num_temporarios);
+    if (k < 0 || k >= p->num_constantes || p->registradores_constantes[k] != reg)
+        return 0;
+    int64_t v = p->valores_constantes[k].i;
+    if (v < INT32_MIN || v > INT32_MAX)
+        return 0;
+    *valor = (int32_t)v;
+    return 1;
+}
+
+/* ============================ Vivacidade ============================ */
+
+static uint64_t usos(const Programa *p, const Instrucao *ins) {
+    const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+    uint64_t bits = 0;
+    for (int k = 0; k < 3; k++)
+        if (papeis_opcode[ins->op][k] == PAPEL_LIDO)
+            bits |= bit_temporario(p, operandos[k]);
+    return bits;
+}
+
+static uint64_t definicoes(const Programa *p, const Instrucao *ins) {
+    return papeis_opcode[ins->op][0] == PAPEL_ESCRITO ? bit_temporario(p, ins->a) : 0;
+}
+
+static int alvo_de(const Instrucao *ins) {
+    const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+    for (int k = 0; k < 3; k++)
+        if (papeis_opcode[ins->op][k] == PAPEL_ALVO)
+            return operandos[k];
+    return -1;
+}
+
+// Temporarios vivos na saida da instrucao 'i', dado 'vivos' na entrada de cada uma.
+static uint64_t vivos_na_saida(const Programa *p, const uint64_t *vivos, int i) {
+    const Instrucao *ins = &p->codigo[i];
+    switch (ins->op) {
+        case OP_PARAR:
+        case OP_RETORNAR_I:
+        case OP_RETORNAR_F:
+            return 0;
+        case OP_SALTAR:
+            return vivos[ins->a];
+        default: {
+            int alvo = alvo_de(ins);
+            return vivos[i + 1] | (alvo >= 0 ? vivos[alvo] : 0);
+        }
+    }
+}
+
+// Temporarios vivos na entrada de cada instrucao (mais uma posicao no fim).
+static uint64_t *calcular_vivos(const Programa *p) {
+    int n = p->num_instrucoes;
+    uint64_t *vivos = alocar((size_t)n + 1, sizeof(uint64_t));
+    int mudou = 1;
+    // Para tras converge em poucas voltas: so os saltos de volta pedem outra.
+    while (mudou) {
+        mudou = 0;
+        for (int i = n - 1; i >= 0; i--) {
+            const Instrucao *ins = &p->codigo[i];
+            uint64_t v = usos(p, ins) | (vivos_na_saida(p, vivos, i) & ~definicoes(p, ins));
+            if (v != vivos[i]) {
+                vivos[i] = v;
+                mudou = 1;
+            }
+        }
+    }
+    return vivos;
+}
+
+/* ============================ Fusao ============================ */
+
+static int e_operacao(int op) {
+    return (op >= OP_SOMAR_I && op <= OP_DIVIDIR_F) || op == OP_SOMAR_K_I;
+}
+
+static int e_comparacao_i(int op) {
+    return op >= OP_IGUAL_I && op <= OP_MAIOR_IGUAL_I;
+}
+
+// Comparacao de int com resultado invertido (exata em int, ao contrario de float).
+static int negar_comparacao(int op) {
+    switch (op) {
+        case OP_IGUAL_I:        return OP_DIFERENTE_I;
+        case OP_DIFERENTE_I:    return OP_IGUAL_I;
+        case OP_MENOR_I:        return OP_MAIOR_IGUAL_I;
+        case OP_MENOR_IGUAL_I:  return OP_MAIOR_I;
+        case OP_MAIOR_I:        return OP_MENOR_IGUAL_I;
+        default:                return OP_MENOR_I;
+    }
+}
+
+static void criar_somas_constantes(Programa *p, ResultadoFusao *r) {
+    for (int i = 0; i < p->num_instrucoes; i++) {
+        Instrucao *ins = &p->codigo[i];
+        int32_t k;
+        if (ins->op == OP_SOMAR_I && constante_32(p, ins->c, &k)) {
+            ins->c = k;
+        } else if (ins->op == OP_SOMAR_I && constante_32(p, ins->b, &k)) {
+            ins->b = ins->c;
+            ins->c = k;
+        } else if (ins->op == OP_SUBTRAIR_I && constante_32(p, ins->c, &k) && k != INT32_MIN) {
+            ins->c = -k;
+        } else {
+            continue;
+        }
+        ins->op = OP_SOMAR_K_I;
+        r->somas_constantes++;
+    }
+}
+
+ResultadoFusao fundir_superinstrucoes(Programa *p) {
+    ResultadoFusao r = { 0, 0, 0 };
+    int n = p->num_instrucoes;
+    if (n == 0)
+        return r;
+    criar_somas_constantes(p, &r);
+
+    uint64_t *vivos = calcular_vivos(p);
+    unsigned char *e_alvo = alocar((size_t)n + 1, 1);
+    for (int i = 0; i < n; i++) {
+        int alvo = alvo_de(&p->codigo[i]);
+        if (alvo >= 0)
+            e_alvo[alvo] = 1;
+    }
+
+    unsigned char *removida = alocar((size_t)n, 1);
+    for (int i = 0; i + 1 < n; i++) {
+        Instrucao *primeira = &p->codigo[i];
+        Instrucao *segunda = &p->codigo[i + 1];
+        uint64_t t = bit_temporario(p, primeira->a);
+        if (!t || e_alvo[i + 1] || papeis_opcode[primeira->op][0] != PAPEL_ESCRITO)
+            continue;
+        // O temporario so pode ser lido pela segunda instrucao.
+        if (vivos_na_saida(p, vivos, i + 1) & t)
+            continue;
+
+        if (e_operacao(primeira->op) && segunda->op == OP_MOVER && segunda->b == primeira->a) {
+            primeira->a = segunda->a;
+            r.operacoes_em_variavel++;
+        } else if (e_comparacao_i(primeira->op) && segunda->a == primeira->a &&
+                   (segunda->op == OP_SALTAR_SE_VERDADE || segunda->op == OP_SALTAR_SE_FALSO)) {
+            int cmp = segunda->op == OP_SALTAR_SE_VERDADE ? primeira->op
+                                                          : negar_comparacao(primeira->op);
+            primeira->op = OP_SALTAR_SE_IGUAL_I + (cmp - OP_IGUAL_I);
+            primeira->a = primeira->b;
+            primeira->b = primeira->c;
+            primeira->c = segunda->b;
+            r.comparacoes_e_saltos++;
+        } else {
+            continue;
+        }
+        removida[i + 1] = 1;
+        i++;
+    }
+
+    // Compacta e corrige os alvos dos saltos.
+    int *novo = alocar((size_t)n + 1, sizeof(int));
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        novo[i] = m;
+        if (!removida[i])
+            p->codigo[m++] = p->codigo[i];
+    }
+    novo[n] = m;
+    p->num_instrucoes = m;
+    for (int i = 0; i < m; i++) {
+        Instrucao *ins = &p->codigo[i];
+        int32_t *operandos[3] = { &ins->a, &ins->b, &ins->c };
+        for (int k = 0; k < 3; k++)
+            if (papeis_opcode[ins->op][k] == PAPEL_ALVO)
+                *operandos[k] = novo[*operandos[k]];
+    }
+
+    free(novo);
+    free(removida);
+    free(e_alvo);
+    free(vivos);
+    return r;
+}
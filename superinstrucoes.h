@@ -0,0 +1,28 @@
+#ifndef SUPERINSTRUCOES_H
+#define SUPERINSTRUCOES_H
+
+#include "vm.h"
+
+/* Fusao de superinstrucoes sobre o bytecode pronto (depois de
+   montador_concluir). As fusoes vem do perfil de pares (--perfil-pares):
+   nos lacos, os pares mais despachados sao uma operacao seguida de MOVER
+   para a variavel, e uma comparacao de int seguida do salto condicional.
+     - SOMAR_I/SUBTRAIR_I com constante de 32 bits vira SOMAR_K_I, com a
+       constante na instrucao (i = i + 1 nao le registrador de constante);
+     - "op t, x, y; MOVER v, t" vira "op v, x, y";
+     - "cmp t, x, y; SALTAR_SE_VERDADE/FALSO t, L" vira
+       "SALTAR_SE_<cmp>_I x, y, L" (com a comparacao negada no FALSO).
+   Um par so e fundido se o temporario t estiver morto depois dele e se a
+   segunda instrucao nao for alvo de salto. A vivacidade dos temporarios e
+   calculada por fluxo de dados para tras, um bit por temporario (os
+   temporarios alem do 64o nunca sao fundidos). */
+
+typedef struct {
+    int somas_constantes;       // SOMAR_K_I criadas.
+    int operacoes_em_variavel;  // MOVER absorvidos.
+    int comparacoes_e_saltos;   // Saltos absorvidos.
+} ResultadoFusao;
+
+ResultadoFusao fundir_superinstrucoes(Programa *p);
+
+#endif
@@ -0,0 +1,657 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "traducao.h"
+#include "compilador.h"
+#include "parser.h"
+#include "semantica.h"
+#include "saida.h"
+#include "memoria.h"
+
+/* ============================ Estado ============================ */
+
+// Valor semantico de uma expressao aberta.
+typedef struct {
+    TipoDado tipo;
+    int constante;      // Valor conhecido na traducao (ainda sem registrador).
+    int booleano;       // O registrador so guarda 0 ou 1.
+    Valor valor;
+    int reg;
+} ValorSemantico;
+
+// Laco for cujo corpo (o comando seguinte da lista) ainda nao terminou.
+// O passo e a condicao estao no topo de 'trechos', nessa ordem.
+typedef struct {
+    int salto_teste;    // SALTAR para a condicao, a corrigir.
+    int corpo;          // Primeira instrucao do corpo.
+    ValorSemantico condicao;
+} ForPendente;
+
+// Codigo recortado do fim do programa para ser recolocado mais tarde.
+typedef struct {
+    int inicio;         // Posicao em 'recortes'.
+    int tamanho;
+    int origem;         // Indice da primeira instrucao quando foi emitida.
+} Trecho;
+
+// Um quadro por NT aberto, empilhado e desempilhado junto com o driver.
+typedef struct {
+    int nt;
+    int producao;
+    int operador;       // Opcode (de int) do operador lido; 1 = && ou ! nos demais.
+    int salto;          // Salto a corrigir quando o NT avancar (-1 se nenhum).
+    int inicio;         // Inicio do codigo a recortar; corpo do while.
+    int alvo;           // Declaracao que recebe o valor; resultado do && / ||.
+    int temporarios;    // Temporarios em uso no && / || com esquerda constante.
+    int filhos;         // ATRIBUICAO_SIMPLES ja abertas (for).
+    int pendentes;      // Lacos for que esperam o proximo comando como corpo.
+    int corpo_de;       // Lacos for de que este COMANDO e o corpo.
+    ValorSemantico condicao;    // while/for; esquerda constante do && / ||.
+} Quadro;
+
+typedef struct {
+    Montador m;
+    const AnalisadorSemantico *sem;
+    ReceptorEventos semantica;
+    Quadro *quadros;
+    int num_quadros;
+    int capacidade_quadros;
+    ValorSemantico *valores;
+    int num_valores;
+    int capacidade_valores;
+    ForPendente *fors;
+    int num_fors;
+    int capacidade_fors;
+    Instrucao *recortes;
+    int num_recortes;
+    int capacidade_recortes;
+    Trecho *trechos;
+    int num_trechos;
+    int capacidade_trechos;
+} Tradutor;
+
+static int emitir(Tradutor *t, int op, int a, int b, int c) {
+    return programa_emitir(t->m.prog, op, a, b, c);
+}
+
+static int posicao(const Tradutor *t) {
+    return t->m.prog->num_instrucoes;
+}
+
+// Aponta o salto 'indice' para 'alvo' (nada se 'indice' < 0).
+static void corrigir(Tradutor *t, int indice, int alvo) {
+    if (indice < 0)
+        return;
+    Instrucao *ins = &t->m.prog->codigo[indice];
+    if (ins->op == OP_SALTAR)
+        ins->a = alvo;
+    else
+        ins->b = alvo;
+}
+
+static int e_salto(int op) {
+    return op == OP_SALTAR || op == OP_SALTAR_SE_FALSO || op == OP_SALTAR_SE_VERDADE;
+}
+
+// Tira do programa o codigo a partir de 'inicio' e o guarda em 'trechos'.
+static void recortar(Tradutor *t, int inicio) {
+    Programa *p = t->m.prog;
+    int tamanho = p->num_instrucoes - inicio;
+    t->recortes = crescer(t->recortes, &t->capacidade_recortes, t->num_recortes + tamanho,
+                          sizeof(Instrucao));
+    memcpy(t->recortes + t->num_recortes, p->codigo + inicio, (size_t)tamanho * sizeof(Instrucao));
+    t->trechos = crescer(t->trechos, &t->capacidade_trechos, t->num_trechos + 1, sizeof(Trecho));
+    Trecho *tr = &t->trechos[t->num_trechos++];
+    tr->inicio = t->num_recortes;
+    tr->tamanho = tamanho;
+    tr->origem = inicio;
+    t->num_recortes += tamanho;
+    p->num_instrucoes = inicio;
+}
+
+// Recoloca o ultimo trecho recortado no fim, movendo os saltos internos.
+static void colar(Tradutor *t) {
+    if (t->num_trechos == 0)
+        return;
+    Trecho tr = t->trechos[--t->num_trechos];
+    int destino = posicao(t);
+    for (int i = 0; i < tr.tamanho; i++) {
+        Instrucao ins = t->recortes[tr.inicio + i];
+        if (e_salto(ins.op)) {
+            int32_t *alvo = ins.op == OP_SALTAR ? &ins.a : &ins.b;
+            if (*alvo >= tr.origem && *alvo <= tr.origem + tr.tamanho)
+                *alvo += destino - tr.origem;
+        }
+        emitir(t, ins.op, ins.a, ins.b, ins.c);
+    }
+    t->num_recortes = tr.inicio;
+}
+
+/* ============================ Valores ============================ */
+
+static void empilhar(Tradutor *t, ValorSemantico v) {
+    t->valores = crescer(t->valores, &t->capacidade_valores, t->num_valores + 1,
+                         sizeof(ValorSemantico));
+    t->valores[t->num_valores++] = v;
+}
+
+static ValorSemantico desempilhar(Tradutor *t) {
+    if (t->num_valores > 0)
+        return t->valores[--t->num_valores];
+    // So acontece na recuperacao de erros, quando o codigo e descartado.
+    ValorSemantico v = { TIPO_INDEFINIDO, 1, 0, { 0 }, 0 };
+    return v;
+}
+
+static ValorSemantico constante(TipoDado tipo, Valor valor, int booleano) {
+    ValorSemantico v = { tipo, 1, booleano, valor, 0 };
+    return v;
+}
+
+static ValorSemantico inteiro(int64_t i) {
+    Valor valor;
+    valor.i = i;
+    return constante(TIPO_INT, valor, 1);
+}
+
+static ValorSemantico registrador(TipoDado tipo, int reg, int booleano) {
+    ValorSemantico v = { tipo, 0, booleano, { 0 }, reg };
+    return v;
+}
+
+static int verdade(const ValorSemantico *v) {
+    return v->tipo == TIPO_FLOAT ? v->valor.f != 0 : v->valor.i != 0;
+}
+
+// Da registrador a uma constante.
+static void materializar(Tradutor *t, ValorSemantico *v) {
+    if (!v->constante)
+        return;
+    v->reg = montador_constante(&t->m, v->valor, v->tipo);
+    v->constante = 0;
+}
+
+static int e_temporario(const ValorSemantico *v) {
+    return !v->constante && v->reg >= BASE_TEMPORARIO && v->reg < BASE_CONSTANTE;
+}
+
+// Primeiro temporario que deixa de ser usado quando 'a' e 'b' forem lidos:
+// os temporarios sao alocados em pilha, entao tudo acima do menor e deles.
+static int marca_temporarios(const Tradutor *t, const ValorSemantico *a, const ValorSemantico *b) {
+    int marca = t->m.proximo_temporario;
+    if (e_temporario(a) && a->reg - BASE_TEMPORARIO < marca)
+        marca = a->reg - BASE_TEMPORARIO;
+    if (b && e_temporario(b) && b->reg - BASE_TEMPORARIO < marca)
+        marca = b->reg - BASE_TEMPORARIO;
+    return marca;
+}
+
+static TipoDado juntar(TipoDado a, TipoDado b) {
+    return a > b ? a : b;
+}
+
+static ValorSemantico converter(Tradutor *t, ValorSemantico v, TipoDado tipo) {
+    if (tipo != TIPO_FLOAT || v.tipo == TIPO_FLOAT)
+        return v;
+    if (v.constante) {
+        v.valor.f = (double)v.valor.i;
+        v.tipo = TIPO_FLOAT;
+        v.booleano = 0;
+        return v;
+    }
+    ValorSemantico r = registrador(TIPO_FLOAT, montador_temporario(&t->m), 0);
+    emitir(t, OP_I2F, r.reg, v.reg, 0);
+    return r;
+}
+
+// Calcula 'e op d' na traducao; 0 se deve ficar para a execucao (divisao
+// inteira por zero, que e erro de execucao).
+static int dobrar(int op, TipoDado tipo, Valor e, Valor d, Valor *r) {
+    if (tipo == TIPO_FLOAT) {
+        switch (op) {
+            case OP_SOMAR_I:        r->f = e.f + d.f; return 1;
+            case OP_SUBTRAIR_I:     r->f = e.f - d.f; return 1;
+            case OP_MULTIPLICAR_I:  r->f = e.f * d.f; return 1;
+            case OP_DIVIDIR_I:      r->f = e.f / d.f; return 1;
+            case OP_IGUAL_I:        r->i = e.f == d.f; return 1;
+            case OP_DIFERENTE_I:    r->i = e.f != d.f; return 1;
+            case OP_MENOR_I:        r->i = e.f < d.f; return 1;
+            case OP_MENOR_IGUAL_I:  r->i = e.f <= d.f; return 1;
+            case OP_MAIOR_I:        r->i = e.f > d.f; return 1;
+            case OP_MAIOR_IGUAL_I:  r->i = e.f >= d.f; return 1;
+        }
+        return 0;
+    }
+    // Transbordo circular, como na VM.
+    uint64_t x = (uint64_t)e.i, y = (uint64_t)d.i;
+    switch (op) {
+        case OP_SOMAR_I:        r->i = (int64_t)(x + y); return 1;
+        case OP_SUBTRAIR_I:     r->i = (int64_t)(x - y); return 1;
+        case OP_MULTIPLICAR_I:  r->i = (int64_t)(x * y); return 1;
+        case OP_DIVIDIR_I:
+            if (d.i == 0)
+                return 0;
+            r->i = d.i == -1 ? (int64_t)(0 - x) : e.i / d.i;
+            return 1;
+        case OP_IGUAL_I:        r->i = e.i == d.i; return 1;
+        case OP_DIFERENTE_I:    r->i = e.i != d.i; return 1;
+        case OP_MENOR_I:        r->i = e.i < d.i; return 1;
+        case OP_MENOR_IGUAL_I:  r->i = e.i <= d.i; return 1;
+        case OP_MAIOR_I:        r->i = e.i > d.i; return 1;
+        case OP_MAIOR_IGUAL_I:  r->i = e.i >= d.i; return 1;
+    }
+    return 0;
+}
+
+// Aplica o operador binario 'op' (opcode de int) aos dois valores do topo.
+static void aplicar_binario(Tradutor *t, int op) {
+    ValorSemantico d = desempilhar(t);
+    ValorSemantico e = desempilhar(t);
+    int comparacao = op >= OP_IGUAL_I;
+    TipoDado tipo = juntar(e.tipo, d.tipo);
+    TipoDado resultado = comparacao ? TIPO_INT : tipo;
+    e = converter(t, e, tipo);
+    d = converter(t, d, tipo);
+
+    Valor valor;
+    if (e.constante && d.constante && dobrar(op, tipo, e.valor, d.valor, &valor)) {
+        empilhar(t, constante(resultado, valor, comparacao));
+        return;
+    }
+    int marca = marca_temporarios(t, &e, &d);
+    materializar(t, &e);
+    materializar(t, &d);
+    // Os operandos sao lidos antes da escrita: o resultado reusa o primeiro temporario.
+    t->m.proximo_temporario = marca;
+    ValorSemantico r = registrador(resultado, montador_temporario(&t->m), comparacao);
+    if (tipo == TIPO_FLOAT)
+        op += comparacao ? OP_IGUAL_F - OP_IGUAL_I : OP_SOMAR_F - OP_SOMAR_I;
+    emitir(t, op, r.reg, e.reg, d.reg);
+    empilhar(t, r);
+}
+
+static void aplicar_nao(Tradutor *t) {
+    ValorSemantico v = desempilhar(t);
+    if (v.constante) {
+        empilhar(t, inteiro(!verdade(&v)));
+        return;
+    }
+    t->m.proximo_temporario = marca_temporarios(t, &v, NULL);
+    ValorSemantico r = registrador(TIPO_INT, montador_temporario(&t->m), 1);
+    emitir(t, v.tipo == TIPO_FLOAT ? OP_NAO_F : OP_NAO_I, r.reg, v.reg, 0);
+    empilhar(t, r);
+}
+
+// Valor de verdade (int 0/1 ou constante) de uma condicao.
+static ValorSemantico condicao(Tradutor *t, ValorSemantico v) {
+    if (v.constante)
+        return inteiro(verdade(&v));
+    if (v.tipo != TIPO_FLOAT)
+        return v;
+    t->m.proximo_temporario = marca_temporarios(t, &v, NULL);
+    ValorSemantico r = registrador(TIPO_INT, montador_temporario(&t->m), 1);
+    emitir(t, OP_VERDADE_F, r.reg, v.reg, 0);
+    return r;
+}
+
+// Resultado de && / ||: como 'condicao', mas um int que nao seja so 0/1
+// tambem passa por VERDADE_I.
+static ValorSemantico valor_logico(Tradutor *t, ValorSemantico v) {
+    if (v.constante || v.booleano)
+        return condicao(t, v);
+    t->m.proximo_temporario = marca_temporarios(t, &v, NULL);
+    ValorSemantico r = registrador(TIPO_INT, montador_temporario(&t->m), 1);
+    emitir(t, v.tipo == TIPO_FLOAT ? OP_VERDADE_F : OP_VERDADE_I, r.reg, v.reg, 0);
+    return r;
+}
+
+// Salto do fim de um laco de volta ao corpo, se a condicao valer.
+static void fechar_laco(Tradutor *t, const ValorSemantico *cond, int corpo) {
+    if (!cond->constante)
+        emitir(t, OP_SALTAR_SE_VERDADE, cond->reg, corpo, 0);
+    else if (cond->valor.i)
+        emitir(t, OP_SALTAR, corpo, 0, 0);
+}
+
+static void atribuir(Tradutor *t, int declaracao, ValorSemantico v) {
+    if (declaracao < 0)
+        return;
+    materializar(t, &v);
+    emitir(t, OP_MOVER, declaracao, v.reg, 0);
+}
+
+static TipoDado tipo_declarado(const Tradutor *t, int declaracao) {
+    return declaracao >= 0 ? t->sem->declaracoes[declaracao].tipo : TIPO_INDEFINIDO;
+}
+
+// Fecha os 'n' ultimos for pendentes: passo, condicao e salto de volta.
+static void completar_fors(Tradutor *t, int n) {
+    for (; n > 0 && t->num_fors > 0; n--) {
+        ForPendente f = t->fors[--t->num_fors];
+        colar(t);
+        corrigir(t, f.salto_teste, posicao(t));
+        colar(t);
+        fechar_laco(t, &f.condicao, f.corpo);
+    }
+}
+
+/* ============================ Eventos ============================ */
+
+static Quadro *topo(Tradutor *t) {
+    return &t->quadros[t->num_quadros - 1];
+}
+
+static void traducao_entrar(void *contexto, int nt, int producao, int indice_token) {
+    Tradutor *t = contexto;
+    t->semantica.entrar_nt(t->semantica.contexto, nt, producao, indice_token);
+
+    t->quadros = crescer(t->quadros, &t->capacidade_quadros, t->num_quadros + 1, sizeof(Quadro));
+    Quadro *pai = &t->quadros[t->num_quadros - 1];
+    Quadro *q = &t->quadros[t->num_quadros++];
+    memset(q, 0, sizeof(*q));
+    q->nt = nt;
+    q->producao = producao;
+    q->salto = -1;
+    q->alvo = -1;
+
+    switch (nt) {
+        case NT_LISTA_COMANDOS:
+            // Os for do comando anterior esperam o proximo como corpo.
+            if (pai->nt == NT_LISTA_COMANDOS) {
+                q->pendentes = pai->pendentes;
+                pai->pendentes = 0;
+            }
+            if (producoes[producao].tam_corpo == 0) {
+                completar_fors(t, q->pendentes);
+                q->pendentes = 0;
+            }
+            break;
+        case NT_COMANDO:
+            t->m.proximo_temporario = 0;
+            if (pai->nt == NT_LISTA_COMANDOS) {
+                q->corpo_de = pai->pendentes;
+                pai->pendentes = 0;
+            }
+            break;
+        case NT_EXPR_BOOLEANA:
+            if (pai->nt == NT_COMANDO_ENQUANTO || pai->nt == NT_COMANDO_PARA)
+                pai->inicio = posicao(t);
+            break;
+        case NT_ATRIBUICAO_SIMPLES:
+            if (pai->nt == NT_COMANDO_PARA && ++pai->filhos == 2)
+                pai->inicio = posicao(t);
+            break;
+        case NT_ELSE_OPCIONAL:
+            if (producoes[producao].tam_corpo > 0)
+                q->salto = emitir(t, OP_SALTAR, -1, 0, 0);
+            corrigir(t, pai->salto, posicao(t));
+            break;
+        default:
+            break;
+    }
+}
+
+static void traducao_sair(void *contexto, int nt, int producao, int indice_token) {
+    Tradutor *t = contexto;
+    t->semantica.sair_nt(t->semantica.contexto, nt, producao, indice_token);
+    if (t->num_quadros <= 1)
+        return;
+    Quadro q = t->quadros[--t->num_quadros];
+    Quadro *pai = topo(t);
+
+    // Primeiro o codigo do proprio NT...
+    switch (nt) {
+        case NT_TERMO_BOOL:
+            if (q.operador)
+                aplicar_nao(t);
+            break;
+        case NT_DECL_VAR_CAUDA:
+            if (producoes[q.producao].tam_corpo > 1) {
+                atribuir(t, pai->alvo, desempilhar(t));
+            } else {
+                // Sem valor inicial: zera a cada execucao da declaracao.
+                Valor zero;
+                TipoDado tipo = tipo_declarado(t, pai->alvo);
+                if (tipo == TIPO_FLOAT)
+                    zero.f = 0.0;
+                else
+                    zero.i = 0;
+                atribuir(t, pai->alvo, constante(tipo, zero, 0));
+            }
+            break;
+        case NT_ATRIBUICAO:
+            atribuir(t, q.alvo, desempilhar(t));
+            break;
+        case NT_ATRIBUICAO_SIMPLES:
+            atribuir(t, q.alvo, desempilhar(t));
+            if (pai->nt == NT_COMANDO_PARA && pai->filhos == 2)
+                recortar(t, pai->inicio);
+            break;
+        case NT_COMANDO_LEITURA: {
+            TipoDado tipo = tipo_declarado(t, q.alvo);
+            if (q.alvo >= 0)
+                emitir(t, tipo == TIPO_FLOAT ? OP_LER_F : tipo == TIPO_CHAR ? OP_LER_C : OP_LER_I,
+                       q.alvo, 0, 0);
+            break;
+        }
+        case NT_COMANDO_ESCRITA: {
+            ValorSemantico v = desempilhar(t);
+            materializar(t, &v);
+            emitir(t, v.tipo == TIPO_FLOAT ? OP_ESCREVER_F
+                      : v.tipo == TIPO_CHAR ? OP_ESCREVER_C : OP_ESCREVER_I, v.reg, 0, 0);
+            break;
+        }
+        case NT_COMANDO_RETORNO: {
+            ValorSemantico v = desempilhar(t);
+            materializar(t, &v);
+            emitir(t, v.tipo == TIPO_FLOAT ? OP_RETORNAR_F : OP_RETORNAR_I, v.reg, 0, 0);
+            break;
+        }
+        case NT_ELSE_OPCIONAL:
+            corrigir(t, q.salto, posicao(t));
+            break;
+        case NT_COMANDO_ENQUANTO:
+            corrigir(t, q.salto, posicao(t));
+            colar(t);
+            fechar_laco(t, &q.condicao, q.inicio);
+            break;
+        case NT_COMANDO_PARA: {
+            t->fors = crescer(t->fors, &t->capacidade_fors, t->num_fors + 1, sizeof(ForPendente));
+            ForPendente *f = &t->fors[t->num_fors++];
+            f->salto_teste = emitir(t, OP_SALTAR, -1, 0, 0);
+            f->corpo = posicao(t);
+            f->condicao = q.condicao;
+            pai->pendentes++;
+            break;
+        }
+        case NT_COMANDO:
+            // Um for dentro do corpo de outro adia os dois para o comando seguinte.
+            if (q.pendentes > 0)
+                pai->pendentes = q.pendentes + q.corpo_de;
+            else
+                completar_fors(t, q.corpo_de);
+            break;
+        default:
+            break;
+    }
+
+    // ...depois o que ele completa no pai.
+    switch (pai->nt) {
+        case NT_EXPR_ARIT_RESTO:
+        case NT_TERMO_RESTO:
+        case NT_EXPR_REL_RESTO:
+            if ((nt == NT_TERMO || nt == NT_FATOR || nt == NT_EXPR_ARITMETICA) && pai->operador)
+                aplicar_binario(t, pai->operador);
+            break;
+        case NT_EXPR_BOOL_RESTO: {
+            if (nt != NT_TERMO_BOOL)
+                break;
+            ValorSemantico d = desempilhar(t);
+            int e = pai->operador;
+            if (pai->salto < 0) {
+                // Esquerda constante: ou ela decide (e o codigo da direita sai)...
+                if (verdade(&pai->condicao) != e) {
+                    t->m.prog->num_instrucoes = pai->inicio;
+                    t->m.proximo_temporario = pai->temporarios;
+                    empilhar(t, inteiro(!e));
+                } else {
+                    // ...ou o resultado e a verdade da direita.
+                    empilhar(t, valor_logico(t, d));
+                }
+                break;
+            }
+            materializar(t, &d);
+            t->m.proximo_temporario = marca_temporarios(t, &d, NULL);
+            emitir(t, d.tipo == TIPO_FLOAT ? OP_VERDADE_F : OP_VERDADE_I, pai->alvo, d.reg, 0);
+            corrigir(t, pai->salto, posicao(t));
+            empilhar(t, registrador(TIPO_INT, pai->alvo, 1));
+            break;
+        }
+        case NT_COMANDO_SE:
+            if (nt != NT_EXPR_BOOLEANA)
+                break;
+            pai->condicao = condicao(t, desempilhar(t));
+            if (!pai->condicao.constante)
+                pai->salto = emitir(t, OP_SALTAR_SE_FALSO, pai->condicao.reg, -1, 0);
+            else if (!pai->condicao.valor.i)
+                pai->salto = emitir(t, OP_SALTAR, -1, 0, 0);
+            break;
+        case NT_COMANDO_ENQUANTO:
+            if (nt != NT_EXPR_BOOLEANA)
+                break;
+            // Condicao no fim: um salto por volta em vez de dois.
+            pai->condicao = condicao(t, desempilhar(t));
+            recortar(t, pai->inicio);
+            pai->salto = emitir(t, OP_SALTAR, -1, 0, 0);
+            pai->inicio = posicao(t);
+            break;
+        case NT_COMANDO_PARA:
+            if (nt != NT_EXPR_BOOLEANA)
+                break;
+            pai->condicao = condicao(t, desempilhar(t));
+            recortar(t, pai->inicio);
+            break;
+        default:
+            break;
+    }
+}
+
+static int opcode_comparacao(const char *lexema) {
+    if (lexema[0] == '=')
+        return OP_IGUAL_I;
+    if (lexema[0] == '!')
+        return OP_DIFERENTE_I;
+    if (lexema[0] == '<')
+        return lexema[1] == '=' ? OP_MENOR_IGUAL_I : OP_MENOR_I;
+    return lexema[1] == '=' ? OP_MAIOR_IGUAL_I : OP_MAIOR_I;
+}
+
+static void traducao_casar(void *contexto, int token, int indice_token,
+                           const char *lexema, int tamanho) {
+    Tradutor *t = contexto;
+    t->semantica.casar_terminal(t->semantica.contexto, token, indice_token, lexema, tamanho);
+    Quadro *q = topo(t);
+
+    switch (token) {
+        case T_NUM: {
+            Valor valor;
+            TipoDado tipo = montador_literal(lexema, &valor);
+            empilhar(t, constante(tipo, valor, 0));
+            break;
+        }
+        case T_ID: {
+            int d = t->sem->ultima_resolucao;
+            if (q->nt == NT_FATOR)
+                empilhar(t, registrador(tipo_declarado(t, d), d, 0));
+            else
+                q->alvo = d;
+            break;
+        }
+        case T_SOMA: q->operador = OP_SOMAR_I; break;
+        case T_SUB:  q->operador = OP_SUBTRAIR_I; break;
+        case T_MUL:  q->operador = OP_MULTIPLICAR_I; break;
+        case T_DIV:  q->operador = OP_DIVIDIR_I; break;
+        case T_OP_COM:
+            q->operador = opcode_comparacao(lexema);
+            break;
+        case T_NOT:
+            q->operador = 1;
+            break;
+        case T_OP_LOG: {
+            ValorSemantico e = desempilhar(t);
+            q->operador = lexema[0] == '&';
+            if (e.constante) {
+                // Decide no fim da direita; o codigo dela pode ser descartado.
+                q->condicao = e;
+                q->inicio = posicao(t);
+                q->temporarios = t->m.proximo_temporario;
+                break;
+            }
+            // O resultado fica num registrador so, que a direita tambem escreve.
+            if (e.booleano && e_temporario(&e)) {
+                q->alvo = e.reg;
+            } else {
+                t->m.proximo_temporario = marca_temporarios(t, &e, NULL);
+                q->alvo = montador_temporario(&t->m);
+                emitir(t, e.tipo == TIPO_FLOAT ? OP_VERDADE_F : OP_VERDADE_I, q->alvo, e.reg, 0);
+            }
+            q->salto = emitir(t, q->operador ? OP_SALTAR_SE_FALSO : OP_SALTAR_SE_VERDADE,
+                              q->alvo, -1, 0);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/* ============================ Traducao ============================ */
+
+int traduzir_texto(const char *texto, size_t tamanho, Programa *prog, int relatar_erros) {
+    AnalisadorSemantico semantica;
+    semantica_iniciar(&semantica);
+
+    Tradutor t;
+    memset(&t, 0, sizeof(t));
+    montador_iniciar(&t.m, prog);
+    t.sem = &semantica;
+    t.semantica = semantica_receptor(&semantica);
+    // Quadro de fundo: todo NT aberto tem pai.
+    t.quadros = crescer(NULL, &t.capacidade_quadros, 1, sizeof(Quadro));
+    memset(&t.quadros[0], 0, sizeof(Quadro));
+    t.quadros[0].nt = -1;
+    t.quadros[0].salto = -1;
+    t.num_quadros = 1;
+
+    ReceptorEventos receptor = { traducao_entrar, traducao_sair, traducao_casar, NULL, &t };
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, texto, tamanho);
+    FonteTokens fonte = fonte_lexer_reentrante(&lx);
+    Pilha pilha;
+    pilha_init(&pilha);
+    int erros = analisar_entrada(&pilha, &fonte, &receptor, relatar_erros);
+    pilha_liberar(&pilha);
+
+    if (erros) {
+        imprimir_veredito(erros);
+    } else if (semantica.num_erros) {
+        erros = semantica_relatar(&semantica, relatar_erros);
+    } else {
+        emitir(&t, OP_PARAR, 0, 0, 0);
+        montador_concluir(&t.m, semantica.num_declaracoes);
+    }
+    if (erros) {
+        // Codigo parcial: descartado.
+        free(t.m.constantes);
+        free(t.m.tipos_constantes);
+        free(t.m.tabela_constantes);
+        prog->num_instrucoes = 0;
+    }
+
+    free(t.quadros);
+    free(t.valores);
+    free(t.fors);
+    free(t.recortes);
+    free(t.trechos);
+    semantica_liberar(&semantica);
+    return erros;
+}
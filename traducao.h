@@ -0,0 +1,22 @@
+#ifndef TRADUCAO_H
+#define TRADUCAO_H
+
+#include <stddef.h>
+#include "vm.h"
+
+/* Traducao dirigida pela sintaxe: o bytecode de vm.h e emitido durante a
+   propria analise LL(1), sem arvore. Um receptor de eventos mantem, ao lado
+   da Pilha do driver, uma pilha de quadros (um por NT aberto) e uma pilha
+   de valores semanticos (operandos das expressoes abertas). Cada producao
+   emite o seu codigo quando termina; operacoes entre constantes sao
+   calculadas na traducao e nao viram instrucao. A condicao do while e do
+   for e o passo do for sao recortados do fim do codigo ao serem lidos e
+   recolocados depois do corpo, entao o laco testa no fim como em
+   compilador.c. A analise semantica corre nos mesmos eventos; se ela ou a
+   sintatica acusar erro, o codigo e descartado. */
+
+// Traduz 'texto' para 'prog' (que deve estar iniciado), relatando os erros
+// como compilar_texto. Retorna o numero de erros (0 = 'prog' pronto).
+int traduzir_texto(const char *texto, size_t tamanho, Programa *prog, int relatar_erros);
+
+#endif
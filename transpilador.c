@@ -0,0 +1,486 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "transpilador.h"
+#include "construcao.h"
+#include "estatisticas.h"
+
+/* ============================ Runtime ============================ */
+
+// Copiado no inicio de cada programa gerado.
+static const char runtime_c[] =
+    "#include <stdint.h>\n"
+    "#include <stdio.h>\n"
+    "#include <stdlib.h>\n"
+    "#include <string.h>\n"
+    "\n"
+    "typedef union { int64_t i; double f; } Valor;\n"
+    "\n"
+    "#define SOMA_I(x, y)           ((int64_t)((uint64_t)(x) + (uint64_t)(y)))\n"
+    "#define SUBTRACAO_I(x, y)      ((int64_t)((uint64_t)(x) - (uint64_t)(y)))\n"
+    "#define MULTIPLICACAO_I(x, y)  ((int64_t)((uint64_t)(x) * (uint64_t)(y)))\n"
+    "\n"
+    "static " VM_TEXTO_DE(VM_DEFINIR_FLOAT_PARA_INT(float_para_int)) "\n"
+    "\n"
+    "static char entrada[1 << 16];\n"
+    "static size_t pos_entrada, fim_entrada;\n"
+    "static int entrada_acabou;\n"
+    "\n"
+    "/* Pelo menos 'n' bytes a frente no buffer, se a entrada tiver. */\n"
+    "static void garantir(size_t n) {\n"
+    "    if (fim_entrada - pos_entrada >= n || entrada_acabou)\n"
+    "        return;\n"
+    "    memmove(entrada, entrada + pos_entrada, fim_entrada - pos_entrada);\n"
+    "    fim_entrada -= pos_entrada;\n"
+    "    pos_entrada = 0;\n"
+    "    while (fim_entrada < n && !entrada_acabou) {\n"
+    "        size_t lidos = fread(entrada + fim_entrada, 1, sizeof(entrada) - 1 - fim_entrada, stdin);\n"
+    "        if (lidos == 0)\n"
+    "            entrada_acabou = 1;\n"
+    "        fim_entrada += lidos;\n"
+    "    }\n"
+    "    entrada[fim_entrada] = '\\0';\n"
+    "}\n"
+    "\n"
+    "static int olhar(void) {\n"
+    "    garantir(1);\n"
+    "    return pos_entrada < fim_entrada ? (unsigned char)entrada[pos_entrada] : EOF;\n"
+    "}\n"
+    "\n"
+    "static void pular_brancos(void) {\n"
+    "    int c;\n"
+    "    while ((c = olhar()) == ' ' || (c >= '\\t' && c <= '\\r'))\n"
+    "        pos_entrada++;\n"
+    "}\n"
+    "\n"
+    "/* Como scanf(\"%lld\"): sem digitos retorna 0 e nao consome o caractere. */\n"
+    "static int64_t ler_i(void) {\n"
+    "    pular_brancos();\n"
+    "    int c = olhar(), negativo = c == '-';\n"
+    "    if (c == '-' || c == '+')\n"
+    "        pos_entrada++;\n"
+    "    uint64_t v = 0;\n"
+    "    int digitos = 0, excesso = 0;\n"
+    "    while ((c = olhar()) >= '0' && c <= '9') {\n"
+    "        if (v > (UINT64_MAX - 9) / 10)\n"
+    "            excesso = 1;\n"
+    "        v = v * 10 + (uint64_t)(c - '0');\n"
+    "        digitos++;\n"
+    "        pos_entrada++;\n"
+    "    }\n"
+    "    if (!digitos)\n"
+    "        return 0;\n"
+    "    if (negativo)\n"
+    "        return excesso || v > (uint64_t)INT64_MAX + 1 ? INT64_MIN : (int64_t)(0 - v);\n"
+    "    return excesso || v > (uint64_t)INT64_MAX ? INT64_MAX : (int64_t)v;\n"
+    "}\n"
+    "\n"
+    "static double ler_f(void) {\n"
+    "    pular_brancos();\n"
+    "    garantir(512);\n"
+    "    char *fim;\n"
+    "    double v = strtod(entrada + pos_entrada, &fim);\n"
+    "    pos_entrada = (size_t)(fim - entrada);\n"
+    "    return v;\n"
+    "}\n"
+    "\n"
+    "static int64_t ler_c(void) {\n"
+    "    pular_brancos();\n"
+    "    int c = olhar();\n"
+    "    if (c == EOF)\n"
+    "        return 0;\n"
+    "    pos_entrada++;\n"
+    "    return c;\n"
+    "}\n"
+    "\n"
+    "static char saida[1 << 16];\n"
+    "static size_t tam_saida;\n"
+    "\n"
+    "static void descarregar(void) {\n"
+    "    fwrite(saida, 1, tam_saida, stdout);\n"
+    "    tam_saida = 0;\n"
+    "    fflush(stdout);\n"
+    "}\n"
+    "\n"
+    "static void reservar(size_t n) {\n"
+    "    if (tam_saida + n > sizeof(saida))\n"
+    "        descarregar();\n"
+    "}\n"
+    "\n"
+    "static void escrever_i(int64_t v) {\n"
+    "    char d[24];\n"
+    "    int n = 0;\n"
+    "    uint64_t u = v < 0 ? 0 - (uint64_t)v : (uint64_t)v;\n"
+    "    do {\n"
+    "        d[n++] = (char)('0' + u % 10);\n"
+    "        u /= 10;\n"
+    "    } while (u);\n"
+    "    reservar((size_t)n + 2);\n"
+    "    if (v < 0)\n"
+    "        saida[tam_saida++] = '-';\n"
+    "    while (n)\n"
+    "        saida[tam_saida++] = d[--n];\n"
+    "    saida[tam_saida++] = '\\n';\n"
+    "}\n"
+    "\n"
+    "static void escrever_f(double v) {\n"
+    "    reservar(64);\n"
+    "    tam_saida += (size_t)snprintf(saida + tam_saida, 64, \"%g\\n\", v);\n"
+    "}\n"
+    "\n"
+    "static void escrever_c(int64_t v) {\n"
+    "    reservar(2);\n"
+    "    saida[tam_saida++] = (char)v;\n"
+    "    saida[tam_saida++] = '\\n';\n"
+    "}\n"
+    "\n"
+    "static int64_t dividir(int64_t x, int64_t y, int instrucao) {\n"
+    "    if (y == 0) {\n"
+    "        descarregar();\n"
+    "        fprintf(stderr, \"Erro de execucao: divisao por zero (instrucao %d).\\n\", instrucao);\n"
+    "        exit(1);\n"
+    "    }\n"
+    "    return y == -1 ? SUBTRACAO_I(0, x) : x / y;\n"
+    "}\n";
+
+/* ============================ Operandos ============================ */
+
+typedef struct {
+    const Programa *prog;
+    FILE *saida;
+} Transpilador;
+
+static int e_constante(const Programa *p, int reg, Valor *valor) {
+    int k = reg - (p->num_variaveis + p->num_temporarios);
+    if (k < 0 || k >= p->num_constantes || p->registradores_constantes[k] != reg)
+        return 0;
+    *valor = p->valores_constantes[k];
+    return 1;
+}
+
+static const char *literal_i(int64_t v, char *buf, size_t tamanho) {
+    if (v == INT64_MIN)
+        snprintf(buf, tamanho, "(-INT64_C(9223372036854775807) - 1)");
+    else
+        snprintf(buf, tamanho, "INT64_C(%lld)", (long long)v);
+    return buf;
+}
+
+// Operando lido como int.
+static const char *op_i(const Transpilador *t, int reg, char *buf, size_t tamanho) {
+    Valor v;
+    if (e_constante(t->prog, reg, &v))
+        return literal_i(v.i, buf, tamanho);
+    snprintf(buf, tamanho, "r%d.i", reg);
+    return buf;
+}
+
+// Operando lido como float: %a e exato; infinito e NaN vao pelos bits.
+static const char *op_f(const Transpilador *t, int reg, char *buf, size_t tamanho) {
+    Valor v;
+    if (!e_constante(t->prog, reg, &v)) {
+        snprintf(buf, tamanho, "r%d.f", reg);
+    } else if (isfinite(v.f)) {
+        snprintf(buf, tamanho, "%a", v.f);
+    } else {
+        char bits[64];
+        snprintf(buf, tamanho, "((Valor){ .i = %s }).f", literal_i(v.i, bits, sizeof(bits)));
+    }
+    return buf;
+}
+
+/* ============================ Instrucoes ============================ */
+
+static const char *operador_de(int op) {
+    switch (op) {
+        case OP_SOMAR_F:                                        return "+";
+        case OP_SUBTRAIR_F:                                     return "-";
+        case OP_MULTIPLICAR_F:                                  return "*";
+        case OP_DIVIDIR_F:                                      return "/";
+        case OP_IGUAL_I: case OP_IGUAL_F: case OP_SALTAR_SE_IGUAL_I:            return "==";
+        case OP_DIFERENTE_I: case OP_DIFERENTE_F: case OP_SALTAR_SE_DIFERENTE_I: return "!=";
+        case OP_MENOR_I: case OP_MENOR_F: case OP_SALTAR_SE_MENOR_I:            return "<";
+        case OP_MENOR_IGUAL_I: case OP_MENOR_IGUAL_F: case OP_SALTAR_SE_MENOR_IGUAL_I: return "<=";
+        case OP_MAIOR_I: case OP_MAIOR_F: case OP_SALTAR_SE_MAIOR_I:            return ">";
+        default:                                                return ">=";
+    }
+}
+
+static void traduzir(const Transpilador *t, int i) {
+    const Instrucao *ins = &t->prog->codigo[i];
+    FILE *s = t->saida;
+    char x[96], y[96];
+    Valor v;
+    switch (ins->op) {
+        case OP_MOVER:
+            if (e_constante(t->prog, ins->b, &v))
+                fprintf(s, "    r%d.i = %s;\n", ins->a, literal_i(v.i, x, sizeof(x)));
+            else
+                fprintf(s, "    r%d = r%d;\n", ins->a, ins->b);
+            break;
+        case OP_I2F:
+            fprintf(s, "    r%d.f = (double)%s;\n", ins->a, op_i(t, ins->b, x, sizeof(x)));
+            break;
+        case OP_SOMAR_I:
+        case OP_SUBTRAIR_I:
+        case OP_MULTIPLICAR_I:
+            fprintf(s, "    r%d.i = %s(%s, %s);\n", ins->a,
+                    ins->op == OP_SOMAR_I ? "SOMA_I" : ins->op == OP_SUBTRAIR_I ? "SUBTRACAO_I"
+                                                                               : "MULTIPLICACAO_I",
+                    op_i(t, ins->b, x, sizeof(x)), op_i(t, ins->c, y, sizeof(y)));
+            break;
+        case OP_SOMAR_K_I:
+            fprintf(s, "    r%d.i = SOMA_I(%s, %s);\n", ins->a, op_i(t, ins->b, x, sizeof(x)),
+                    literal_i(ins->c, y, sizeof(y)));
+            break;
+        case OP_DIVIDIR_I:
+            fprintf(s, "    r%d.i = dividir(%s, %s, %d);\n", ins->a, op_i(t, ins->b, x, sizeof(x)),
+                    op_i(t, ins->c, y, sizeof(y)), i);
+            break;
+        case OP_SOMAR_F: case OP_SUBTRAIR_F: case OP_MULTIPLICAR_F: case OP_DIVIDIR_F:
+            fprintf(s, "    r%d.f = %s %s %s;\n", ins->a, op_f(t, ins->b, x, sizeof(x)),
+                    operador_de(ins->op), op_f(t, ins->c, y, sizeof(y)));
+            break;
+        case OP_IGUAL_I: case OP_DIFERENTE_I: case OP_MENOR_I:
+        case OP_MENOR_IGUAL_I: case OP_MAIOR_I: case OP_MAIOR_IGUAL_I:
+            fprintf(s, "    r%d.i = %s %s %s;\n", ins->a, op_i(t, ins->b, x, sizeof(x)),
+                    operador_de(ins->op), op_i(t, ins->c, y, sizeof(y)));
+            break;
+        case OP_IGUAL_F: case OP_DIFERENTE_F: case OP_MENOR_F:
+        case OP_MENOR_IGUAL_F: case OP_MAIOR_F: case OP_MAIOR_IGUAL_F:
+            fprintf(s, "    r%d.i = %s %s %s;\n", ins->a, op_f(t, ins->b, x, sizeof(x)),
+                    operador_de(ins->op), op_f(t, ins->c, y, sizeof(y)));
+            break;
+        case OP_NAO_I:
+        case OP_VERDADE_I:
+            fprintf(s, "    r%d.i = %s %s 0;\n", ins->a, op_i(t, ins->b, x, sizeof(x)),
+                    ins->op == OP_NAO_I ? "==" : "!=");
+            break;
+        case OP_NAO_F:
+        case OP_VERDADE_F:
+            fprintf(s, "    r%d.i = %s %s 0;\n", ins->a, op_f(t, ins->b, x, sizeof(x)),
+                    ins->op == OP_NAO_F ? "==" : "!=");
+            break;
+
+        case OP_SALTAR:
+            fprintf(s, "    goto L%d;\n", ins->a);
+            break;
+        case OP_SALTAR_SE_FALSO:
+        case OP_SALTAR_SE_VERDADE:
+            fprintf(s, "    if (%s %s 0) goto L%d;\n", op_i(t, ins->a, x, sizeof(x)),
+                    ins->op == OP_SALTAR_SE_FALSO ? "==" : "!=", ins->b);
+            break;
+        case OP_SALTAR_SE_IGUAL_I: case OP_SALTAR_SE_DIFERENTE_I: case OP_SALTAR_SE_MENOR_I:
+        case OP_SALTAR_SE_MENOR_IGUAL_I: case OP_SALTAR_SE_MAIOR_I: case OP_SALTAR_SE_MAIOR_IGUAL_I:
+            fprintf(s, "    if (%s %s %s) goto L%d;\n", op_i(t, ins->a, x, sizeof(x)),
+                    operador_de(ins->op), op_i(t, ins->b, y, sizeof(y)), ins->c);
+            break;
+
+        case OP_LER_I:          fprintf(s, "    r%d.i = ler_i();\n", ins->a); break;
+        case OP_LER_F:          fprintf(s, "    r%d.f = ler_f();\n", ins->a); break;
+        case OP_LER_C:          fprintf(s, "    r%d.i = ler_c();\n", ins->a); break;
+        case OP_ESCREVER_I:     fprintf(s, "    escrever_i(%s);\n", op_i(t, ins->a, x, sizeof(x))); break;
+        case OP_ESCREVER_F:     fprintf(s, "    escrever_f(%s);\n", op_f(t, ins->a, x, sizeof(x))); break;
+        case OP_ESCREVER_C:     fprintf(s, "    escrever_c(%s);\n", op_i(t, ins->a, x, sizeof(x))); break;
+        case OP_RETORNAR_I:
+            fprintf(s, "    retorno = %s;\n    goto fim;\n", op_i(t, ins->a, x, sizeof(x)));
+            break;
+        case OP_RETORNAR_F:
+            fprintf(s, "    retorno = float_para_int(%s);\n    goto fim;\n", op_f(t, ins->a, x, sizeof(x)));
+            break;
+        default:
+            fprintf(s, "    goto fim;\n");
+            break;
+    }
+}
+
+void transpilar_c(const Programa *p, FILE *saida) {
+    Transpilador t = { p, saida };
+    int n = p->num_instrucoes;
+    unsigned char *e_alvo = calloc((size_t)n + 1, 1);
+    if (!e_alvo) {
+        fprintf(stderr, "Erro: memoria insuficiente para o transpilador.\n");
+        exit(1);
+    }
+    for (int i = 0; i < n; i++) {
+        const Instrucao *ins = &p->codigo[i];
+        const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+        for (int k = 0; k < 3; k++)
+            if (papeis_opcode[ins->op][k] == PAPEL_ALVO)
+                e_alvo[operandos[k]] = 1;
+    }
+
+    fprintf(saida, "/* Gerado pelo analisador cmini a partir de %d instrucoes de bytecode. */\n", n);
+    fputs(runtime_c, saida);
+    fprintf(saida, "\nint main(void) {\n    int64_t retorno = 0;\n");
+    int registradores = p->num_variaveis + p->num_temporarios;
+    for (int r = 0; r < registradores; r++)
+        fprintf(saida, "%sValor r%d = { 0 };%s", r % 8 == 0 ? "    " : " ", r,
+                r % 8 == 7 || r + 1 == registradores ? "\n" : "");
+    for (int i = 0; i < n; i++) {
+        if (e_alvo[i])
+            fprintf(saida, "L%d:\n", i);
+        traduzir(&t, i);
+    }
+    if (e_alvo[n])
+        fprintf(saida, "L%d:\n", n);
+    fprintf(saida, "fim:\n    descarregar();\n    return (int)(retorno & 0xff);\n}\n");
+    free(e_alvo);
+}
+
+/* ============================ Construcao ============================ */
+
+static int construir_em(const Programa *p, const char *diretorio, const char *binario) {
+    char fonte[600];
+    snprintf(fonte, sizeof(fonte), "%s/programa.c", diretorio);
+    FILE *arquivo = fopen(fonte, "w");
+    if (!arquivo) {
+        fprintf(stderr, "Erro: nao foi possivel escrever '%s'.\n", fonte);
+        return 1;
+    }
+    transpilar_c(p, arquivo);
+    int erro = ferror(arquivo);
+    if (fclose(arquivo) != 0 || erro) {
+        fprintf(stderr, "Erro: nao foi possivel escrever '%s'.\n", fonte);
+        remove(fonte);
+        return 1;
+    }
+    const char *fontes[] = { fonte };
+    erro = construcao_compilar("-O3", binario, fontes, 1);
+    remove(fonte);
+    return erro;
+}
+
+int transpilar_construir(const Programa *p, const char *binario) {
+    char diretorio[512];
+    if (!construcao_criar_diretorio(diretorio, sizeof(diretorio)))
+        return 1;
+    int erro = construir_em(p, diretorio, binario);
+    rmdir(diretorio);
+    return erro;
+}
+
+/* ============================ Conferencia ============================ */
+
+static void acrescentar(char *comando, size_t tamanho, const char *texto) {
+    strncat(comando, texto, tamanho - strlen(comando) - 1);
+}
+
+static int copiar_entrada(const char *caminho) {
+    FILE *destino = fopen(caminho, "wb");
+    if (!destino)
+        return 0;
+    char buf[1 << 16];
+    size_t lidos;
+    while ((lidos = fread(buf, 1, sizeof(buf), stdin)) > 0)
+        fwrite(buf, 1, lidos, destino);
+    return fclose(destino) == 0;
+}
+
+// Posicao do primeiro byte diferente (-1 se iguais); 'tamanho' recebe o de 'a'.
+static long primeira_diferenca(const char *a, const char *b, long *tamanho, long *linha) {
+    FILE *x = fopen(a, "rb"), *y = fopen(b, "rb");
+    long pos = -1, i = 0;
+    *linha = 1;
+    if (x && y) {
+        for (;; i++) {
+            int c = getc(x), d = getc(y);
+            if (c != d) {
+                pos = i;
+                if (c != EOF)
+                    i++;
+                while (c != EOF && (c = getc(x)) != EOF)
+                    i++;
+                break;
+            }
+            if (c == EOF)
+                break;
+            if (c == '\n')
+                (*linha)++;
+        }
+    }
+    *tamanho = i;
+    if (x)
+        fclose(x);
+    if (y)
+        fclose(y);
+    return pos;
+}
+
+// Executa 'p' na VM entre dois arquivos. Retorna o codigo de saida como o
+// do processo (1 em erro de execucao) ou -1 se um dos arquivos nao abriu.
+static int executar_vm_em(const Programa *p, const char *entrada, const char *saida, double *tempo) {
+    FILE *in = fopen(entrada, "rb");
+    if (!in) {
+        fprintf(stderr, "Erro: nao foi possivel abrir '%s'.\n", entrada);
+        return -1;
+    }
+    FILE *out = fopen(saida, "wb");
+    if (!out) {
+        fprintf(stderr, "Erro: nao foi possivel criar '%s'.\n", saida);
+        fclose(in);
+        return -1;
+    }
+    double inicio = relogio_monotonico();
+    ResultadoExecucao r = vm_executar(p, in, out, 0);
+    *tempo = relogio_monotonico() - inicio;
+    fclose(in);
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Erro: nao foi possivel gravar '%s'.\n", saida);
+        return -1;
+    }
+    return r.erro ? 1 : (int)(r.retorno & 0xff);
+}
+
+int transpilar_conferir(const Programa *p) {
+    char diretorio[512];
+    if (!construcao_criar_diretorio(diretorio, sizeof(diretorio)))
+        return 1;
+    char entrada[600], binario[600], saida_vm[600], saida_c[600];
+    snprintf(entrada, sizeof(entrada), "%s/entrada", diretorio);
+    snprintf(binario, sizeof(binario), "%s/programa", diretorio);
+    snprintf(saida_vm, sizeof(saida_vm), "%s/saida_vm", diretorio);
+    snprintf(saida_c, sizeof(saida_c), "%s/saida_c", diretorio);
+
+    int resultado = 1;
+    if (!copiar_entrada(entrada)) {
+        fprintf(stderr, "Erro: nao foi possivel guardar a entrada em '%s'.\n", entrada);
+    } else if (construir_em(p, diretorio, binario) == 0) {
+        double tempo_vm;
+        int codigo_vm = executar_vm_em(p, entrada, saida_vm, &tempo_vm);
+        if (codigo_vm >= 0) {
+            char comando[4096] = "";
+            construcao_citar(comando, sizeof(comando), binario);
+            acrescentar(comando, sizeof(comando), " < ");
+            construcao_citar(comando, sizeof(comando), entrada);
+            acrescentar(comando, sizeof(comando), " > ");
+            construcao_citar(comando, sizeof(comando), saida_c);
+            double inicio = relogio_monotonico();
+            int estado = system(comando);
+            double tempo_c = relogio_monotonico() - inicio;
+            int codigo_c = estado != -1 && WIFEXITED(estado) ? WEXITSTATUS(estado) : -1;
+
+            long tamanho, linha;
+            long diferenca = primeira_diferenca(saida_vm, saida_c, &tamanho, &linha);
+            if (diferenca < 0 && codigo_vm == codigo_c) {
+                printf("Saidas identicas: %ld bytes, codigo de saida %d (VM %.3f s, C %.3f s)\n",
+                       tamanho, codigo_vm, tempo_vm, tempo_c);
+                resultado = 0;
+            } else if (diferenca >= 0) {
+                printf("Saidas diferentes a partir do byte %ld (linha %ld)\n", diferenca, linha);
+            } else {
+                printf("Codigos de saida diferentes: VM %d, C %d\n", codigo_vm, codigo_c);
+            }
+        }
+        remove(binario);
+    }
+    remove(entrada);
+    remove(saida_vm);
+    remove(saida_c);
+    rmdir(diretorio);
+    return resultado;
+}
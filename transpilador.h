@@ -0,0 +1,29 @@
+#ifndef TRANSPILADOR_H
+#define TRANSPILADOR_H
+
+#include <stdio.h>
+#include "vm.h"
+
+/* Traducao do bytecode pronto para C portavel (C99, so a biblioteca
+   padrao), para ser compilado com gcc -O3. Cada registrador da VM vira uma
+   variavel local Valor (as constantes viram literais, os float em
+   hexadecimal para nao perder bits) e cada salto vira goto; as operacoes
+   sao as mesmas expressoes de vm.c, entao o resultado e o mesmo bit a bit.
+   O runtime embutido le a entrada em blocos com um leitor de inteiros
+   proprio (mesmas regras de "%lld": brancos, sinal, digitos, saturacao) e
+   escreve a saida num buffer, descarregado no fim, quando enche e antes da
+   mensagem de divisao por zero. */
+
+// Escreve o programa C de 'p' em 'saida'.
+void transpilar_c(const Programa *p, FILE *saida);
+
+// Gera o executavel 'binario' compilando o C de 'p' com $CC (ou cc) -O3.
+// Retorna 0 se deu certo.
+int transpilar_construir(const Programa *p, const char *binario);
+
+// --conferir-c: executa 'p' na VM e o binario transpilado com a mesma
+// entrada (a entrada padrao) e compara a saida padrao e o codigo de saida.
+// Retorna 0 se forem identicos.
+int transpilar_conferir(const Programa *p);
+
+#endif
@@ -0,0 +1,327 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "parser.h"
+#include "verificador_paralelo.h"
+#include "estatisticas.h"
+#include "perfil.h"
+
+/* ============================
+   Deque de trabalho (Chase-Lev)
+   ============================ */
+
+// O dono retira pela base; ladroes roubam pelo topo. Todo o trabalho e
+// empilhado antes das threads comecarem, entao o vetor nunca cresce.
+typedef struct {
+    atomic_long topo;
+    atomic_long base;
+    int *itens;
+} DequeTrabalho;
+
+#define DEQUE_VAZIO       (-1)
+#define DEQUE_CONCORRENCIA (-2) // Perdeu a disputa; vale tentar de novo.
+
+static void deque_iniciar(DequeTrabalho *d, int capacidade) {
+    atomic_init(&d->topo, 0);
+    atomic_init(&d->base, 0);
+    d->itens = malloc((size_t)(capacidade ? capacidade : 1) * sizeof(int));
+    if (!d->itens) {
+        fprintf(stderr, "Erro: memoria insuficiente para o deque de trabalho.\n");
+        exit(1);
+    }
+}
+
+// So chamado pelo dono, antes de as threads comecarem.
+static void deque_empilhar(DequeTrabalho *d, int item) {
+    long b = atomic_load_explicit(&d->base, memory_order_relaxed);
+    d->itens[b] = item;
+    atomic_store_explicit(&d->base, b + 1, memory_order_release);
+}
+
+// Dono: retira o item mais recente.
+static int deque_retirar(DequeTrabalho *d) {
+    long b = atomic_load_explicit(&d->base, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->base, b, memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->topo, memory_order_seq_cst);
+
+    if (t > b) {
+        // Vazio: desfaz a reserva.
+        atomic_store_explicit(&d->base, b + 1, memory_order_relaxed);
+        return DEQUE_VAZIO;
+    }
+
+    int item = d->itens[b];
+    if (t == b) {
+        // Ultimo item: disputa com os ladroes pelo topo.
+        if (!atomic_compare_exchange_strong_explicit(&d->topo, &t, t + 1,
+                                                     memory_order_seq_cst,
+                                                     memory_order_relaxed))
+            item = DEQUE_VAZIO;
+        atomic_store_explicit(&d->base, b + 1, memory_order_relaxed);
+    }
+    return item;
+}
+
+// Ladrao: rouba o item mais antigo.
+static int deque_roubar(DequeTrabalho *d) {
+    long t = atomic_load_explicit(&d->topo, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->base, memory_order_acquire);
+
+    if (t >= b)
+        return DEQUE_VAZIO;
+
+    int item = d->itens[t];
+    if (!atomic_compare_exchange_strong_explicit(&d->topo, &t, t + 1,
+                                                 memory_order_seq_cst,
+                                                 memory_order_relaxed))
+        return DEQUE_CONCORRENCIA;
+    return item;
+}
+
+/* ============================
+   Estado de cada thread
+   ============================ */
+
+#define ARQUIVO_ILEGIVEL (-1)
+
+typedef struct Trabalhador Trabalhador;
+
+typedef struct {
+    char **caminhos;
+    int *erros;            // Resultado por arquivo (ARQUIVO_ILEGIVEL se nao abriu).
+    Trabalhador *trabalhadores;
+    int num_threads;
+} Corpus;
+
+struct Trabalhador {
+    int id;
+    DequeTrabalho deque;
+    Pilha pilha;           // Reaproveitada entre os arquivos desta thread.
+    char *buffer;          // Conteudo do arquivo atual (reaproveitado).
+    size_t capacidade;
+    Corpus *corpus;
+};
+
+// Le o arquivo inteiro para o buffer da thread. Retorna -1 em falha.
+static long ler_arquivo(Trabalhador *w, const char *caminho) {
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo)
+        return -1;
+
+    size_t lidos = 0;
+    for (;;) {
+        if (lidos == w->capacidade) {
+            size_t nova = w->capacidade ? w->capacidade * 2 : 65536;
+            char *dados = realloc(w->buffer, nova);
+            if (!dados) {
+                fclose(arquivo);
+                return -1;
+            }
+            w->buffer = dados;
+            w->capacidade = nova;
+        }
+        size_t n = fread(w->buffer + lidos, 1, w->capacidade - lidos, arquivo);
+        if (n == 0)
+            break;
+        lidos += n;
+    }
+    fclose(arquivo);
+    return (long)lidos;
+}
+
+static void processar_arquivo(Trabalhador *w, int indice) {
+    Corpus *c = w->corpus;
+    long tamanho = ler_arquivo(w, c->caminhos[indice]);
+    if (tamanho < 0) {
+        c->erros[indice] = ARQUIVO_ILEGIVEL;
+        return;
+    }
+
+    LexerReentrante lx;
+    lexer_r_iniciar(&lx, w->buffer, (size_t)tamanho);
+    FonteTokens fonte = fonte_lexer_reentrante(&lx);
+    c->erros[indice] = analisar_entrada(&w->pilha, &fonte, NULL, 0);
+}
+
+// Procura trabalho nos deques das outras threads, a partir da vizinha.
+static int roubar_trabalho(Trabalhador *w) {
+    Corpus *c = w->corpus;
+    for (;;) {
+        int houve_disputa = 0;
+        for (int k = 1; k < c->num_threads; k++) {
+            Trabalhador *vitima = &c->trabalhadores[(w->id + k) % c->num_threads];
+            int item = deque_roubar(&vitima->deque);
+            if (item >= 0)
+                return item;
+            if (item == DEQUE_CONCORRENCIA)
+                houve_disputa = 1;
+        }
+        // Nenhum trabalho novo aparece depois do inicio: se todos estavam
+        // vazios sem disputa, acabou.
+        if (!houve_disputa)
+            return DEQUE_VAZIO;
+    }
+}
+
+static void *executar_trabalhador(void *arg) {
+    Trabalhador *w = arg;
+    for (;;) {
+        int item = deque_retirar(&w->deque);
+        if (item < 0)
+            item = roubar_trabalho(w);
+        if (item < 0)
+            break;
+        processar_arquivo(w, item);
+    }
+    PERFIL_JUNTAR_THREAD();
+    return NULL;
+}
+
+/* ============================
+   Distribuicao e execucao
+   ============================ */
+
+typedef struct {
+    long tamanho;
+    int indice;
+} ArquivoOrdenado;
+
+static int comparar_por_tamanho_decrescente(const void *a, const void *b) {
+    const ArquivoOrdenado *x = a, *y = b;
+    if (x->tamanho != y->tamanho)
+        return x->tamanho < y->tamanho ? 1 : -1;
+    return x->indice - y->indice;
+}
+
+static int resolver_num_threads(int num_threads) {
+    if (num_threads > 0)
+        return num_threads;
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    return nucleos > 0 ? (int)nucleos : 1;
+}
+
+// Executa o corpus e preenche 'erros'. Retorna o numero de arquivos com erro.
+static int executar_corpus(char **caminhos, int quantidade, int num_threads, int *erros) {
+    num_threads = resolver_num_threads(num_threads);
+
+    // Maiores primeiro: distribui em rodizio a lista ordenada por tamanho.
+    ArquivoOrdenado *ordem = malloc((size_t)(quantidade ? quantidade : 1) * sizeof(ArquivoOrdenado));
+    Trabalhador *trabalhadores = calloc((size_t)num_threads, sizeof(Trabalhador));
+    pthread_t *threads = malloc((size_t)num_threads * sizeof(pthread_t));
+    unsigned char *criada = calloc((size_t)num_threads, 1);
+    if (!ordem || !trabalhadores || !threads || !criada) {
+        fprintf(stderr, "Erro: memoria insuficiente para o verificador paralelo.\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < quantidade; i++) {
+        struct stat st;
+        ordem[i].tamanho = stat(caminhos[i], &st) == 0 ? (long)st.st_size : 0;
+        ordem[i].indice = i;
+    }
+    qsort(ordem, (size_t)quantidade, sizeof(ArquivoOrdenado), comparar_por_tamanho_decrescente);
+
+    Corpus corpus = { caminhos, erros, trabalhadores, num_threads };
+    int por_thread = (quantidade + num_threads - 1) / num_threads;
+    for (int t = 0; t < num_threads; t++) {
+        Trabalhador *w = &trabalhadores[t];
+        w->id = t;
+        w->corpus = &corpus;
+        pilha_init(&w->pilha);
+        deque_iniciar(&w->deque, por_thread);
+    }
+
+    // O dono retira pela base: empilha do menor para o maior, para que cada
+    // thread comece pelos seus maiores arquivos e os ladroes levem os menores.
+    for (int i = quantidade - 1; i >= 0; i--)
+        deque_empilhar(&trabalhadores[i % num_threads].deque, ordem[i].indice);
+
+    // Um trabalhador sem thread (pthread_create falhou) e executado por esta
+    // thread depois do primeiro: ele e o dono do deque dele a partir dai.
+    for (int t = 1; t < num_threads; t++)
+        criada[t] = pthread_create(&threads[t], NULL, executar_trabalhador, &trabalhadores[t]) == 0;
+    executar_trabalhador(&trabalhadores[0]);
+    for (int t = 1; t < num_threads; t++) {
+        if (criada[t])
+            pthread_join(threads[t], NULL);
+        else
+            executar_trabalhador(&trabalhadores[t]);
+    }
+
+    int falhas = 0;
+    for (int i = 0; i < quantidade; i++)
+        if (erros[i] != 0)
+            falhas++;
+
+    for (int t = 0; t < num_threads; t++) {
+        pilha_liberar(&trabalhadores[t].pilha);
+        free(trabalhadores[t].buffer);
+        free(trabalhadores[t].deque.itens);
+    }
+    free(criada);
+    free(threads);
+    free(trabalhadores);
+    free(ordem);
+    return falhas;
+}
+
+int verificar_corpus_paralelo(char **caminhos, int quantidade, int num_threads) {
+    int *erros = calloc((size_t)(quantidade ? quantidade : 1), sizeof(int));
+    if (!erros) {
+        fprintf(stderr, "Erro: memoria insuficiente para o verificador paralelo.\n");
+        exit(1);
+    }
+
+    int falhas = executar_corpus(caminhos, quantidade, num_threads, erros);
+
+    // Saida deterministica: sempre na ordem de entrada, como no modo lote.
+    for (int i = 0; i < quantidade; i++) {
+        if (erros[i] == ARQUIVO_ILEGIVEL)
+            printf("%s: ERRO (nao foi possivel abrir)\n", caminhos[i]);
+        else if (erros[i] == 0)
+            printf("%s: OK\n", caminhos[i]);
+        else
+            printf("%s: ERRO (%d erro(s) sintatico(s))\n", caminhos[i], erros[i]);
+    }
+
+    free(erros);
+    return falhas;
+}
+
+/* ============================
+   Benchmark de escalabilidade
+   ============================ */
+
+void medir_escalabilidade(char **caminhos, int quantidade, int max_threads) {
+    int *erros = calloc((size_t)(quantidade ? quantidade : 1), sizeof(int));
+    if (!erros) {
+        fprintf(stderr, "Erro: memoria insuficiente para o verificador paralelo.\n");
+        exit(1);
+    }
+    max_threads = resolver_num_threads(max_threads);
+
+    // Uma passada de aquecimento coloca os arquivos no cache do sistema.
+    executar_corpus(caminhos, quantidade, 1, erros);
+
+    printf("================================ ESCALABILIDADE =============================\n");
+    printf("%8s %12s %10s %10s\n", "threads", "tempo (ms)", "speedup", "eficiencia");
+    double base = 0.0;
+    for (int n = 1; ; n = (n * 2 > max_threads && n < max_threads) ? max_threads : n * 2) {
+        double inicio = relogio_monotonico();
+        executar_corpus(caminhos, quantidade, n, erros);
+        double tempo = relogio_monotonico() - inicio;
+        if (n == 1)
+            base = tempo;
+        double speedup = tempo > 0 ? base / tempo : 0.0;
+        printf("%8d %12.3f %10.2f %9.0f%%\n", n, tempo * 1000.0, speedup, 100.0 * speedup / n);
+        if (n >= max_threads)
+            break;
+    }
+    printf("=============================================================================\n");
+    free(erros);
+}
@@ -0,0 +1,17 @@
+#ifndef VERIFICADOR_PARALELO_H
+#define VERIFICADOR_PARALELO_H
+
+/* Verificacao de um corpus de arquivos com varias threads.
+   As tabelas da gramatica (ja preparadas) sao compartilhadas somente para
+   leitura; cada thread tem seu proprio lexer reentrante, pilha e buffer. */
+
+// Valida os arquivos com 'num_threads' threads (0 = numero de nucleos) e
+// imprime uma linha de veredito por arquivo, na ordem de entrada.
+// Retorna o numero de arquivos com erro.
+int verificar_corpus_paralelo(char **caminhos, int quantidade, int num_threads);
+
+// Mede o tempo do corpus com 1, 2, 4, ... ate 'max_threads' threads
+// (0 = numero de nucleos) e imprime a tabela de escalabilidade.
+void medir_escalabilidade(char **caminhos, int quantidade, int max_threads);
+
+#endif
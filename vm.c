@@ -0,0 +1,330 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "vm.h"
+#include "jit.h"
+
+#if defined(__GNUC__)
+#define VM_GOTO_COMPUTADO
+#endif
+
+#define L PAPEL_LIDO
+#define E PAPEL_ESCRITO
+const unsigned char papeis_opcode[NUM_OPCODES][3] = {
+    [OP_PARAR] = { 0, 0, 0 },
+    [OP_MOVER] = { E, L, 0 }, [OP_I2F] = { E, L, 0 },
+    [OP_SOMAR_I] = { E, L, L }, [OP_SUBTRAIR_I] = { E, L, L },
+    [OP_MULTIPLICAR_I] = { E, L, L }, [OP_DIVIDIR_I] = { E, L, L },
+    [OP_SOMAR_F] = { E, L, L }, [OP_SUBTRAIR_F] = { E, L, L },
+    [OP_MULTIPLICAR_F] = { E, L, L }, [OP_DIVIDIR_F] = { E, L, L },
+    [OP_IGUAL_I] = { E, L, L }, [OP_DIFERENTE_I] = { E, L, L }, [OP_MENOR_I] = { E, L, L },
+    [OP_MENOR_IGUAL_I] = { E, L, L }, [OP_MAIOR_I] = { E, L, L }, [OP_MAIOR_IGUAL_I] = { E, L, L },
+    [OP_IGUAL_F] = { E, L, L }, [OP_DIFERENTE_F] = { E, L, L }, [OP_MENOR_F] = { E, L, L },
+    [OP_MENOR_IGUAL_F] = { E, L, L }, [OP_MAIOR_F] = { E, L, L }, [OP_MAIOR_IGUAL_F] = { E, L, L },
+    [OP_NAO_I] = { E, L, 0 }, [OP_NAO_F] = { E, L, 0 },
+    [OP_VERDADE_I] = { E, L, 0 }, [OP_VERDADE_F] = { E, L, 0 },
+    [OP_SALTAR] = { PAPEL_ALVO, 0, 0 },
+    [OP_SALTAR_SE_FALSO] = { L, PAPEL_ALVO, 0 }, [OP_SALTAR_SE_VERDADE] = { L, PAPEL_ALVO, 0 },
+    [OP_LER_I] = { E, 0, 0 }, [OP_LER_F] = { E, 0, 0 }, [OP_LER_C] = { E, 0, 0 },
+    [OP_ESCREVER_I] = { L, 0, 0 }, [OP_ESCREVER_F] = { L, 0, 0 }, [OP_ESCREVER_C] = { L, 0, 0 },
+    [OP_RETORNAR_I] = { L, 0, 0 }, [OP_RETORNAR_F] = { L, 0, 0 },
+    [OP_SOMAR_K_I] = { E, L, PAPEL_IMEDIATO },
+    [OP_SALTAR_SE_IGUAL_I] = { L, L, PAPEL_ALVO }, [OP_SALTAR_SE_DIFERENTE_I] = { L, L, PAPEL_ALVO },
+    [OP_SALTAR_SE_MENOR_I] = { L, L, PAPEL_ALVO }, [OP_SALTAR_SE_MENOR_IGUAL_I] = { L, L, PAPEL_ALVO },
+    [OP_SALTAR_SE_MAIOR_I] = { L, L, PAPEL_ALVO }, [OP_SALTAR_SE_MAIOR_IGUAL_I] = { L, L, PAPEL_ALVO },
+};
+#undef L
+#undef E
+
+void programa_iniciar(Programa *p) {
+    memset(p, 0, sizeof(*p));
+}
+
+void programa_liberar(Programa *p) {
+    free(p->codigo);
+    free(p->registradores_constantes);
+    free(p->valores_constantes);
+    programa_iniciar(p);
+}
+
+int programa_emitir(Programa *p, int op, int a, int b, int c) {
+    if (p->num_instrucoes == p->capacidade_codigo) {
+        int nova = p->capacidade_codigo ? p->capacidade_codigo * 2 : 1024;
+        Instrucao *codigo = realloc(p->codigo, (size_t)nova * sizeof(Instrucao));
+        if (!codigo) {
+            fprintf(stderr, "Erro: memoria insuficiente para o bytecode.\n");
+            exit(1);
+        }
+        p->codigo = codigo;
+        p->capacidade_codigo = nova;
+    }
+    Instrucao *i = &p->codigo[p->num_instrucoes];
+    i->op = op;
+    i->a = a;
+    i->b = b;
+    i->c = c;
+    return p->num_instrucoes++;
+}
+
+/* ============================ Execucao ============================ */
+
+// Aritmetica de int com transbordo circular, sem comportamento indefinido.
+#define SOMA_I(x, y)           ((int64_t)((uint64_t)(x) + (uint64_t)(y)))
+#define SUBTRACAO_I(x, y)      ((int64_t)((uint64_t)(x) - (uint64_t)(y)))
+#define MULTIPLICACAO_I(x, y)  ((int64_t)((uint64_t)(x) * (uint64_t)(y)))
+
+// Laco de despacho. 'contar' (0 ou 1) e somado a cada despacho sem
+// desvio: uma funcao com goto computado nao pode ser duplicada em linha.
+// 'pares' so e usado no perfil (o desvio e sempre previsto). Com 'jit', os
+// saltos para tras passam por jit_volta, que pode executar o laco nativo.
+static ResultadoExecucao nucleo(const Programa *p, Valor *r, FILE *entrada, FILE *saida,
+                                const long long contar, long long *pares, Jit *jit) {
+    const Instrucao *ip = p->codigo;
+    long long despachos = 0;
+    int anterior = OP_PARAR;
+    ResultadoExecucao resultado = { 0, 0, 0 };
+
+#define PAR()  (pares[anterior * NUM_OPCODES + ip->op]++, anterior = ip->op)
+#define SALTAR_PARA(destino)                                                        \
+    do {                                                                            \
+        int32_t destino_ = (destino);                                               \
+        if (jit && destino_ <= ip - p->codigo)                                      \
+            ip = p->codigo + jit_volta(jit, r, destino_, (int)(ip - p->codigo));    \
+        else                                                                        \
+            ip = p->codigo + destino_;                                              \
+    } while (0)
+#ifdef VM_GOTO_COMPUTADO
+    const void *const rotulos[NUM_OPCODES] = {
+        [OP_PARAR] = &&rot_OP_PARAR, [OP_MOVER] = &&rot_OP_MOVER, [OP_I2F] = &&rot_OP_I2F,
+        [OP_SOMAR_I] = &&rot_OP_SOMAR_I, [OP_SUBTRAIR_I] = &&rot_OP_SUBTRAIR_I,
+        [OP_MULTIPLICAR_I] = &&rot_OP_MULTIPLICAR_I, [OP_DIVIDIR_I] = &&rot_OP_DIVIDIR_I,
+        [OP_SOMAR_F] = &&rot_OP_SOMAR_F, [OP_SUBTRAIR_F] = &&rot_OP_SUBTRAIR_F,
+        [OP_MULTIPLICAR_F] = &&rot_OP_MULTIPLICAR_F, [OP_DIVIDIR_F] = &&rot_OP_DIVIDIR_F,
+        [OP_IGUAL_I] = &&rot_OP_IGUAL_I, [OP_DIFERENTE_I] = &&rot_OP_DIFERENTE_I,
+        [OP_MENOR_I] = &&rot_OP_MENOR_I, [OP_MENOR_IGUAL_I] = &&rot_OP_MENOR_IGUAL_I,
+        [OP_MAIOR_I] = &&rot_OP_MAIOR_I, [OP_MAIOR_IGUAL_I] = &&rot_OP_MAIOR_IGUAL_I,
+        [OP_IGUAL_F] = &&rot_OP_IGUAL_F, [OP_DIFERENTE_F] = &&rot_OP_DIFERENTE_F,
+        [OP_MENOR_F] = &&rot_OP_MENOR_F, [OP_MENOR_IGUAL_F] = &&rot_OP_MENOR_IGUAL_F,
+        [OP_MAIOR_F] = &&rot_OP_MAIOR_F, [OP_MAIOR_IGUAL_F] = &&rot_OP_MAIOR_IGUAL_F,
+        [OP_NAO_I] = &&rot_OP_NAO_I, [OP_NAO_F] = &&rot_OP_NAO_F,
+        [OP_VERDADE_I] = &&rot_OP_VERDADE_I, [OP_VERDADE_F] = &&rot_OP_VERDADE_F,
+        [OP_SALTAR] = &&rot_OP_SALTAR, [OP_SALTAR_SE_FALSO] = &&rot_OP_SALTAR_SE_FALSO,
+        [OP_SALTAR_SE_VERDADE] = &&rot_OP_SALTAR_SE_VERDADE,
+        [OP_LER_I] = &&rot_OP_LER_I, [OP_LER_F] = &&rot_OP_LER_F, [OP_LER_C] = &&rot_OP_LER_C,
+        [OP_ESCREVER_I] = &&rot_OP_ESCREVER_I, [OP_ESCREVER_F] = &&rot_OP_ESCREVER_F,
+        [OP_ESCREVER_C] = &&rot_OP_ESCREVER_C,
+        [OP_RETORNAR_I] = &&rot_OP_RETORNAR_I, [OP_RETORNAR_F] = &&rot_OP_RETORNAR_F,
+        [OP_SOMAR_K_I] = &&rot_OP_SOMAR_K_I,
+        [OP_SALTAR_SE_IGUAL_I] = &&rot_OP_SALTAR_SE_IGUAL_I,
+        [OP_SALTAR_SE_DIFERENTE_I] = &&rot_OP_SALTAR_SE_DIFERENTE_I,
+        [OP_SALTAR_SE_MENOR_I] = &&rot_OP_SALTAR_SE_MENOR_I,
+        [OP_SALTAR_SE_MENOR_IGUAL_I] = &&rot_OP_SALTAR_SE_MENOR_IGUAL_I,
+        [OP_SALTAR_SE_MAIOR_I] = &&rot_OP_SALTAR_SE_MAIOR_I,
+        [OP_SALTAR_SE_MAIOR_IGUAL_I] = &&rot_OP_SALTAR_SE_MAIOR_IGUAL_I,
+    };
+#define CASO(op)   rot_##op:
+#define PROXIMO()  do { despachos += contar; if (pares) PAR(); goto *rotulos[ip->op]; } while (0)
+    PROXIMO();
+#else
+#define CASO(op)   case op:
+#define PROXIMO()  continue
+    for (;;) {
+        despachos += contar;
+        if (pares)
+            PAR();
+        switch (ip->op) {
+#endif
+
+    CASO(OP_MOVER)          r[ip->a] = r[ip->b]; ip++; PROXIMO();
+    CASO(OP_I2F)            r[ip->a].f = (double)r[ip->b].i; ip++; PROXIMO();
+
+    CASO(OP_SOMAR_I)        r[ip->a].i = SOMA_I(r[ip->b].i, r[ip->c].i); ip++; PROXIMO();
+    CASO(OP_SUBTRAIR_I)     r[ip->a].i = SUBTRACAO_I(r[ip->b].i, r[ip->c].i); ip++; PROXIMO();
+    CASO(OP_MULTIPLICAR_I)  r[ip->a].i = MULTIPLICACAO_I(r[ip->b].i, r[ip->c].i); ip++; PROXIMO();
+    CASO(OP_DIVIDIR_I) {
+        int64_t divisor = r[ip->c].i;
+        if (divisor == 0) {
+            fprintf(stderr, "Erro de execucao: divisao por zero (instrucao %d).\n",
+                    (int)(ip - p->codigo));
+            resultado.erro = 1;
+            goto fim;
+        }
+        // -1 a parte: INT64_MIN / -1 transborda.
+        r[ip->a].i = divisor == -1 ? SUBTRACAO_I(0, r[ip->b].i) : r[ip->b].i / divisor;
+        ip++;
+        PROXIMO();
+    }
+
+    CASO(OP_SOMAR_F)        r[ip->a].f = r[ip->b].f + r[ip->c].f; ip++; PROXIMO();
+    CASO(OP_SUBTRAIR_F)     r[ip->a].f = r[ip->b].f - r[ip->c].f; ip++; PROXIMO();
+    CASO(OP_MULTIPLICAR_F)  r[ip->a].f = r[ip->b].f * r[ip->c].f; ip++; PROXIMO();
+    CASO(OP_DIVIDIR_F)      r[ip->a].f = r[ip->b].f / r[ip->c].f; ip++; PROXIMO();
+
+    CASO(OP_IGUAL_I)        r[ip->a].i = r[ip->b].i == r[ip->c].i; ip++; PROXIMO();
+    CASO(OP_DIFERENTE_I)    r[ip->a].i = r[ip->b].i != r[ip->c].i; ip++; PROXIMO();
+    CASO(OP_MENOR_I)        r[ip->a].i = r[ip->b].i < r[ip->c].i; ip++; PROXIMO();
+    CASO(OP_MENOR_IGUAL_I)  r[ip->a].i = r[ip->b].i <= r[ip->c].i; ip++; PROXIMO();
+    CASO(OP_MAIOR_I)        r[ip->a].i = r[ip->b].i > r[ip->c].i; ip++; PROXIMO();
+    CASO(OP_MAIOR_IGUAL_I)  r[ip->a].i = r[ip->b].i >= r[ip->c].i; ip++; PROXIMO();
+    CASO(OP_IGUAL_F)        r[ip->a].i = r[ip->b].f == r[ip->c].f; ip++; PROXIMO();
+    CASO(OP_DIFERENTE_F)    r[ip->a].i = r[ip->b].f != r[ip->c].f; ip++; PROXIMO();
+    CASO(OP_MENOR_F)        r[ip->a].i = r[ip->b].f < r[ip->c].f; ip++; PROXIMO();
+    CASO(OP_MENOR_IGUAL_F)  r[ip->a].i = r[ip->b].f <= r[ip->c].f; ip++; PROXIMO();
+    CASO(OP_MAIOR_F)        r[ip->a].i = r[ip->b].f > r[ip->c].f; ip++; PROXIMO();
+    CASO(OP_MAIOR_IGUAL_F)  r[ip->a].i = r[ip->b].f >= r[ip->c].f; ip++; PROXIMO();
+
+    CASO(OP_NAO_I)          r[ip->a].i = r[ip->b].i == 0; ip++; PROXIMO();
+    CASO(OP_NAO_F)          r[ip->a].i = r[ip->b].f == 0; ip++; PROXIMO();
+    CASO(OP_VERDADE_I)      r[ip->a].i = r[ip->b].i != 0; ip++; PROXIMO();
+    CASO(OP_VERDADE_F)      r[ip->a].i = r[ip->b].f != 0; ip++; PROXIMO();
+
+    CASO(OP_SALTAR)         SALTAR_PARA(ip->a); PROXIMO();
+    CASO(OP_SALTAR_SE_FALSO)
+        if (r[ip->a].i == 0) SALTAR_PARA(ip->b); else ip++;
+        PROXIMO();
+    CASO(OP_SALTAR_SE_VERDADE)
+        if (r[ip->a].i != 0) SALTAR_PARA(ip->b); else ip++;
+        PROXIMO();
+
+    CASO(OP_LER_I) {
+        long long v;
+        r[ip->a].i = fscanf(entrada, "%lld", &v) == 1 ? v : 0;
+        ip++;
+        PROXIMO();
+    }
+    CASO(OP_LER_F) {
+        double v;
+        r[ip->a].f = fscanf(entrada, "%lf", &v) == 1 ? v : 0.0;
+        ip++;
+        PROXIMO();
+    }
+    CASO(OP_LER_C) {
+        char v;
+        r[ip->a].i = fscanf(entrada, " %c", &v) == 1 ? (unsigned char)v : 0;
+        ip++;
+        PROXIMO();
+    }
+    CASO(OP_ESCREVER_I)     fprintf(saida, "%lld\n", (long long)r[ip->a].i); ip++; PROXIMO();
+    CASO(OP_ESCREVER_F)     fprintf(saida, "%g\n", r[ip->a].f); ip++; PROXIMO();
+    CASO(OP_ESCREVER_C)     fprintf(saida, "%c\n", (char)r[ip->a].i); ip++; PROXIMO();
+
+    CASO(OP_SOMAR_K_I)      r[ip->a].i = SOMA_I(r[ip->b].i, ip->c); ip++; PROXIMO();
+    CASO(OP_SALTAR_SE_IGUAL_I)
+        if (r[ip->a].i == r[ip->b].i) SALTAR_PARA(ip->c); else ip++;
+        PROXIMO();
+    CASO(OP_SALTAR_SE_DIFERENTE_I)
+        if (r[ip->a].i != r[ip->b].i) SALTAR_PARA(ip->c); else ip++;
+        PROXIMO();
+    CASO(OP_SALTAR_SE_MENOR_I)
+        if (r[ip->a].i < r[ip->b].i) SALTAR_PARA(ip->c); else ip++;
+        PROXIMO();
+    CASO(OP_SALTAR_SE_MENOR_IGUAL_I)
+        if (r[ip->a].i <= r[ip->b].i) SALTAR_PARA(ip->c); else ip++;
+        PROXIMO();
+    CASO(OP_SALTAR_SE_MAIOR_I)
+        if (r[ip->a].i > r[ip->b].i) SALTAR_PARA(ip->c); else ip++;
+        PROXIMO();
+    CASO(OP_SALTAR_SE_MAIOR_IGUAL_I)
+        if (r[ip->a].i >= r[ip->b].i) SALTAR_PARA(ip->c); else ip++;
+        PROXIMO();
+
+    CASO(OP_RETORNAR_I)     resultado.retorno = r[ip->a].i; goto fim;
+    CASO(OP_RETORNAR_F)     resultado.retorno = vm_float_para_int(r[ip->a].f); goto fim;
+    CASO(OP_PARAR)          goto fim;
+
+#ifndef VM_GOTO_COMPUTADO
+        default:
+            goto fim;
+        }
+    }
+#endif
+#undef CASO
+#undef PROXIMO
+#undef PAR
+#undef SALTAR_PARA
+
+fim:
+    resultado.despachos = despachos;
+    return resultado;
+}
+
+static ResultadoExecucao executar(const Programa *p, FILE *entrada, FILE *saida, int contar,
+                                  long long *pares, Jit *jit) {
+    Valor *registradores = calloc((size_t)p->num_registradores + 1, sizeof(Valor));
+    if (!registradores) {
+        fprintf(stderr, "Erro: memoria insuficiente para os registradores.\n");
+        exit(1);
+    }
+    for (int i = 0; i < p->num_constantes; i++)
+        registradores[p->registradores_constantes[i]] = p->valores_constantes[i];
+
+    ResultadoExecucao resultado = nucleo(p, registradores, entrada, saida, contar != 0, pares, jit);
+    free(registradores);
+    return resultado;
+}
+
+ResultadoExecucao vm_executar(const Programa *p, FILE *entrada, FILE *saida, int contar) {
+    return executar(p, entrada, saida, contar, NULL, NULL);
+}
+
+ResultadoExecucao vm_executar_com_jit(const Programa *p, FILE *entrada, FILE *saida, Jit *jit) {
+    return executar(p, entrada, saida, 0, NULL, jit_disponivel() ? jit : NULL);
+}
+
+ResultadoExecucao vm_perfilar_pares(const Programa *p, FILE *entrada, FILE *saida,
+                                    long long *pares) {
+    return executar(p, entrada, saida, 1, pares, NULL);
+}
+
+/* ============================ Listagem ============================ */
+
+const char *nome_opcode(int op) {
+    static const char *const nomes[NUM_OPCODES] = {
+        "PARAR", "MOVER", "I2F",
+        "SOMAR_I", "SUBTRAIR_I", "MULTIPLICAR_I", "DIVIDIR_I",
+        "SOMAR_F", "SUBTRAIR_F", "MULTIPLICAR_F", "DIVIDIR_F",
+        "IGUAL_I", "DIFERENTE_I", "MENOR_I", "MENOR_IGUAL_I", "MAIOR_I", "MAIOR_IGUAL_I",
+        "IGUAL_F", "DIFERENTE_F", "MENOR_F", "MENOR_IGUAL_F", "MAIOR_F", "MAIOR_IGUAL_F",
+        "NAO_I", "NAO_F", "VERDADE_I", "VERDADE_F",
+        "SALTAR", "SALTAR_SE_FALSO", "SALTAR_SE_VERDADE",
+        "LER_I", "LER_F", "LER_C", "ESCREVER_I", "ESCREVER_F", "ESCREVER_C",
+        "RETORNAR_I", "RETORNAR_F",
+        "SOMAR_K_I", "SALTAR_SE_IGUAL_I", "SALTAR_SE_DIFERENTE_I", "SALTAR_SE_MENOR_I",
+        "SALTAR_SE_MENOR_IGUAL_I", "SALTAR_SE_MAIOR_I", "SALTAR_SE_MAIOR_IGUAL_I"
+    };
+    return op >= 0 && op < NUM_OPCODES ? nomes[op] : "?";
+}
+
+void vm_listar(const Programa *p, FILE *destino) {
+    fprintf(destino, "; %d instrucoes, %d registradores, %d constantes\n",
+            p->num_instrucoes, p->num_registradores, p->num_constantes);
+    for (int i = 0; i < p->num_constantes; i++) {
+        // O tipo da constante nao e guardado: mostra as duas leituras.
+        fprintf(destino, ";   r%d = %lld / %g\n", p->registradores_constantes[i],
+                (long long)p->valores_constantes[i].i, p->valores_constantes[i].f);
+    }
+    for (int i = 0; i < p->num_instrucoes; i++)
+        vm_listar_instrucao(p, i, destino);
+}
+
+void vm_listar_instrucao(const Programa *p, int i, FILE *destino) {
+    const Instrucao *ins = &p->codigo[i];
+    fprintf(destino, "%6d  %-24s", i, nome_opcode(ins->op));
+    const int32_t operandos[3] = { ins->a, ins->b, ins->c };
+    for (int k = 0; k < 3; k++) {
+        const char *separador = k ? ", " : " ";
+        switch (papeis_opcode[ins->op][k]) {
+            case PAPEL_LIDO:
+            case PAPEL_ESCRITO:
+                fprintf(destino, "%sr%d", separador, operandos[k]);
+                break;
+            case PAPEL_ALVO:
+                fprintf(destino, "%s@%d", separador, operandos[k]);
+                break;
+            case PAPEL_IMEDIATO:
+                fprintf(destino, "%s#%d", separador, operandos[k]);
+                break;
+        }
+    }
+    fputc('\n', destino);
+}
@@ -0,0 +1,129 @@
+#ifndef VM_H
+#define VM_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* Bytecode de registradores e a maquina virtual que o executa.
+   Cada instrucao tem um codigo e ate tres operandos (a = destino, b e c =
+   fontes), todos indices de registrador ou alvos de salto. Os
+   registradores guardam as variaveis (um por declaracao), os temporarios
+   das expressoes e as constantes do programa, que sao carregadas antes da
+   execucao. Assim um operando constante nao custa instrucao. As operacoes
+   aritmeticas e de comparacao existem em versoes de int (int64, com
+   transbordo circular) e de float (double); o compilador escolhe pelo tipo
+   anotado na analise semantica e insere I2F onde um int encontra um float.
+   char e guardado como int. O despacho usa goto computado quando o
+   compilador aceita (GCC/Clang) e switch nos demais. */
+
+typedef enum {
+    OP_PARAR,       // Fim do main: termina com retorno 0.
+    OP_MOVER,       // r[a] = r[b]
+    OP_I2F,         // r[a].f = (double)r[b].i
+    OP_SOMAR_I, OP_SUBTRAIR_I, OP_MULTIPLICAR_I, OP_DIVIDIR_I,
+    OP_SOMAR_F, OP_SUBTRAIR_F, OP_MULTIPLICAR_F, OP_DIVIDIR_F,
+    OP_IGUAL_I, OP_DIFERENTE_I, OP_MENOR_I, OP_MENOR_IGUAL_I, OP_MAIOR_I, OP_MAIOR_IGUAL_I,
+    OP_IGUAL_F, OP_DIFERENTE_F, OP_MENOR_F, OP_MENOR_IGUAL_F, OP_MAIOR_F, OP_MAIOR_IGUAL_F,
+    OP_NAO_I,       // r[a].i = r[b].i == 0
+    OP_NAO_F,       // r[a].i = r[b].f == 0
+    OP_VERDADE_I,   // r[a].i = r[b].i != 0
+    OP_VERDADE_F,   // r[a].i = r[b].f != 0
+    OP_SALTAR,      // ip = a
+    OP_SALTAR_SE_FALSO,     // se r[a].i == 0: ip = b
+    OP_SALTAR_SE_VERDADE,   // se r[a].i != 0: ip = b
+    OP_LER_I, OP_LER_F, OP_LER_C,           // r[a] = valor lido
+    OP_ESCREVER_I, OP_ESCREVER_F, OP_ESCREVER_C,
+    OP_RETORNAR_I, OP_RETORNAR_F,           // termina com r[a]
+    // Superinstrucoes (ver superinstrucoes.h).
+    OP_SOMAR_K_I,   // r[a].i = r[b].i + c (c imediato)
+    OP_SALTAR_SE_IGUAL_I, OP_SALTAR_SE_DIFERENTE_I, OP_SALTAR_SE_MENOR_I,
+    OP_SALTAR_SE_MENOR_IGUAL_I, OP_SALTAR_SE_MAIOR_I, OP_SALTAR_SE_MAIOR_IGUAL_I,
+                    // se r[a].i <cmp> r[b].i: ip = c
+    NUM_OPCODES
+} Opcode;
+
+// Papel de cada operando (a, b, c) de uma instrucao.
+typedef enum {
+    PAPEL_NADA,
+    PAPEL_LIDO,         // Registrador lido.
+    PAPEL_ESCRITO,      // Registrador escrito.
+    PAPEL_ALVO,         // Indice de instrucao (salto).
+    PAPEL_IMEDIATO      // Valor inteiro na propria instrucao.
+} PapelOperando;
+
+extern const unsigned char papeis_opcode[NUM_OPCODES][3];
+
+typedef struct {
+    int32_t op;
+    int32_t a, b, c;
+} Instrucao;
+
+typedef union {
+    int64_t i;
+    double f;
+} Valor;
+
+// Conversao do return de float para o codigo de saida: NaN vira 0 e o que
+// nao cabe em int64 satura (o cast direto seria comportamento indefinido).
+// A mesma definicao vai para a VM e, como texto, para os runtimes de
+// transpilador.c e nativo.c, para que os tres terminem com o mesmo valor.
+#define VM_DEFINIR_FLOAT_PARA_INT(nome)                                   \
+    int64_t nome(double v) {                                              \
+        if (v != v) return 0;                                             \
+        if (v >= 9223372036854775808.0) return INT64_MAX;                 \
+        if (v < -9223372036854775808.0) return INT64_MIN;                 \
+        return (int64_t)v;                                                \
+    }
+#define VM_TEXTO(...)           #__VA_ARGS__
+#define VM_TEXTO_DE(...)        VM_TEXTO(__VA_ARGS__)
+
+static inline VM_DEFINIR_FLOAT_PARA_INT(vm_float_para_int)
+
+typedef struct {
+    Instrucao *codigo;
+    int num_instrucoes;
+    int capacidade_codigo;
+
+    // Registradores: [variaveis][temporarios][constantes].
+    int num_registradores;
+    int num_variaveis;
+    int num_temporarios;
+    // Registradores com valor inicial (constantes), carregados antes da execucao.
+    int *registradores_constantes;
+    Valor *valores_constantes;
+    int num_constantes;
+    int capacidade_constantes;
+} Programa;
+
+typedef struct {
+    int erro;               // 1 se a execucao parou por erro (divisao por zero).
+    int64_t retorno;        // Valor do return (0 se o main acabou).
+    long long despachos;    // Instrucoes executadas (so com 'contar').
+} ResultadoExecucao;
+
+void programa_iniciar(Programa *p);
+void programa_liberar(Programa *p);
+// Acrescenta uma instrucao e retorna o seu indice.
+int programa_emitir(Programa *p, int op, int a, int b, int c);
+
+// Executa 'p' lendo de 'entrada' (read) e escrevendo em 'saida' (print).
+// Com 'contar', conta as instrucoes executadas (um pouco mais lento).
+ResultadoExecucao vm_executar(const Programa *p, FILE *entrada, FILE *saida, int contar);
+
+// Como vm_executar, somando em 'pares[anterior * NUM_OPCODES + op]' cada
+// par de instrucoes despachadas em sequencia.
+ResultadoExecucao vm_perfilar_pares(const Programa *p, FILE *entrada, FILE *saida,
+                                    long long *pares);
+
+// Execucao em camadas: como vm_executar, mas os lacos quentes sao
+// compilados por 'jit' (ver jit.h), que deve estar iniciado para 'p'.
+typedef struct Jit Jit;
+ResultadoExecucao vm_executar_com_jit(const Programa *p, FILE *entrada, FILE *saida, Jit *jit);
+
+// Lista o bytecode em texto legivel.
+void vm_listar(const Programa *p, FILE *destino);
+// Uma linha da listagem: a instrucao 'i' de 'p'.
+void vm_listar_instrucao(const Programa *p, int i, FILE *destino);
+const char *nome_opcode(int op);
+
+#endif